@@ -1,33 +1,66 @@
 #pragma once
+#include <unordered_map>
 
 #include "vulkan_extension_management.hpp"
+#include "vulkan_buffer.hpp"
+#include "vulkan_image.hpp"
 #include "vulkan_memory.hpp"
 
-#ifndef _WIN32
-    #define HANDLE int
+#ifdef _WIN32
+using ExternalHandle = HANDLE;
+constexpr ExternalHandle INVALID_EXTERNAL_HANDLE = nullptr;
+#else
+// POSIX file descriptor
+using ExternalHandle = int;
+constexpr ExternalHandle INVALID_EXTERNAL_HANDLE = -1;
 #endif
 
-
-
 class VulkanExternalMemoryExtension final : public VulkanDeviceExtension
 {
 public:
+    // Everything the importing process needs to recreate an exported allocation
+    struct ExternalMemoryInfo
+    {
+        ExternalHandle handle;
+        VkDeviceSize size;
+        uint32_t memoryTypeIndex;
+    };
+
     static VulkanExternalMemoryExtension* get(const VulkanDevice& p_Device);
     static VulkanExternalMemoryExtension* get(ResourceID p_DeviceID);
 
     explicit VulkanExternalMemoryExtension(ResourceID p_DeviceID);
 
     [[nodiscard]] VkBaseInStructure* getExtensionStruct() const override { return nullptr; }
-    [[nodiscard]] VkStructureType getExtensionStructType() const override { return VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SHADER_CLOCK_FEATURES_KHR; }
+    [[nodiscard]] VkStructureType getExtensionStructType() const override { return VK_STRUCTURE_TYPE_MAX_ENUM; }
 
-    void free() override {}
+    void free() override;
 
     [[nodiscard]] ResourceID createExternalImage(VkImageType p_Type, VkFormat p_Format, VkExtent3D p_Extent, VkImageUsageFlags p_Usage, VkImageCreateFlags p_Flags, VkImageTiling p_Tiling = VK_IMAGE_TILING_OPTIMAL) const;
+    [[nodiscard]] ResourceID createExternalImage(const VulkanImage::Config& p_Config) const;
+    [[nodiscard]] ResourceID createExternalBuffer(const VulkanBuffer::Config& p_Config) const;
 
     void allocateExport(ResourceID p_Resource, VulkanMemoryAllocator::MemoryPreferences p_MemoryProperties) const;
 
-    [[nodiscard]] HANDLE getResourceOpaqueHandle(ResourceID p_Resource) const;
+    // The caller owns the returned handle and must close it or pass it to an import
+    [[nodiscard]] ExternalHandle getResourceOpaqueHandle(ResourceID p_Resource) const;
+    [[nodiscard]] ExternalMemoryInfo exportMemory(ResourceID p_Resource) const;
+
+    // On success the implementation takes ownership of the handle. Imported resources must be freed with freeImported
+    [[nodiscard]] ResourceID importImage(const VulkanImage::Config& p_Config, const ExternalMemoryInfo& p_Memory);
+    [[nodiscard]] ResourceID importBuffer(const VulkanBuffer::Config& p_Config, const ExternalMemoryInfo& p_Memory);
+    void freeImported(ResourceID p_Resource);
+
+    [[nodiscard]] ResourceID createExportableSemaphore() const;
+    [[nodiscard]] ExternalHandle exportSemaphore(ResourceID p_Semaphore) const;
+    // Temporary imports only replace the payload until the next wait on the semaphore
+    void importSemaphore(ResourceID p_Semaphore, ExternalHandle p_Handle, bool p_Temporary = false) const;
 
     std::string getMainExtensionName() override { return VK_KHR_EXTERNAL_MEMORY_EXTENSION_NAME; }
     std::vector<std::string> getExtraExtensionNames() override;
+
+private:
+    [[nodiscard]] VkDeviceMemory importMemory(const ExternalMemoryInfo& p_Memory, VkImage p_DedicatedImage, VkBuffer p_DedicatedBuffer) const;
+
+    std::unordered_map<ResourceID, VkDeviceMemory> m_ImportedMemory;
 };
@@ -0,0 +1,33 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    explicit MappedFile(std::string_view p_Filename);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& p_Other) noexcept;
+    MappedFile& operator=(MappedFile&& p_Other) noexcept;
+
+    bool open(std::string_view p_Filename);
+    void close();
+
+    [[nodiscard]] bool isOpen() const { return m_Data != nullptr; }
+    [[nodiscard]] const uint8_t* getData() const { return m_Data; }
+    [[nodiscard]] size_t getSize() const { return m_Size; }
+
+private:
+    const uint8_t* m_Data = nullptr;
+    size_t m_Size = 0;
+
+#ifdef _WIN32
+    void* m_FileHandle = nullptr;
+    void* m_MappingHandle = nullptr;
+#endif
+};
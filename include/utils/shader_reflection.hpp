@@ -2,14 +2,24 @@
 #include <algorithm>
 #include <array>
 #include <cstdint>
-#include <memory>
+#include <cstring>
+#include <span>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
 #include <vector>
 #include <slang/slang.h>
 #include <Volk/volk.h>
 
 #include "vulkan_binding.hpp"
+#include "vulkan_shader.hpp"
+#include "utils/logger.hpp"
 
+// Reflection is stored as flat tables: every field of every parameter lives in one array, with the members of a
+// struct stored contiguously and pointing back at their parent. Names are interned in a single string. Everything is
+// trivially copyable so the whole structure can be written to the shader cache and restored without Slang
 struct ShaderReflectionData
 {
     ShaderReflectionData() = default;
@@ -41,48 +51,37 @@ struct ShaderReflectionData
         FieldType type;
     };
 
-    struct Field
-    {
-        virtual ~Field() = default;
-
-        std::string name;
-        size_t size;
-    };
-
-    using FieldPtr = std::shared_ptr<Field>;
-
-    struct Variable final : Field
-    {
-        TypeData data;
-        uint32_t binding;
-    };
+    enum FieldKind : uint8_t { VARIABLE, STRUCT, RESOURCE };
 
-    using VariablePtr = std::shared_ptr<Variable>;
+    static constexpr uint32_t NO_FIELD = UINT32_MAX;
 
-    struct Struct final : Field
+    struct Field
     {
-        std::vector<FieldPtr> members;
+        uint32_t name = 0;
+        uint32_t parent = NO_FIELD;
+        uint32_t firstMember = NO_FIELD;
+        uint32_t memberCount = 0;
+        // Byte offset inside the parent struct
+        uint32_t offset = 0;
+        uint32_t size = 0;
+        // Variables only, the binding is the vertex input location
+        uint32_t numElements = 1;
+        uint32_t binding = UINT32_MAX;
+        FieldKind kind = VARIABLE;
+        // Element type for variables, resource type for resources
+        FieldType type = UNKNOWN;
+        FieldType subType = UNKNOWN;
+        bool readOnly = false;
     };
 
-    using StructPtr = std::shared_ptr<Struct>;
-
-    struct Resource final : Field
+    struct VertexInput
     {
-        FieldType type;
-        FieldType subType;
-        bool readOnly;
+        uint32_t field;
+        uint32_t topLevelIndex;
     };
 
-    using ResourcePtr = std::shared_ptr<Resource>;
-
     struct VertexBindingRef
     {
-        struct Field
-        {
-            VariablePtr field;
-            uint32_t topLevelIndex;
-        };
-
         VulkanBinding& binding;
         uint32_t fields;
     };
@@ -91,19 +90,35 @@ struct ShaderReflectionData
     {
         uint32_t binding;
         uint32_t set;
-        FieldPtr field;
+        VkDescriptorType type;
+        uint32_t count;
+        uint32_t field;
     };
 
-    std::vector<FieldPtr> vertexInputs;
-    std::vector<FieldPtr> fragmentOutputs;
+    std::vector<Field> fields;
+    std::string names;
+
+    // Indices into fields
+    std::vector<uint32_t> vertexInputs;
+    std::vector<uint32_t> fragmentOutputs;
     std::vector<DescriptorBinding> descriptorBindings;
-    StructPtr pushConstantBlock;
+    uint32_t pushConstantBlock = NO_FIELD;
+    // Every vertex input variable with structs expanded, built once with the rest of the tables
+    std::vector<VertexInput> flatVertexInputs;
 
     VkShaderStageFlags stageFlags = 0;
 
+    [[nodiscard]] const Field& getField(const uint32_t p_Index) const { return fields[p_Index]; }
+    [[nodiscard]] std::string_view getName(const Field& p_Field) const { return names.c_str() + p_Field.name; }
+    [[nodiscard]] std::span<const Field> getMembers(const Field& p_Field) const;
+    [[nodiscard]] bool hasPushConstants() const { return pushConstantBlock != NO_FIELD; }
+
     [[nodiscard]] VkPushConstantRange getPushConstantRange() const;
     void populateBindings(std::span<VertexBindingRef> p_Bindings, uint32_t p_StartingField = 0) const;
 
+    void serialize(std::string& p_Data) const;
+    [[nodiscard]] bool deserialize(std::span<const uint8_t> p_Data);
+
     void invalidate() { m_Valid = false; }
     [[nodiscard]] bool isValid() const { return m_Valid; }
 
@@ -113,7 +128,7 @@ private:
         enum Category : uint8_t { INPUT, PUSH, DESCRIPTOR, INVALID };
 
         Category category;
-        FieldPtr field;
+        uint32_t field;
     };
 
     struct BindingFormat
@@ -122,23 +137,33 @@ private:
         uint32_t bindingSize;
     };
 
+    static constexpr uint32_t SERIAL_MAGIC = 0x4C464552; // "REFL"
+    static constexpr uint32_t SERIAL_VERSION = 1;
+
     bool m_Valid = false;
 
-    static FieldData createField(slang::VariableLayoutReflection* p_Variable, uint32_t p_BindingOffset);
+    FieldData createField(slang::VariableLayoutReflection* p_Variable, uint32_t p_BindingOffset, std::unordered_map<std::string, uint32_t>& p_Names);
+    void fillField(uint32_t p_Index, slang::VariableLayoutReflection* p_Variable, uint32_t p_BindingOffset, std::unordered_map<std::string, uint32_t>& p_Names);
+    uint32_t internName(std::string_view p_Name, std::unordered_map<std::string, uint32_t>& p_Names);
+    void flattenVertexInput(uint32_t p_Field, uint32_t p_TopLevelIndex);
+
     static TypeData getTypeData(slang::TypeLayoutReflection* p_Type);
     static FieldType getTypeFromShape(SlangResourceShape p_Shape);
+    static VkDescriptorType getDescriptorType(slang::TypeLayoutReflection* p_Type);
     static FieldType getType(slang::TypeReflection* p_Type);
     static BindingFormat getBindingFormat(FieldType p_Type);
 
-    [[nodiscard]] std::vector<VertexBindingRef::Field> getFlatVertexInputs(uint32_t p_StartingPoint = 0) const;
-    static void fillFlatVertexInputs(std::vector<VertexBindingRef::Field>& p_Vector, const FieldPtr& p_Input, uint32_t p_TopLevelIndex);
-
     static constexpr std::array<FieldType, 14> s_ScalarKindMapping = {UNKNOWN, UNKNOWN, BOOL, INT32, UINT32, INT64, UINT64, FLOAT16, FLOAT32, FLOAT64, INT8, UINT8, INT16, UINT16};
+
+    static_assert(std::is_trivially_copyable_v<Field> && std::is_trivially_copyable_v<DescriptorBinding> && std::is_trivially_copyable_v<VertexInput>);
 };
 
 inline ShaderReflectionData::ShaderReflectionData(slang::ProgramLayout* p_Layout)
     : m_Valid(true)
 {
+    std::unordered_map<std::string, uint32_t> l_Names;
+    internName("", l_Names);
+
     for (uint32_t i = 0; i < p_Layout->getEntryPointCount(); i++)
     {
         slang::EntryPointLayout* l_EntryPoint = p_Layout->getEntryPointByIndex(i);
@@ -149,7 +174,7 @@ inline ShaderReflectionData::ShaderReflectionData(slang::ProgramLayout* p_Layout
             for (uint32_t j = 0; j < l_EntryPoint->getParameterCount(); j++)
             {
                 slang::VariableLayoutReflection* l_Variable = l_EntryPoint->getParameterByIndex(j);
-                FieldData l_Field = createField(l_Variable, 0);
+                const FieldData l_Field = createField(l_Variable, 0, l_Names);
                 if (l_Field.category == FieldData::INPUT)
                 {
                     vertexInputs.push_back(l_Field.field);
@@ -165,15 +190,13 @@ inline ShaderReflectionData::ShaderReflectionData(slang::ProgramLayout* p_Layout
             slang::VariableLayoutReflection* l_Result = l_EntryPoint->getResultVarLayout();
             if (l_Result->getTypeLayout()->getKind() == slang::TypeReflection::Kind::Scalar)
             {
-                FieldData l_Field = createField(l_Result, 0);
-                fragmentOutputs.push_back(l_Field.field);
+                fragmentOutputs.push_back(createField(l_Result, 0, l_Names).field);
             }
             else if (l_Result->getTypeLayout()->getKind() == slang::TypeReflection::Kind::Struct)
             {
                 for (uint32_t j = 0; j < l_Result->getTypeLayout()->getFieldCount(); j++)
                 {
-                    FieldData l_Field = createField(l_Result->getTypeLayout()->getFieldByIndex(j), 0);
-                    fragmentOutputs.push_back(l_Field.field);
+                    fragmentOutputs.push_back(createField(l_Result->getTypeLayout()->getFieldByIndex(j), 0, l_Names).field);
                 }
             }
         }
@@ -182,16 +205,16 @@ inline ShaderReflectionData::ShaderReflectionData(slang::ProgramLayout* p_Layout
     for (uint32_t i = 0; i < p_Layout->getParameterCount(); i++)
     {
         slang::VariableLayoutReflection* l_Variable = p_Layout->getParameterByIndex(i);
-        FieldData l_Field = createField(l_Variable, 0);
+        const FieldData l_Field = createField(l_Variable, 0, l_Names);
         if (l_Field.category == FieldData::PUSH)
         {
-            if (pushConstantBlock)
+            if (pushConstantBlock != NO_FIELD)
             {
                 LOG_WARN("Multiple push constant blocks found in shader");
             }
-            if (const StructPtr l_Struct = std::dynamic_pointer_cast<Struct>(l_Field.field))
+            if (fields[l_Field.field].kind == STRUCT)
             {
-                pushConstantBlock = l_Struct;
+                pushConstantBlock = l_Field.field;
             }
             else
             {
@@ -203,6 +226,16 @@ inline ShaderReflectionData::ShaderReflectionData(slang::ProgramLayout* p_Layout
             DescriptorBinding l_DescriptorBinding;
             l_DescriptorBinding.binding = l_Variable->getBindingIndex();
             l_DescriptorBinding.set = l_Variable->getBindingSpace();
+            l_DescriptorBinding.type = getDescriptorType(l_Variable->getTypeLayout());
+            // The total count multiplies every dimension, so an unbounded one has to be caught before it wraps around
+            for (slang::TypeLayoutReflection* l_Type = l_Variable->getTypeLayout(); l_Type->getKind() == slang::TypeReflection::Kind::Array; l_Type = l_Type->getElementTypeLayout())
+            {
+                if (l_Type->getElementCount() == SLANG_UNBOUNDED_SIZE)
+                {
+                    throw std::runtime_error("Descriptor '" + std::string(l_Variable->getName()) + "' is an unbounded array, which reflected layouts do not support");
+                }
+            }
+            l_DescriptorBinding.count = static_cast<uint32_t>(std::max<size_t>(1, l_Variable->getTypeLayout()->getTotalArrayElementCount()));
             l_DescriptorBinding.field = l_Field.field;
             descriptorBindings.push_back(l_DescriptorBinding);
         }
@@ -211,55 +244,169 @@ inline ShaderReflectionData::ShaderReflectionData(slang::ProgramLayout* p_Layout
             LOG_WARN("Shader parameter is not a descriptor variable nor push constant");
         }
     }
+
+    for (uint32_t i = 0; i < vertexInputs.size(); i++)
+    {
+        flattenVertexInput(vertexInputs[i], i);
+    }
+}
+
+inline std::span<const ShaderReflectionData::Field> ShaderReflectionData::getMembers(const Field& p_Field) const
+{
+    if (p_Field.memberCount == 0)
+    {
+        return {};
+    }
+    return {fields.data() + p_Field.firstMember, p_Field.memberCount};
 }
 
 inline VkPushConstantRange ShaderReflectionData::getPushConstantRange() const
 {
     VkPushConstantRange l_PushConstantRange{};
-    l_PushConstantRange.size = static_cast<uint32_t>(pushConstantBlock->size);
+    l_PushConstantRange.size = fields[pushConstantBlock].size;
     l_PushConstantRange.stageFlags = stageFlags;
     return l_PushConstantRange;
 }
 
 inline void ShaderReflectionData::populateBindings(std::span<VertexBindingRef> p_Bindings, const uint32_t p_StartingField) const
 {
-    const std::vector<VertexBindingRef::Field> l_FlatVertexInputs = getFlatVertexInputs(p_StartingField);
     for (uint32_t i = 0; i < p_Bindings.size(); i++)
     {
-        std::vector<VertexBindingRef::Field> l_BindingFields;
+        std::vector<const Field*> l_BindingFields;
 
         const uint32_t l_MaxFieldIndex = i + p_Bindings[i].fields - 1;
-        for (const VertexBindingRef::Field& l_Field : l_FlatVertexInputs)
+        for (const VertexInput& l_Input : flatVertexInputs)
         {
-            if (l_Field.topLevelIndex >= i && l_Field.topLevelIndex <= l_MaxFieldIndex)
+            if (l_Input.topLevelIndex >= p_StartingField && l_Input.topLevelIndex >= i && l_Input.topLevelIndex <= l_MaxFieldIndex)
             {
-                l_BindingFields.push_back(l_Field);
+                l_BindingFields.push_back(&fields[l_Input.field]);
             }
         }
 
-        std::ranges::sort(l_BindingFields, [](const VertexBindingRef::Field& p_A, const VertexBindingRef::Field& p_B) { return p_A.field->binding < p_B.field->binding; });
+        std::ranges::sort(l_BindingFields, [](const Field* p_A, const Field* p_B) { return p_A->binding < p_B->binding; });
 
         uint32_t l_Offset = 0;
-        for (const VertexBindingRef::Field& l_Field : l_BindingFields)
+        for (const Field* l_Field : l_BindingFields)
         {
-            if (l_Field.field->binding == UINT32_MAX)
+            if (l_Field->binding == UINT32_MAX)
             {
                 continue;
             }
             VertexBindingRef& l_Binding = p_Bindings[i];
-            const BindingFormat l_BindingFormat = getBindingFormat(l_Field.field->data.type);
-            l_Binding.binding.addAttribDescription(l_BindingFormat.format, l_Offset, l_Field.field->binding, l_BindingFormat.bindingSize);
-            l_Offset += static_cast<uint32_t>(l_Field.field->size);
+            const BindingFormat l_BindingFormat = getBindingFormat(l_Field->type);
+            l_Binding.binding.addAttribDescription(l_BindingFormat.format, l_Offset, l_Field->binding, l_BindingFormat.bindingSize);
+            l_Offset += l_Field->size;
         }
     }
 }
 
-inline ShaderReflectionData::FieldData ShaderReflectionData::createField(slang::VariableLayoutReflection* p_Variable, const uint32_t p_BindingOffset)
+inline void ShaderReflectionData::serialize(std::string& p_Data) const
+{
+    const auto l_Write = [&p_Data](const void* p_Src, const size_t p_Bytes)
+    {
+        p_Data.append(static_cast<const char*>(p_Src), p_Bytes);
+    };
+    const auto l_WriteArray = [&l_Write]<typename T>(const std::vector<T>& p_Array)
+    {
+        const uint32_t l_Count = static_cast<uint32_t>(p_Array.size());
+        l_Write(&l_Count, sizeof(l_Count));
+        l_Write(p_Array.data(), p_Array.size() * sizeof(T));
+    };
+
+    l_Write(&SERIAL_MAGIC, sizeof(SERIAL_MAGIC));
+    l_Write(&SERIAL_VERSION, sizeof(SERIAL_VERSION));
+    l_Write(&stageFlags, sizeof(stageFlags));
+    l_Write(&pushConstantBlock, sizeof(pushConstantBlock));
+    l_WriteArray(fields);
+    l_WriteArray(vertexInputs);
+    l_WriteArray(fragmentOutputs);
+    l_WriteArray(descriptorBindings);
+    l_WriteArray(flatVertexInputs);
+
+    const uint32_t l_NamesSize = static_cast<uint32_t>(names.size());
+    l_Write(&l_NamesSize, sizeof(l_NamesSize));
+    l_Write(names.data(), names.size());
+}
+
+inline bool ShaderReflectionData::deserialize(const std::span<const uint8_t> p_Data)
+{
+    size_t l_Offset = 0;
+    const auto l_Read = [&](void* p_Dst, const size_t p_Bytes)
+    {
+        if (l_Offset + p_Bytes > p_Data.size())
+        {
+            return false;
+        }
+        memcpy(p_Dst, p_Data.data() + l_Offset, p_Bytes);
+        l_Offset += p_Bytes;
+        return true;
+    };
+    const auto l_ReadArray = [&]<typename T>(std::vector<T>& p_Array)
+    {
+        uint32_t l_Count = 0;
+        if (!l_Read(&l_Count, sizeof(l_Count)) || l_Count > (p_Data.size() - l_Offset) / sizeof(T))
+        {
+            return false;
+        }
+        p_Array.resize(l_Count);
+        return l_Read(p_Array.data(), l_Count * sizeof(T));
+    };
+
+    ShaderReflectionData l_Result;
+    uint32_t l_Magic = 0;
+    uint32_t l_Version = 0;
+    uint32_t l_NamesSize = 0;
+    if (!l_Read(&l_Magic, sizeof(l_Magic)) || !l_Read(&l_Version, sizeof(l_Version)) || l_Magic != SERIAL_MAGIC || l_Version != SERIAL_VERSION
+        || !l_Read(&l_Result.stageFlags, sizeof(l_Result.stageFlags)) || !l_Read(&l_Result.pushConstantBlock, sizeof(l_Result.pushConstantBlock))
+        || !l_ReadArray(l_Result.fields) || !l_ReadArray(l_Result.vertexInputs) || !l_ReadArray(l_Result.fragmentOutputs)
+        || !l_ReadArray(l_Result.descriptorBindings) || !l_ReadArray(l_Result.flatVertexInputs) || !l_Read(&l_NamesSize, sizeof(l_NamesSize)))
+    {
+        return false;
+    }
+
+    if (l_NamesSize == 0 || l_NamesSize > p_Data.size() - l_Offset)
+    {
+        return false;
+    }
+    l_Result.names.resize(l_NamesSize);
+    if (!l_Read(l_Result.names.data(), l_NamesSize) || l_Result.names.back() != '\0')
+    {
+        return false;
+    }
+
+    // The tables are indexed without checks later on, so a damaged blob must be rejected here and rebuilt from Slang
+    const size_t l_FieldCount = l_Result.fields.size();
+    const auto l_IsField = [l_FieldCount](const uint32_t p_Index) { return p_Index < l_FieldCount; };
+    for (const Field& l_Field : l_Result.fields)
+    {
+        if (l_Field.name >= l_NamesSize || l_Field.kind > RESOURCE || (l_Field.parent != NO_FIELD && !l_IsField(l_Field.parent)))
+        {
+            return false;
+        }
+        if (l_Field.memberCount != 0 && (l_Field.firstMember > l_FieldCount || l_Field.memberCount > l_FieldCount - l_Field.firstMember))
+        {
+            return false;
+        }
+    }
+    const bool l_ValidIndices = (l_Result.pushConstantBlock == NO_FIELD || l_IsField(l_Result.pushConstantBlock))
+        && std::ranges::all_of(l_Result.vertexInputs, l_IsField)
+        && std::ranges::all_of(l_Result.fragmentOutputs, l_IsField)
+        && std::ranges::all_of(l_Result.descriptorBindings, l_IsField, &DescriptorBinding::field)
+        && std::ranges::all_of(l_Result.flatVertexInputs, [&](const VertexInput& p_Input) { return l_IsField(p_Input.field) && p_Input.topLevelIndex < l_Result.vertexInputs.size(); });
+    if (!l_ValidIndices)
+    {
+        return false;
+    }
+
+    l_Result.m_Valid = true;
+    *this = std::move(l_Result);
+    return true;
+}
+
+inline ShaderReflectionData::FieldData ShaderReflectionData::createField(slang::VariableLayoutReflection* p_Variable, const uint32_t p_BindingOffset, std::unordered_map<std::string, uint32_t>& p_Names)
 {
-    slang::TypeLayoutReflection* l_Type = p_Variable->getTypeLayout();
-    const slang::ParameterCategory l_SlangCategory = p_Variable->getCategory();
     FieldData::Category l_Category;
-    switch (l_SlangCategory)
+    switch (p_Variable->getCategory())
     {
     case slang::ParameterCategory::VaryingInput:
         l_Category = FieldData::INPUT;
@@ -275,44 +422,66 @@ inline ShaderReflectionData::FieldData ShaderReflectionData::createField(slang::
         break;
     }
 
-    FieldPtr l_Field;
-    std::string l_Name;
-    if (p_Variable->getName() != nullptr)
+    const uint32_t l_Index = static_cast<uint32_t>(fields.size());
+    fields.emplace_back();
+    fillField(l_Index, p_Variable, p_BindingOffset, p_Names);
+    return {.category = l_Category, .field = l_Index};
+}
+
+inline void ShaderReflectionData::fillField(const uint32_t p_Index, slang::VariableLayoutReflection* p_Variable, const uint32_t p_BindingOffset, std::unordered_map<std::string, uint32_t>& p_Names)
+{
+    slang::TypeLayoutReflection* l_Type = p_Variable->getTypeLayout();
+
+    // Fields can reallocate below, so the entry is only written through its index
+    Field l_Field = fields[p_Index];
+    l_Field.name = internName(p_Variable->getName() != nullptr ? p_Variable->getName() : "", p_Names);
+    l_Field.size = static_cast<uint32_t>(l_Type->getSize());
+    l_Field.offset = static_cast<uint32_t>(p_Variable->getOffset());
+
+    const slang::TypeReflection::Kind l_Kind = l_Type->getKind();
+    if (l_Kind == slang::TypeReflection::Kind::ConstantBuffer)
     {
-        l_Name = p_Variable->getName();
+        // The block takes the layout of its element, keeping the name, size and offset of the variable
+        fields[p_Index] = l_Field;
+        fillField(p_Index, l_Type->getElementVarLayout(), 0, p_Names);
+        fields[p_Index].name = l_Field.name;
+        fields[p_Index].size = l_Field.size;
+        fields[p_Index].offset = l_Field.offset;
+        return;
     }
-    const slang::TypeReflection::Kind l_Kind = l_Type->getKind();
+
     if (l_Kind == slang::TypeReflection::Kind::Struct)
     {
-        const StructPtr l_Struct = std::make_shared<Struct>();
-        for (uint32_t i = 0; i < l_Type->getFieldCount(); i++)
+        l_Field.kind = STRUCT;
+        l_Field.memberCount = l_Type->getFieldCount();
+        l_Field.firstMember = static_cast<uint32_t>(fields.size());
+        fields[p_Index] = l_Field;
+
+        // Reserve the whole block first so the members stay contiguous, nested structs go after it
+        Field l_Member;
+        l_Member.parent = p_Index;
+        fields.resize(fields.size() + l_Field.memberCount, l_Member);
+        for (uint32_t i = 0; i < l_Field.memberCount; i++)
         {
-            FieldData l_FieldData = createField(l_Type->getFieldByIndex(i), p_BindingOffset + p_Variable->getBindingIndex());
-            l_Struct->members.push_back(l_FieldData.field);
+            fillField(l_Field.firstMember + i, l_Type->getFieldByIndex(i), p_BindingOffset + p_Variable->getBindingIndex(), p_Names);
         }
-
-        l_Field = l_Struct;
+        return;
     }
-    else if (l_Kind == slang::TypeReflection::Kind::ConstantBuffer)
-    {
-        const FieldData l_StructData = createField(l_Type->getElementVarLayout(), 0);
-        l_Field = l_StructData.field;
-    }
-    else if (l_Kind == slang::TypeReflection::Kind::Resource)
-    {
-        const ResourcePtr l_Resource = std::make_shared<Resource>();
 
-        l_Resource->type = getType(l_Type->getType());
-        if (l_Resource->type == UNKNOWN)
+    if (l_Kind == slang::TypeReflection::Kind::Resource)
+    {
+        l_Field.kind = RESOURCE;
+        l_Field.type = getType(l_Type->getType());
+        if (l_Field.type == UNKNOWN)
         {
-            l_Resource->type = getTypeFromShape(l_Type->getResourceShape());
-            if (l_Resource->type == BUFFER)
+            l_Field.type = getTypeFromShape(l_Type->getResourceShape());
+            if (l_Field.type == BUFFER)
             {
-                l_Resource->subType = getType(l_Type->getElementTypeLayout()->getType());
+                l_Field.subType = getType(l_Type->getElementTypeLayout()->getType());
             }
             else
             {
-                l_Resource->subType = getType(l_Type->getResourceResultType());
+                l_Field.subType = getType(l_Type->getResourceResultType());
             }
         }
 
@@ -321,22 +490,44 @@ inline ShaderReflectionData::FieldData ShaderReflectionData::createField(slang::
         {
             LOG_WARN("Resource access is not read or read/write");
         }
-        l_Resource->readOnly = l_Access == SLANG_RESOURCE_ACCESS_READ;
-
-        l_Field = l_Resource;
+        l_Field.readOnly = l_Access == SLANG_RESOURCE_ACCESS_READ;
     }
     else
     {
-        const VariablePtr l_Variable = std::make_shared<Variable>();
-        l_Variable->data = getTypeData(l_Type);
-        l_Variable->binding = p_Variable->getBindingIndex() + p_BindingOffset;
+        const TypeData l_TypeData = getTypeData(l_Type);
+        l_Field.kind = VARIABLE;
+        l_Field.type = l_TypeData.type;
+        l_Field.numElements = static_cast<uint32_t>(l_TypeData.numElements);
+        l_Field.binding = p_Variable->getBindingIndex() + p_BindingOffset;
+    }
+    fields[p_Index] = l_Field;
+}
 
-        l_Field = l_Variable;
+inline uint32_t ShaderReflectionData::internName(const std::string_view p_Name, std::unordered_map<std::string, uint32_t>& p_Names)
+{
+    const auto [l_It, l_Inserted] = p_Names.try_emplace(std::string{p_Name}, static_cast<uint32_t>(names.size()));
+    if (l_Inserted)
+    {
+        names.append(p_Name);
+        names.push_back('\0');
     }
+    return l_It->second;
+}
 
-    l_Field->name = l_Name;
-    l_Field->size = l_Type->getSize();
-    return {.category = l_Category, .field = std::shared_ptr<Field>(l_Field)};
+inline void ShaderReflectionData::flattenVertexInput(const uint32_t p_Field, const uint32_t p_TopLevelIndex)
+{
+    const Field& l_Field = fields[p_Field];
+    if (l_Field.kind == VARIABLE)
+    {
+        flatVertexInputs.push_back({p_Field, p_TopLevelIndex});
+    }
+    else if (l_Field.kind == STRUCT)
+    {
+        for (uint32_t i = 0; i < l_Field.memberCount; i++)
+        {
+            flattenVertexInput(l_Field.firstMember + i, p_TopLevelIndex);
+        }
+    }
 }
 
 inline ShaderReflectionData::TypeData ShaderReflectionData::getTypeData(slang::TypeLayoutReflection* p_Type)
@@ -367,6 +558,46 @@ inline ShaderReflectionData::FieldType ShaderReflectionData::getTypeFromShape(co
     }
 }
 
+inline VkDescriptorType ShaderReflectionData::getDescriptorType(slang::TypeLayoutReflection* p_Type)
+{
+    slang::TypeLayoutReflection* l_Type = p_Type->unwrapArray();
+    switch (l_Type->getKind())
+    {
+    case slang::TypeReflection::Kind::ConstantBuffer:
+        return VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    case slang::TypeReflection::Kind::SamplerState:
+        return VK_DESCRIPTOR_TYPE_SAMPLER;
+    case slang::TypeReflection::Kind::Resource:
+        break;
+    default:
+        // ParameterBlock and the rest would need their own set layout, guessing a type here only breaks binding later
+        throw std::runtime_error("Unsupported descriptor kind for type '" + std::string(l_Type->getName() ? l_Type->getName() : "") + "'");
+    }
+
+    const SlangResourceShape l_Shape = l_Type->getResourceShape();
+    const bool l_ReadOnly = l_Type->getResourceAccess() == SLANG_RESOURCE_ACCESS_READ;
+    switch (l_Shape & SLANG_RESOURCE_BASE_SHAPE_MASK)
+    {
+    case SLANG_STRUCTURED_BUFFER:
+    case SLANG_BYTE_ADDRESS_BUFFER:
+        return VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    case SLANG_TEXTURE_BUFFER:
+        return l_ReadOnly ? VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER : VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER;
+    case SLANG_TEXTURE_SUBPASS:
+        return VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+    case SLANG_ACCELERATION_STRUCTURE:
+        return VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR;
+    default:
+        break;
+    }
+
+    if (l_Shape & SLANG_TEXTURE_COMBINED_FLAG)
+    {
+        return VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    }
+    return l_ReadOnly ? VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE : VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+}
+
 inline ShaderReflectionData::FieldType ShaderReflectionData::getType(slang::TypeReflection* p_Type)
 {
     switch (p_Type->getKind())
@@ -384,33 +615,6 @@ inline ShaderReflectionData::FieldType ShaderReflectionData::getType(slang::Type
     }
 }
 
-inline std::vector<ShaderReflectionData::VertexBindingRef::Field> ShaderReflectionData::getFlatVertexInputs(const uint32_t p_StartingPoint) const
-{
-    using BindingField = VertexBindingRef::Field;
-
-    std::vector<BindingField> l_FlatVertexInputs;
-    for (uint32_t i = p_StartingPoint; i < vertexInputs.size(); i++)
-    {
-        fillFlatVertexInputs(l_FlatVertexInputs, vertexInputs[i], i);
-    }
-    return l_FlatVertexInputs;
-}
-
-inline void ShaderReflectionData::fillFlatVertexInputs(std::vector<VertexBindingRef::Field>& p_Vector, const FieldPtr& p_Input, const uint32_t p_TopLevelIndex)
-{
-    if (const VariablePtr l_Var = std::dynamic_pointer_cast<Variable>(p_Input))
-    {
-        p_Vector.push_back({.field = l_Var, .topLevelIndex = p_TopLevelIndex});
-    }
-    else if (const StructPtr l_Struct = std::dynamic_pointer_cast<Struct>(p_Input))
-    {
-        for (const FieldPtr& l_Member : l_Struct->members)
-        {
-            fillFlatVertexInputs(p_Vector, l_Member, p_TopLevelIndex);
-        }
-    }
-}
-
 inline ShaderReflectionData::BindingFormat ShaderReflectionData::getBindingFormat(const FieldType p_Type)
 {
     switch (p_Type)
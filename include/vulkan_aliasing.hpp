@@ -0,0 +1,66 @@
+#pragma once
+#include <vector>
+#include <Volk/volk.h>
+
+#include "vulkan_image.hpp"
+#include "utils/identifiable.hpp"
+
+// Packs images whose pass lifetimes never overlap into shared memory blocks.
+// Images that alias each other hold undefined contents at the start of their first pass and must be transitioned from VK_IMAGE_LAYOUT_UNDEFINED
+class VulkanImageAliasingAllocator
+{
+public:
+    explicit VulkanImageAliasingAllocator(ResourceID p_Device);
+    ~VulkanImageAliasingAllocator();
+    VulkanImageAliasingAllocator(const VulkanImageAliasingAllocator&) = delete;
+    VulkanImageAliasingAllocator& operator=(const VulkanImageAliasingAllocator&) = delete;
+
+    // Pass indices are inclusive. Returns a declaration index to be used with getImage once built
+    uint32_t declareImage(const VulkanImage::Config& p_Config, uint32_t p_FirstPass, uint32_t p_LastPass);
+    void build();
+    void reset();
+
+    [[nodiscard]] bool isBuilt() const { return m_Built; }
+    [[nodiscard]] ResourceID getImage(uint32_t p_Declaration) const;
+    [[nodiscard]] bool isLazilyAllocated(uint32_t p_Declaration) const;
+
+    [[nodiscard]] uint32_t getBlockCount() const { return static_cast<uint32_t>(m_Blocks.size()); }
+    [[nodiscard]] VkDeviceSize getRequestedBytes() const { return m_RequestedBytes; }
+    [[nodiscard]] VkDeviceSize getAllocatedBytes() const { return m_AllocatedBytes; }
+
+private:
+    struct Declaration
+    {
+        VulkanImage::Config config;
+        uint32_t firstPass;
+        uint32_t lastPass;
+
+        ResourceID image = UINT32_MAX;
+        VkMemoryRequirements requirements{};
+        uint32_t memoryType = UINT32_MAX;
+        uint32_t block = UINT32_MAX;
+        VkDeviceSize offset = 0;
+    };
+
+    struct Block
+    {
+        uint32_t memoryType;
+        VkImageTiling tiling;
+        VkDeviceSize size;
+        VkDeviceSize alignment;
+        std::vector<uint32_t> declarations;
+        VmaAllocation allocation = VK_NULL_HANDLE;
+    };
+
+    [[nodiscard]] uint32_t selectMemoryType(const Declaration& p_Declaration) const;
+    [[nodiscard]] bool tryPlace(Block& p_Block, uint32_t p_Declaration);
+
+    ResourceID m_Device;
+
+    std::vector<Declaration> m_Declarations;
+    std::vector<Block> m_Blocks;
+    bool m_Built = false;
+
+    VkDeviceSize m_RequestedBytes = 0;
+    VkDeviceSize m_AllocatedBytes = 0;
+};
@@ -25,6 +25,9 @@ public:
     [[nodiscard]] bool isMemoryMapped() const;
     [[nodiscard]] void* getMappedData() const;
 
+    // Exported memory is shared with other processes, so the defragmenter must never relocate it
+    [[nodiscard]] bool isMovable() const { return m_Movable; }
+
 protected:
     explicit VulkanMemArray(const ResourceID p_ID) : VulkanDeviceSubresource(p_ID) {}
 
@@ -34,6 +37,7 @@ protected:
 
     uint32_t m_QueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
     void* m_MappedData = nullptr;
+    bool m_Movable = true;
 
     friend class VulkanExternalMemoryExtension;
 };
@@ -56,6 +60,7 @@ public:
 
     [[nodiscard]] VkDeviceSize getSize() const;
     [[nodiscard]] uint32_t getQueue() const;
+    [[nodiscard]] VkBufferUsageFlags getUsage() const;
 
     VkBuffer operator*() const;
 
@@ -66,15 +71,18 @@ public:
 private:
     void free() override;
 
-    VulkanBuffer(ResourceID p_Device, VkBuffer p_VkHandle, VkDeviceSize p_Size);
+    VulkanBuffer(ResourceID p_Device, VkBuffer p_VkHandle, VkDeviceSize p_Size, VkBufferUsageFlags p_Usage = 0);
     
     void setBoundMemory(VmaAllocation p_Allocation) override;
 
     VkBuffer m_VkHandle = VK_NULL_HANDLE;
 
     VkDeviceSize m_Size = 0;
+    VkBufferUsageFlags m_Usage = 0;
 
     friend class VulkanDevice;
     friend class VulkanCommandBuffer;
     friend class VulkanMemoryBarrierBuilder;
+    friend class VulkanDefragmenter;
+    friend class VulkanExternalMemoryExtension;
 };
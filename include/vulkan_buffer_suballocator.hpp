@@ -0,0 +1,57 @@
+#pragma once
+#include <Volk/volk.h>
+
+#include "vulkan_buffer.hpp"
+#include "utils/identifiable.hpp"
+
+struct VulkanBufferSlice
+{
+    ResourceID buffer = UINT32_MAX;
+    VkDeviceSize offset = 0;
+    VkDeviceSize size = 0;
+    VmaVirtualAllocation allocation = VK_NULL_HANDLE;
+
+    [[nodiscard]] bool isValid() const { return buffer != UINT32_MAX; }
+};
+
+class VulkanBufferSuballocator
+{
+public:
+    enum Mode : uint8_t
+    {
+        // Bump allocation, slices are released all at once with reset(). Meant for per-frame data
+        LINEAR,
+        // TLSF free lists, slices are released individually with free(). Meant for long-lived data
+        TLSF
+    };
+
+    VulkanBufferSuballocator(ResourceID p_Device, const VulkanBuffer::MemoryPreferences& p_MemoryPreferences, const VulkanBuffer::Config& p_Config, Mode p_Mode);
+    ~VulkanBufferSuballocator();
+    VulkanBufferSuballocator(const VulkanBufferSuballocator&) = delete;
+    VulkanBufferSuballocator& operator=(const VulkanBufferSuballocator&) = delete;
+
+    [[nodiscard]] VulkanBufferSlice allocate(VkDeviceSize p_Size, VkDeviceSize p_Alignment = 0);
+    void free(const VulkanBufferSlice& p_Slice);
+    void reset();
+
+    [[nodiscard]] void* getMappedData(const VulkanBufferSlice& p_Slice) const;
+
+    [[nodiscard]] ResourceID getBuffer() const { return m_Buffer; }
+    [[nodiscard]] Mode getMode() const { return m_Mode; }
+    [[nodiscard]] VkDeviceSize getCapacity() const { return m_Capacity; }
+    [[nodiscard]] VkDeviceSize getMinAlignment() const { return m_MinAlignment; }
+    [[nodiscard]] VkDeviceSize getUsedBytes() const;
+    [[nodiscard]] uint32_t getAllocationCount() const;
+
+private:
+    static VkDeviceSize computeMinAlignment(ResourceID p_Device, VkBufferUsageFlags p_Usage);
+
+    ResourceID m_Device;
+    ResourceID m_Buffer = UINT32_MAX;
+    Mode m_Mode;
+
+    VmaVirtualBlock m_Block = VK_NULL_HANDLE;
+    VkDeviceSize m_Capacity = 0;
+    VkDeviceSize m_MinAlignment = 1;
+    uint8_t* m_MappedData = nullptr;
+};
@@ -15,6 +15,7 @@ class VulkanFence;
 class VulkanRenderPass;
 class VulkanDevice;
 class VulkanDevice;
+struct VulkanBufferSlice;
 
 class VulkanMemoryBarrierBuilder
 {
@@ -27,6 +28,7 @@ public:
     void addBufferMemoryBarrier(ResourceID p_Buffer, VkDeviceSize p_Offset, VkDeviceSize p_Size, VkAccessFlags p_SrcAccessMask, VkAccessFlags p_DstAccessMask, uint32_t p_DstQueueFamily = VK_QUEUE_FAMILY_IGNORED);
     void addImageMemoryBarrier(ResourceID p_Image, VkImageLayout p_NewLayout, uint32_t p_DstQueueFamily = VK_QUEUE_FAMILY_IGNORED, VkAccessFlags p_SrcAccessMask = VK_ACCESS_FLAG_BITS_MAX_ENUM, VkAccessFlags p_DstAccessMask = VK_ACCESS_FLAG_BITS_MAX_ENUM);
     void addImageMemoryBarrier(const VulkanImage& p_Image, VkImageLayout p_NewLayout, uint32_t p_DstQueueFamily = VK_QUEUE_FAMILY_IGNORED, VkAccessFlags p_SrcAccessMask = VK_ACCESS_FLAG_BITS_MAX_ENUM, VkAccessFlags p_DstAccessMask = VK_ACCESS_FLAG_BITS_MAX_ENUM);
+    void addImageSubresourceBarrier(const VulkanImage& p_Image, const VkImageSubresourceRange& p_Range, VkImageLayout p_OldLayout, VkImageLayout p_NewLayout, VkAccessFlags p_SrcAccessMask, VkAccessFlags p_DstAccessMask);
 
 private:
     ResourceID m_Device;
@@ -71,6 +73,7 @@ public:
 	
 	void cmdBindVertexBuffer(ResourceID p_Buffer, VkDeviceSize p_Offset) const;
 	void cmdBindVertexBuffers(std::span<const ResourceID> p_BufferIDs, std::span<const VkDeviceSize> p_Offsets) const;
+    void cmdBindVertexBuffers(std::span<const VulkanBufferSlice> p_Slices, uint32_t p_FirstBinding = 0) const;
 	void cmdBindIndexBuffer(ResourceID p_BufferID, VkDeviceSize p_Offset, VkIndexType p_IndexType) const;
 
 	void cmdCopyBuffer(ResourceID p_Source, ResourceID p_Destination, std::span<const VkBufferCopy> p_CopyRegions) const;
@@ -82,8 +85,11 @@ public:
 	void ecmdDumpStagingBuffer(ResourceID p_Buffer, VkDeviceSize p_Size, VkDeviceSize p_Offset) const;
 	void ecmdDumpStagingBuffer(ResourceID p_Buffer, std::span<const VkBufferCopy> p_Regions) const;
     void ecmdDumpStagingBufferToImage(ResourceID p_Image, VkExtent3D p_Size, VkOffset3D p_Offset, bool p_KeepLayout = false) const;
+    void ecmdDumpStagingBufferToImage(ResourceID p_Image, std::span<const VkBufferImageCopy> p_Regions, bool p_KeepLayout = false) const;
     void ecmdDumpDataIntoBuffer(ResourceID p_DestBuffer, const uint8_t* p_Data, VkDeviceSize p_Size) const;
     void ecmdDumpDataIntoImage(ResourceID p_DestImage, const uint8_t* p_Data, VkExtent3D p_Extent, uint32_t p_BytesPerPixel, bool p_KeepLayout) const;
+    void ecmdDumpMipChainIntoImage(ResourceID p_DestImage, const uint8_t* p_Data, uint32_t p_BytesPerPixel, bool p_KeepLayout) const;
+    void ecmdGenerateMipmaps(ResourceID p_Image, VkFilter p_Filter, VkImageLayout p_FinalLayout) const;
 
 	void cmdPushConstant(ResourceID p_Layout, VkShaderStageFlags p_StageFlags, uint32_t p_Offset, uint32_t p_Size, const void* p_Values) const;
     void cmdBindDescriptorSet(VkPipelineBindPoint p_BindPoint, ResourceID p_Layout, ResourceID p_DescriptorSet) const;
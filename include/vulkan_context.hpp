@@ -3,6 +3,7 @@
 #include <vector>
 
 #include "vulkan_queues.hpp"
+#include "vulkan_shader_session_pool.hpp"
 #include "utils/allocators.hpp"
 #include "utils/identifiable.hpp"
 
@@ -40,7 +41,8 @@ class VulkanDevice;
 class VulkanContext
 {
 public:
-    static void init(uint32_t p_VulkanApiVersion, bool p_EnableValidationLayers, bool p_AssertOnError, std::span<const char*> p_Extensions);
+    // Slang global sessions are prewarmed on background threads while the instance is created, see VulkanShaderSessionPool
+    static void init(uint32_t p_VulkanApiVersion, bool p_EnableValidationLayers, bool p_AssertOnError, std::span<const char*> p_Extensions, uint32_t p_PrewarmedShaderSessions = 0, VulkanShaderSessionPool::Mode p_ShaderSessionMode = VulkanShaderSessionPool::Mode::PER_THREAD);
 
     static void initializeTransientMemory(size_t p_Size);
     static void initializeTransientMemory(uint8_t* p_Container, size_t p_Size, bool p_ShouldDelete);
@@ -51,12 +53,15 @@ public:
 
     static ResourceID createDevice(VulkanGPU p_GPU, const QueueFamilySelector& p_Queues, const VulkanDeviceExtensionManager* p_Extensions, const VkPhysicalDeviceFeatures& p_Features);
     static VulkanDevice& getDevice(ResourceID p_Index);
+    [[nodiscard]] static bool hasDevice(ResourceID p_Index);
     static void freeDevice(ResourceID p_Index);
     static void freeDevice(const VulkanDevice& p_Device);
 
     static void free();
 
     static VkInstance getHandle();
+    // The version the instance was created with, device level core entry points are capped by it
+    [[nodiscard]] static uint32_t getApiVersion() { return s_ApiVersion; }
 
     static TransientAllocator* getTransAllocator() { return &s_TransientAllocator; }
     static ArenaAllocator* getArenaAllocator() { return &s_ArenaAllocator; }
@@ -71,6 +76,7 @@ private:
 
     inline static VkInstance s_VkHandle = VK_NULL_HANDLE;
     inline static bool s_ValidationLayersEnabled = false;
+    inline static uint32_t s_ApiVersion = VK_API_VERSION_1_0;
 
     inline static TransientAllocator s_TransientAllocator{0};
     inline static ArenaAllocator s_ArenaAllocator{0};
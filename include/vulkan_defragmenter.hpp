@@ -0,0 +1,55 @@
+#pragma once
+#include <vector>
+#include <Volk/volk.h>
+
+#include "vulkan_memory.hpp"
+#include "utils/identifiable.hpp"
+
+class VulkanCommandBuffer;
+
+class VulkanDefragmenter
+{
+public:
+    struct Config
+    {
+        VkDeviceSize maxBytesPerPass = 64ULL * 1024 * 1024;
+        uint32_t maxAllocationsPerPass = 0;
+        VmaDefragmentationFlags flags = VMA_DEFRAGMENTATION_FLAG_ALGORITHM_BALANCED_BIT;
+        uint32_t pool = UINT32_MAX;
+    };
+
+    VulkanDefragmenter(ResourceID p_Device, const Config& p_Config);
+    ~VulkanDefragmenter();
+    VulkanDefragmenter(const VulkanDefragmenter&) = delete;
+    VulkanDefragmenter& operator=(const VulkanDefragmenter&) = delete;
+
+    // Finishes the previous pass and records the copies of the next one. The command buffer
+    // of the previous step, and any other work using the old handles, must have completed
+    bool step(const VulkanCommandBuffer& p_CommandBuffer);
+    void finish();
+
+    [[nodiscard]] bool isFinished() const { return m_Context == VK_NULL_HANDLE; }
+    [[nodiscard]] const VmaDefragmentationStats& getStats() const { return m_Stats; }
+
+    // Resources relocated by the last step. Descriptors and device addresses referring to them must be refreshed
+    [[nodiscard]] const std::vector<ResourceID>& getMovedResources() const { return m_MovedResources; }
+
+private:
+    void recordMoves(const VulkanCommandBuffer& p_CommandBuffer);
+    bool moveBuffer(VmaDefragmentationMove& p_Move, ResourceID p_Buffer, VkCommandBuffer p_CommandBuffer);
+    bool moveImage(VmaDefragmentationMove& p_Move, ResourceID p_Image, VkCommandBuffer p_CommandBuffer);
+    void endPass();
+    void endDefragmentation();
+
+    ResourceID m_Device;
+
+    VmaDefragmentationContext m_Context = VK_NULL_HANDLE;
+    VmaDefragmentationPassMoveInfo m_PassInfo{};
+    bool m_PassActive = false;
+    VmaDefragmentationStats m_Stats{};
+
+    std::vector<ResourceID> m_MovedResources;
+    std::vector<VkBuffer> m_RetiredBuffers;
+    std::vector<VkImage> m_RetiredImages;
+    std::vector<VkImageView> m_RetiredViews;
+};
@@ -1,4 +1,5 @@
 #pragma once
+#include <string>
 #include <unordered_map>
 #include <slang/slang.h>
 
@@ -15,11 +16,13 @@
 #include "vulkan_shader.hpp"
 #include "vulkan_command_buffer.hpp"
 #include "vulkan_descriptors.hpp"
+#include "vulkan_requirements_cache.hpp"
 
 #include "vulkan_context.hpp"
 #include "utils/allocators.hpp"
 
 class VulkanDeviceExtensionManager;
+struct ShaderReflectionData;
 
 class VulkanDevice final : public Identifiable
 {
@@ -62,14 +65,18 @@ public:
     bool freeFramebuffer(const VulkanFramebuffer& p_Framebuffer) { return freeSubresource<VulkanFramebuffer>(p_Framebuffer.getID()); }
 
     ResourceID createAndAllocateBuffer(const VulkanMemoryAllocator::MemoryPreferences& p_MemoryPreferences, const VulkanBuffer::Config& p_Config);
+    std::vector<ResourceID> createAndAllocateBuffers(const VulkanMemoryAllocator::MemoryPreferences& p_MemoryPreferences, std::span<const VulkanBuffer::Config> p_Configs);
 	ResourceID createBuffer(const VulkanBuffer::Config& p_Config);
+    ResourceID createSparseBuffer(const VulkanBuffer::Config& p_Config);
     VulkanBuffer& getBuffer(const ResourceID p_ID) { return *getSubresource<VulkanBuffer>(p_ID); }
     [[nodiscard]] const VulkanBuffer& getBuffer(const ResourceID p_ID) const { return *getSubresource<VulkanBuffer>(p_ID); }
     bool freeBuffer(const ResourceID p_ID) { return freeSubresource<VulkanBuffer>(p_ID); }
     bool freeBuffer(const VulkanBuffer& p_Buffer) { return freeSubresource<VulkanBuffer>(p_Buffer.getID()); }
 
     ResourceID createAndAllocateImage(const VulkanMemoryAllocator::MemoryPreferences& p_MemoryPreferences, const VulkanImage::Config& p_Config);
+    std::vector<ResourceID> createAndAllocateImages(const VulkanMemoryAllocator::MemoryPreferences& p_MemoryPreferences, std::span<const VulkanImage::Config> p_Configs);
     ResourceID createImage(const VulkanImage::Config& p_Config);
+    ResourceID createSparseImage(const VulkanImage::Config& p_Config);
     VulkanImage& getImage(const ResourceID p_ID) { return *getSubresource<VulkanImage>(p_ID); }
     [[nodiscard]] const VulkanImage& getImage(const ResourceID p_ID) const { return *getSubresource<VulkanImage>(p_ID); }
     bool freeImage(const ResourceID p_ID) { return freeSubresource<VulkanImage>(p_ID); }
@@ -82,12 +89,19 @@ public:
     bool freeRenderPass(const VulkanRenderPass& p_RenderPass) { return freeSubresource<VulkanRenderPass>(p_RenderPass.getID()); }
 
 	ResourceID createPipelineLayout(std::span<const ResourceID> p_DescriptorSetLayouts, std::span<const VkPushConstantRange> p_PushConstantRanges);
+    // Merges the reflection of every stage into one layout per descriptor set. Push constants get one range per block
+    // size, shared by the stages that declare it, and a stage may only declare push constants once
+    // The result is shared like getOrCreatePipelineLayout, so its set layouts can be fetched from the pipeline layout
+    ResourceID createPipelineLayout(std::span<const ShaderReflectionData* const> p_Reflections);
+    // Hash-consed, identical layouts resolve to the same ID. Shared layouts must not be freed while other users hold them
+    ResourceID getOrCreatePipelineLayout(std::span<const ResourceID> p_DescriptorSetLayouts, std::span<const VkPushConstantRange> p_PushConstantRanges);
     VulkanPipelineLayout& getPipelineLayout(const ResourceID p_ID) { return *getSubresource<VulkanPipelineLayout>(p_ID); }
     [[nodiscard]] const VulkanPipelineLayout& getPipelineLayout(const ResourceID p_ID) const { return *getSubresource<VulkanPipelineLayout>(p_ID); }
     bool freePipelineLayout(const ResourceID p_ID) { return freeSubresource<VulkanPipelineLayout>(p_ID); }
     bool freePipelineLayout(const VulkanPipelineLayout& p_Layout) { return freeSubresource<VulkanPipelineLayout>(p_Layout.getID()); }
 
 	ResourceID createShaderModule(VulkanShader& p_ShaderCode, VkShaderStageFlagBits p_Stage);
+	ResourceID createShaderModule(std::span<const uint32_t> p_Code, VkShaderStageFlagBits p_Stage);
     VulkanShaderModule& getShaderModule(const ResourceID p_ID) { return *getSubresource<VulkanShaderModule>(p_ID); }
     [[nodiscard]] const VulkanShaderModule& getShaderModule(const ResourceID p_ID) const { return *getSubresource<VulkanShaderModule>(p_ID); }
     bool freeShaderModule(const ResourceID p_ID) { return freeSubresource<VulkanShaderModule>(p_ID); }
@@ -100,7 +114,7 @@ public:
     bool freePipeline(const ResourceID p_ID) { return freeSubresource<VulkanPipeline>(p_ID); }
     bool freePipeline(const VulkanPipeline& p_Pipeline) { return freeSubresource<VulkanPipeline>(p_Pipeline.getID()); }
 
-    ResourceID createComputePipeline(ResourceID p_Layout, ResourceID p_Shader, std::string_view p_Entrypoint);
+    ResourceID createComputePipeline(ResourceID p_Layout, ResourceID p_Shader, std::string_view p_Entrypoint, const VulkanSpecialization& p_Specialization = {});
     VulkanComputePipeline& getComputePipeline(const ResourceID p_ID) { return *getSubresource<VulkanComputePipeline>(p_ID); }
     [[nodiscard]] const VulkanComputePipeline& getComputePipeline(const ResourceID p_ID) const { return *getSubresource<VulkanComputePipeline>(p_ID); }
     bool freeComputePipeline(const ResourceID p_ID) { return freeSubresource<VulkanComputePipeline>(p_ID); }
@@ -113,6 +127,8 @@ public:
     bool freeDescriptorPool(const VulkanDescriptorPool& p_DescriptorPool) { return freeSubresource<VulkanDescriptorPool>(p_DescriptorPool.getID()); }
 
 	ResourceID createDescriptorSetLayout(std::span<const VkDescriptorSetLayoutBinding> p_Bindings, VkDescriptorSetLayoutCreateFlags p_Flags);
+    // Hash-consed like getOrCreatePipelineLayout. Bindings with immutable samplers always get a new layout
+    ResourceID getOrCreateDescriptorSetLayout(std::span<const VkDescriptorSetLayoutBinding> p_Bindings, VkDescriptorSetLayoutCreateFlags p_Flags = 0);
     VulkanDescriptorSetLayout& getDescriptorSetLayout(const ResourceID p_ID) { return *getSubresource<VulkanDescriptorSetLayout>(p_ID); }
     [[nodiscard]] const VulkanDescriptorSetLayout& getDescriptorSetLayout(const ResourceID p_ID) const { return *getSubresource<VulkanDescriptorSetLayout>(p_ID); }
     bool freeDescriptorSetLayout(const ResourceID p_ID) { return freeSubresource<VulkanDescriptorSetLayout>(p_ID); }
@@ -153,6 +169,7 @@ public:
 
     [[nodiscard]] const VulkanMemoryAllocator& getMemoryAllocator() const { return m_MemoryAllocator; }
     VulkanMemoryAllocator& getMemoryAllocator() { return m_MemoryAllocator; }
+    [[nodiscard]] const VulkanMemoryRequirementsCache& getRequirementsCache() const { return m_RequirementsCache; }
 
     VkDevice operator*() const { return m_VkHandle; }
 
@@ -162,9 +179,13 @@ public:
 
 private:
 	bool free();
+    void reportLeaks() const;
 
     VkCommandPool getCommandPool(uint32_t p_QueueFamilyIndex, ThreadID p_ThreadID, VulkanCommandBuffer::TypeFlags p_Flags);
 
+    [[nodiscard]] VkPipeline buildGraphicsPipeline(const VulkanPipelineBuilder& p_Builder, ResourceID p_PipelineLayout, ResourceID p_RenderPass, uint32_t p_Subpass) const;
+    [[nodiscard]] VkPipeline buildComputePipeline(ResourceID p_Layout, ResourceID p_Shader, std::string_view p_Entrypoint, const VulkanSpecialization& p_Specialization) const;
+
 	VulkanDevice(VulkanGPU p_PhysicalDevice, VkDevice p_Device, VulkanDeviceExtensionManager* p_ExtensionManager);
 
 	struct ThreadCommandInfo
@@ -189,7 +210,11 @@ private:
     ARENA_UMAP(m_ThreadCommandInfos, ThreadID, ThreadCommandInfo);
     ARENA_UMAP(m_CommandBuffers, ThreadID, ThreadCmdBuffers);
     ARENA_UMAP(m_Subresources, ResourceID, VulkanDeviceSubresource*);
+    // Keyed by the raw bytes of the normalized create info, entries whose layout was freed are dropped on lookup
+    ARENA_UMAP(m_DescriptorSetLayoutCache, std::string, ResourceID);
+    ARENA_UMAP(m_PipelineLayoutCache, std::string, ResourceID);
     VulkanMemoryAllocator m_MemoryAllocator{};
+    VulkanMemoryRequirementsCache m_RequirementsCache{getID()};
 
 	QueueSelection m_OneTimeQueue{UINT32_MAX, UINT32_MAX};
 
@@ -222,9 +247,10 @@ private:
     friend class VulkanDeviceExtensionManager;
 
 private:
-    void insertImage(VulkanImage* p_Image);
+    void insertSubresource(VulkanDeviceSubresource* p_Resource);
 
     friend class VulkanExternalMemoryExtension;
+    friend class VulkanShaderHotReloader;
 };
 
 
@@ -16,12 +16,14 @@ public:
 private:
     void free() override;
 
-    VulkanImageView(ResourceID p_Device, VkImageView p_VkHandle);
+    VulkanImageView(ResourceID p_Device, VkImageView p_VkHandle, const VkImageViewCreateInfo& p_CreateInfo = {});
 
     VkImageView m_VkHandle = VK_NULL_HANDLE;
+    VkImageViewCreateInfo m_CreateInfo{};
 
     friend class VulkanImage;
     friend class VulkanDevice;
+    friend class VulkanDefragmenter;
 };
 
 class VulkanImageSampler final : public VulkanDeviceSubresource
@@ -51,6 +53,9 @@ public:
         VkImageUsageFlags usage;
         VkImageCreateFlags flags = 0;
         VkImageTiling tiling = VK_IMAGE_TILING_OPTIMAL;
+        uint32_t mipLevels = 1;
+        uint32_t arrayLayers = 1;
+        VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT;
     };
 
     using MemoryPreferences = VulkanMemoryAllocator::MemoryPreferences;
@@ -76,6 +81,16 @@ public:
     [[nodiscard]] VkImageType getType() const;
     [[nodiscard]] VkImageLayout getLayout() const;
     [[nodiscard]] uint32_t getQueue() const;
+    [[nodiscard]] VkFormat getFormat() const;
+    [[nodiscard]] uint32_t getMipLevels() const;
+    [[nodiscard]] uint32_t getArrayLayers() const;
+    [[nodiscard]] VkSampleCountFlagBits getSamples() const;
+    [[nodiscard]] VkImageUsageFlags getUsage() const;
+    [[nodiscard]] VkImageTiling getTiling() const;
+    [[nodiscard]] VkImageCreateFlags getCreateFlags() const;
+    [[nodiscard]] VkExtent3D getMipSize(uint32_t p_MipLevel) const;
+
+    static uint32_t getMaxMipLevels(VkExtent3D p_Extent);
 
     void setLayout(VkImageLayout p_Layout);
     void setQueue(uint32_t p_QueueFamilyIndex);
@@ -88,13 +103,20 @@ private:
 
     void free() override;
 
-    VulkanImage(ResourceID p_Device, VkImage p_VkHandle, VkExtent3D p_Size, VkImageType p_Type, VkImageLayout p_Layout);
+    VulkanImage(ResourceID p_Device, VkImage p_VkHandle, VkExtent3D p_Size, VkImageType p_Type, VkImageLayout p_Layout, VkFormat p_Format = VK_FORMAT_UNDEFINED, uint32_t p_MipLevels = 1, uint32_t p_ArrayLayers = 1, VkSampleCountFlagBits p_Samples = VK_SAMPLE_COUNT_1_BIT, VkImageUsageFlags p_Usage = 0, VkImageTiling p_Tiling = VK_IMAGE_TILING_OPTIMAL, VkImageCreateFlags p_CreateFlags = 0);
 
     void setBoundMemory(VmaAllocation p_Allocation) override;
 
     VkExtent3D m_Size{};
     VkImageType m_Type;
     VkImageLayout m_Layout = VK_IMAGE_LAYOUT_UNDEFINED;
+    VkFormat m_Format = VK_FORMAT_UNDEFINED;
+    uint32_t m_MipLevels = 1;
+    uint32_t m_ArrayLayers = 1;
+    VkSampleCountFlagBits m_Samples = VK_SAMPLE_COUNT_1_BIT;
+    VkImageUsageFlags m_Usage = 0;
+    VkImageTiling m_Tiling = VK_IMAGE_TILING_OPTIMAL;
+    VkImageCreateFlags m_CreateFlags = 0;
 
     VkImage m_VkHandle = VK_NULL_HANDLE;
 
@@ -106,4 +128,5 @@ private:
     friend class VulkanSwapchain;
     friend class VulkanMemoryBarrierBuilder;
     friend class VulkanExternalMemoryExtension;
+    friend class VulkanDefragmenter;
 };
@@ -0,0 +1,55 @@
+#pragma once
+#include <string_view>
+#include <vector>
+#include <Volk/volk.h>
+
+#include "vulkan_image.hpp"
+#include "utils/identifiable.hpp"
+#include "utils/mapped_file.hpp"
+
+class VulkanCommandBuffer;
+
+class VulkanKTX2Loader
+{
+public:
+    explicit VulkanKTX2Loader(ResourceID p_Device);
+
+    bool open(std::string_view p_Filename);
+    void close();
+
+    [[nodiscard]] bool isOpen() const { return m_File.isOpen(); }
+    [[nodiscard]] VkFormat getFormat() const { return m_Format; }
+    [[nodiscard]] VkExtent3D getExtent() const { return m_Extent; }
+    [[nodiscard]] VkImageType getImageType() const { return m_Type; }
+    [[nodiscard]] uint32_t getMipLevels() const;
+    [[nodiscard]] uint32_t getArrayLayers() const { return m_LayerCount; }
+    [[nodiscard]] uint32_t getFaceCount() const { return m_FaceCount; }
+    [[nodiscard]] bool needsMipGeneration() const { return m_GenerateMips; }
+
+    [[nodiscard]] VulkanImage::Config getImageConfig(VkImageUsageFlags p_Usage) const;
+    ResourceID createImage(const VulkanImage::MemoryPreferences& p_MemoryPreferences, VkImageUsageFlags p_Usage = VK_IMAGE_USAGE_SAMPLED_BIT) const;
+
+    void upload(const VulkanCommandBuffer& p_CommandBuffer, ResourceID p_Image, VkImageLayout p_FinalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VkPipelineStageFlags p_DstStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VkAccessFlags p_DstAccess = VK_ACCESS_FLAG_BITS_MAX_ENUM) const;
+
+private:
+    struct Level
+    {
+        uint64_t byteOffset;
+        uint64_t byteLength;
+        uint64_t uncompressedByteLength;
+    };
+
+    bool parse(std::string_view p_Filename);
+
+    ResourceID m_Device;
+
+    MappedFile m_File;
+
+    VkFormat m_Format = VK_FORMAT_UNDEFINED;
+    VkImageType m_Type = VK_IMAGE_TYPE_2D;
+    VkExtent3D m_Extent{};
+    uint32_t m_LayerCount = 1;
+    uint32_t m_FaceCount = 1;
+    bool m_GenerateMips = false;
+    std::vector<Level> m_Levels;
+};
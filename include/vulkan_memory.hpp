@@ -1,10 +1,18 @@
 #pragma once
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <optional>
+#include <span>
 #include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "vulkan_gpu.hpp"
 #include "utils/identifiable.hpp"
+#include "utils/signal.hpp"
 
 #include <vma/vk_mem_alloc.h>
 #include <bitset>
@@ -21,6 +29,16 @@ public:
         VkDeviceSize heapSize;
     };
 
+    struct HeapBudget
+    {
+        VkDeviceSize budget;
+        VkDeviceSize usage;
+        VkDeviceSize allocationBytes;
+        VkDeviceSize blockBytes;
+
+        [[nodiscard]] float getUsageRatio() const { return budget == 0 ? 0.0f : static_cast<float>(usage) / static_cast<float>(budget); }
+    };
+
     [[nodiscard]] const VkPhysicalDeviceMemoryProperties& getMemoryProperties() const;
 
     [[nodiscard]] std::string toString() const;
@@ -33,6 +51,10 @@ public:
     [[nodiscard]] uint32_t getMemoryTypeCount() const;
     [[nodiscard]] uint32_t getMemoryHeapCount() const;
 
+    [[nodiscard]] HeapBudget getHeapBudget(uint32_t p_Heap) const;
+    [[nodiscard]] std::vector<HeapBudget> getHeapBudgets() const;
+    [[nodiscard]] bool hasBudgetSupport() const { return m_HasBudgetExtension; }
+
     VulkanGPU operator*() const { return m_GPU; }
 
 private:
@@ -43,6 +65,9 @@ private:
 
     VulkanGPU m_GPU;
 
+    VmaAllocator m_Allocator = VK_NULL_HANDLE;
+    bool m_HasBudgetExtension = false;
+
     friend class VulkanMemoryAllocator;
 };
 
@@ -67,6 +92,13 @@ public:
         VkMemoryPropertyFlags desiredProperties = 0;
         VkMemoryPropertyFlags preferredProperties = 0;
 
+        // Non-critical allocations stay within the heap budget and fall back to host-visible memory instead of failing
+        bool critical = true;
+
+        // Tags used to attribute memory in dumpMemoryMap and leak reports. They are copied at allocation time
+        std::string_view name{};
+        std::string_view category{};
+
         static MemoryPreferences fromDefault() { return {}; }
         static MemoryPreferences fromIndex(const uint32_t p_Index) { return { .forceMemoryIndex = p_Index }; }
         static MemoryPreferences fromUsage(VmaMemoryUsage p_Usage, VmaAllocationCreateFlags p_Flags);
@@ -90,23 +122,77 @@ public:
         bool operator==(const PoolPreferences& p_Other) const;
     };
 
+    struct PoolPreferencesHash
+    {
+        size_t operator()(const PoolPreferences& p_Prefs) const;
+    };
+
+    struct BudgetEvent
+    {
+        uint32_t heapIndex;
+        float threshold;
+        bool rising;
+        MemoryStructure::HeapBudget budget;
+    };
+
+    using BudgetSignal = Signal<const BudgetEvent&>;
+
+    struct DedicatedStats
+    {
+        VkDeviceSize bytes = 0;
+        uint32_t allocationCount = 0;
+    };
+
+    struct AllocationTag
+    {
+        std::string name;
+        std::string category;
+    };
+
     [[nodiscard]] uint32_t findMemoryType(const MemoryPreferences& p_Preferences) const;
     [[nodiscard]] uint32_t findMemoryType(const VkMemoryRequirements& p_Reqs, const MemoryPreferences& p_Preferences) const;
     [[nodiscard]] uint32_t findMemoryType(const MemoryPreferences& p_Preferences, uint32_t p_StartingFilter) const;
 
-    [[nodiscard]] VmaAllocation allocateMemArray(ResourceID p_MemArray, const MemoryPreferences& p_Preferences) const;
-    [[nodiscard]] VmaAllocation allocateBuffer(ResourceID p_Buffer, const MemoryPreferences& p_Preferences) const;
-    [[nodiscard]] VmaAllocation allocateImage(ResourceID p_Image, const MemoryPreferences& p_Preferences) const;
+    [[nodiscard]] VmaAllocation allocateMemArray(ResourceID p_MemArray, const MemoryPreferences& p_Preferences);
+    [[nodiscard]] VmaAllocation allocateBuffer(ResourceID p_Buffer, const MemoryPreferences& p_Preferences);
+    [[nodiscard]] VmaAllocation allocateImage(ResourceID p_Image, const MemoryPreferences& p_Preferences);
+
+    // Resources with identical requirements share one vmaAllocateMemoryPages call, and all of them are bound with a single vkBind*Memory2
+    // If anything fails nothing stays allocated, the resources themselves are left for the caller to free
+    [[nodiscard]] std::vector<VmaAllocation> allocateBuffers(std::span<const ResourceID> p_Buffers, const MemoryPreferences& p_Preferences);
+    [[nodiscard]] std::vector<VmaAllocation> allocateImages(std::span<const ResourceID> p_Images, const MemoryPreferences& p_Preferences);
 
     uint32_t getOrCreatePool(const PoolPreferences& p_Prefs);
     uint32_t createPool(const PoolPreferences& p_Prefs);
 
+    // Frame transient pools use the linear algorithm over a single preallocated block, so allocating from them is a pointer bump.
+    // Every resource allocated from a frame pool is freed when that frame slot is reset
+    void createFramePools(uint32_t p_FrameCount, uint32_t p_MemoryTypeIndex, VkDeviceSize p_BlockSize);
+    [[nodiscard]] uint32_t getFramePool(uint32_t p_FrameIndex) const;
+    [[nodiscard]] uint32_t getFramePoolCount() const { return static_cast<uint32_t>(m_FramePools.size()); }
+    void resetFramePool(uint32_t p_FrameIndex);
+
     void* map(VmaAllocation p_Alloc) const;
     void unmap(VmaAllocation p_Alloc) const;
+    void flush(VmaAllocation p_Alloc, VkDeviceSize p_Offset, VkDeviceSize p_Size) const;
     void deallocate(VmaAllocation p_Alloc) const;
 
     [[nodiscard]] const MemoryStructure& getMemoryStructure() const;
     [[nodiscard]] VmaAllocationInfo getAllocationInfo(VmaAllocation p_Allocation) const;
+    // Returned by value, allocations on other threads may rehash the tag map at any time
+    [[nodiscard]] std::optional<AllocationTag> getAllocationTag(VmaAllocation p_Allocation) const;
+
+    // JSON with the allocator's detailed map (heaps, blocks, allocations and free ranges) and the tag of every tracked allocation
+    [[nodiscard]] std::string dumpMemoryMap() const;
+
+    // Resources at least this large get their own VkDeviceMemory even if the driver does not ask for it. 0 only follows the driver
+    void setDedicatedThreshold(const VkDeviceSize p_Threshold) { m_DedicatedThreshold = p_Threshold; }
+    [[nodiscard]] VkDeviceSize getDedicatedThreshold() const { return m_DedicatedThreshold; }
+    [[nodiscard]] DedicatedStats getDedicatedStats(uint32_t p_Heap) const;
+
+    void setBudgetThresholds(std::span<const float> p_Thresholds);
+    [[nodiscard]] BudgetSignal& getBudgetSignal() const { return m_BudgetSignal; }
+    void updateBudgets(uint32_t p_FrameIndex);
 
     VmaAllocator operator*() const { return m_Allocator; }
 
@@ -122,30 +208,80 @@ private:
         T as() const { return reinterpret_cast<T>(vkObj); }
     };
 
+    struct DedicatedRequirements
+    {
+        VkMemoryRequirements requirements;
+        bool requiresDedicated;
+        bool prefersDedicated;
+    };
+
     struct PoolData
     {
         uint32_t id;
 
         VmaPool pool;
         PoolPreferences prefs;
+        uint32_t frameSlot = UINT32_MAX;
     };
 
     VulkanMemoryAllocator() = default;
     explicit VulkanMemoryAllocator(const VulkanDevice& p_Device);
+    VulkanMemoryAllocator(const VulkanMemoryAllocator&) = delete;
+    VulkanMemoryAllocator& operator=(const VulkanMemoryAllocator&) = delete;
+    VulkanMemoryAllocator(VulkanMemoryAllocator&&) noexcept = default;
+    VulkanMemoryAllocator& operator=(VulkanMemoryAllocator&&) noexcept = default;
 
     [[nodiscard]] AllocationReturn createBuffer(const VkBufferCreateInfo& p_Info, const MemoryPreferences& p_Preferences) const;
     [[nodiscard]] AllocationReturn createImage(const VkImageCreateInfo& p_Info, const MemoryPreferences& p_Preferences) const;
 
     [[nodiscard]] VmaAllocationCreateInfo toVmaAllocCI(const MemoryPreferences& p_Preferences, uint32_t p_MemoryTypeBits) const;
+    VkResult allocateWithFallback(const MemoryPreferences& p_Preferences, VmaAllocationCreateInfo p_Aci, uint32_t p_CompatibleTypeBits, const std::function<VkResult(const VmaAllocationCreateInfo&)>& p_Allocate) const;
+    void checkBudgets() const;
+    [[nodiscard]] std::vector<VmaAllocation> allocateBatch(std::span<const DedicatedRequirements> p_Requirements, const MemoryPreferences& p_Preferences, const std::function<VkResult(size_t, const VmaAllocationCreateInfo&, VmaAllocation&)>& p_AllocateDedicated) const;
+
+    [[nodiscard]] DedicatedRequirements getBufferRequirements(VkBuffer p_Buffer) const;
+    [[nodiscard]] DedicatedRequirements getImageRequirements(VkImage p_Image) const;
+    [[nodiscard]] bool wantsDedicated(const DedicatedRequirements& p_Requirements, const MemoryPreferences& p_Preferences) const;
+    // Only counts the allocation if VMA really gave it its own VkDeviceMemory
+    void recordDedicated(VmaAllocation p_Allocation) const;
+    // Drops the tag and the dedicated stats of an allocation that is about to be freed
+    void forgetAllocation(VmaAllocation p_Allocation) const;
+    void deallocatePages(std::span<const VmaAllocation> p_Allocations) const;
+    void tagAllocation(VmaAllocation p_Allocation, const MemoryPreferences& p_Preferences) const;
 
     [[nodiscard]] VmaPool getPool(uint32_t p_Id) const;
+    uint32_t createVmaPool(const PoolPreferences& p_Prefs);
+    void trackFrameResource(uint32_t p_Pool, ResourceID p_Resource);
 
     VmaAllocator m_Allocator = VK_NULL_HANDLE;
     MemoryStructure m_MemoryStructure{};
 
+    // Pool IDs are indices into m_Pools
     std::vector<PoolData> m_Pools{};
+    std::unordered_map<PoolPreferences, uint32_t, PoolPreferencesHash> m_PoolLookup{};
+
+    std::vector<uint32_t> m_FramePools{};
+    // Resources are tracked from allocations on any thread while resetFramePool drains them
+    std::unique_ptr<std::mutex> m_FrameMutex = std::make_unique<std::mutex>();
+    std::vector<std::vector<ResourceID>> m_FrameResources{};
+
+    // Guards the thresholds and the per heap levels, allocations on any thread re-check the budgets.
+    // The mutexes live behind pointers so the device can still move a new allocator into place
+    std::unique_ptr<std::mutex> m_BudgetMutex = std::make_unique<std::mutex>();
+    std::vector<float> m_BudgetThresholds{};
+    mutable std::vector<uint32_t> m_HeapThresholdLevels{};
+    mutable BudgetSignal m_BudgetSignal{};
+
+    std::unique_ptr<std::mutex> m_TagMutex = std::make_unique<std::mutex>();
+    mutable std::unordered_map<VmaAllocation, AllocationTag> m_AllocationTags{};
+
+    VkDeviceSize m_DedicatedThreshold = 32ULL * 1024 * 1024;
+    std::unique_ptr<std::mutex> m_DedicatedMutex = std::make_unique<std::mutex>();
+    mutable std::vector<DedicatedStats> m_DedicatedStats{};
+    mutable std::unordered_set<VmaAllocation> m_DedicatedAllocations{};
 
     ResourceID m_Device;
 
     friend class VulkanDevice;
+    friend class VulkanDefragmenter;
 };
\ No newline at end of file
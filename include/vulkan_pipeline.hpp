@@ -1,6 +1,9 @@
 #pragma once
+#include <cstring>
 #include <span>
+#include <stdexcept>
 #include <string>
+#include <type_traits>
 #include <vector>
 #include <Volk/volk.h>
 
@@ -9,11 +12,30 @@
 
 class VulkanDevice;
 
+// Specialization constant values for a shader stage. Boolean constants must be set as VkBool32
+struct VulkanSpecialization
+{
+    template <typename T>
+    void set(uint32_t p_ConstantID, const T& p_Value);
+
+    [[nodiscard]] bool empty() const { return entries.empty(); }
+    [[nodiscard]] VkSpecializationInfo getInfo() const;
+
+    std::vector<VkSpecializationMapEntry> entries;
+    std::vector<uint8_t> data;
+};
+
 struct VulkanPipelineBuilder
 {
     explicit VulkanPipelineBuilder(ResourceID p_Device);
-
-    void addShaderStage(ResourceID p_Shader, std::string_view p_Entrypoint = "main");
+    // The state structs point into the builder's own vectors, copies are re-pointed at their own storage.
+    // Moves keep the vector buffers, so the pointers stay valid and the defaults are enough
+    VulkanPipelineBuilder(const VulkanPipelineBuilder& p_Other);
+    VulkanPipelineBuilder(VulkanPipelineBuilder&& p_Other) noexcept = default;
+    VulkanPipelineBuilder& operator=(const VulkanPipelineBuilder& p_Other);
+    VulkanPipelineBuilder& operator=(VulkanPipelineBuilder&& p_Other) noexcept = default;
+
+    void addShaderStage(ResourceID p_Shader, std::string_view p_Entrypoint = "main", const VulkanSpecialization& p_Specialization = {});
     void resetShaderStages();
 
     void setVertexInputState(const VkPipelineVertexInputStateCreateInfo& p_State);
@@ -64,8 +86,9 @@ private:
     {
         ResourceID shader;
         std::string entrypoint;
+        VulkanSpecialization specialization;
 
-        ShaderData(const ResourceID p_Shader, const std::string_view p_Entrypoint) : shader(p_Shader), entrypoint(p_Entrypoint) {}
+        ShaderData(const ResourceID p_Shader, const std::string_view p_Entrypoint, const VulkanSpecialization& p_Specialization = {}) : shader(p_Shader), entrypoint(p_Entrypoint), specialization(p_Specialization) {}
         explicit ShaderData(const ResourceID p_Shader) : shader(p_Shader), entrypoint("main") {}
     };
 
@@ -80,9 +103,11 @@ private:
 
     ResourceID m_Device;
 
-    void createShaderStages(VkPipelineShaderStageCreateInfo p_Container[]) const;
+    // p_Specializations must have one slot per stage and outlive the pipeline creation
+    void createShaderStages(VkPipelineShaderStageCreateInfo p_Container[], VkSpecializationInfo p_Specializations[]) const;
 
     friend class VulkanDevice;
+    friend class VulkanShaderHotReloader;
 };
 
 class VulkanPipeline final : public VulkanDeviceSubresource
@@ -107,6 +132,7 @@ private:
 
     friend class VulkanDevice;
     friend class VulkanCommandBuffer;
+    friend class VulkanShaderHotReloader;
 };
 
 class VulkanPipelineLayout final : public VulkanDeviceSubresource
@@ -114,12 +140,15 @@ class VulkanPipelineLayout final : public VulkanDeviceSubresource
 public:
     VkPipelineLayout operator*() const;
 
+    [[nodiscard]] std::span<const ResourceID> getDescriptorSetLayouts() const { return m_DescriptorSetLayouts; }
+
 private:
     void free() override;
 
-    VulkanPipelineLayout(uint32_t p_Device, VkPipelineLayout p_Handle);
+    VulkanPipelineLayout(uint32_t p_Device, VkPipelineLayout p_Handle, std::span<const ResourceID> p_DescriptorSetLayouts);
 
     VkPipelineLayout m_VkHandle = VK_NULL_HANDLE;
+    std::vector<ResourceID> m_DescriptorSetLayouts;
 
     friend class VulkanDevice;
     friend class VulkanCommandBuffer;
@@ -140,3 +169,28 @@ private:
     friend class VulkanDevice;
     friend class VulkanCommandBuffer;
 };
+
+template <typename T>
+void VulkanSpecialization::set(const uint32_t p_ConstantID, const T& p_Value)
+{
+    static_assert(std::is_trivially_copyable_v<T> && !std::is_same_v<T, bool>, "Specialization constants must be trivially copyable, use VkBool32 for booleans");
+
+    for (const VkSpecializationMapEntry& l_Entry : entries)
+    {
+        if (l_Entry.constantID != p_ConstantID)
+        {
+            continue;
+        }
+        // Constant IDs must stay unique, and the shader fixes the type of each one
+        if (l_Entry.size != sizeof(T))
+        {
+            throw std::runtime_error("Specialization constant " + std::to_string(p_ConstantID) + " was set with " + std::to_string(l_Entry.size) + " bytes before, now with " + std::to_string(sizeof(T)));
+        }
+        memcpy(data.data() + l_Entry.offset, &p_Value, sizeof(T));
+        return;
+    }
+
+    entries.push_back({p_ConstantID, static_cast<uint32_t>(data.size()), sizeof(T)});
+    data.resize(data.size() + sizeof(T));
+    memcpy(data.data() + entries.back().offset, &p_Value, sizeof(T));
+}
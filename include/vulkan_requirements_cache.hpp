@@ -0,0 +1,86 @@
+#pragma once
+#include <shared_mutex>
+#include <unordered_map>
+#include <Volk/volk.h>
+
+#include "vulkan_buffer.hpp"
+#include "vulkan_image.hpp"
+#include "utils/identifiable.hpp"
+
+class VulkanDevice;
+
+// Predicts memory requirements from create parameters without needing a live object, so pools can be sized and
+// placement decided up front. Safe to query from worker threads
+class VulkanMemoryRequirementsCache
+{
+public:
+    explicit VulkanMemoryRequirementsCache(ResourceID p_Device);
+    VulkanMemoryRequirementsCache(const VulkanMemoryRequirementsCache&) = delete;
+    VulkanMemoryRequirementsCache& operator=(const VulkanMemoryRequirementsCache&) = delete;
+
+    // Buffers are cached per power-of-two size class, the returned size is the requested size rounded to the class alignment
+    [[nodiscard]] VkMemoryRequirements getBufferRequirements(const VulkanBuffer::Config& p_Config, VkBufferCreateFlags p_Flags = 0) const;
+    [[nodiscard]] VkMemoryRequirements getImageRequirements(const VulkanImage::Config& p_Config) const;
+    [[nodiscard]] uint32_t findMemoryType(const VkMemoryRequirements& p_Requirements, const VulkanMemoryAllocator::MemoryPreferences& p_Preferences) const;
+
+    void clear();
+    [[nodiscard]] size_t getEntryCount() const;
+
+private:
+    struct BufferKey
+    {
+        VkBufferUsageFlags usage;
+        VkBufferCreateFlags flags;
+        VkDeviceSize sizeClass;
+
+        bool operator==(const BufferKey& p_Other) const = default;
+    };
+
+    struct ImageKey
+    {
+        VkImageType type;
+        VkFormat format;
+        VkExtent3D extent;
+        uint32_t mipLevels;
+        uint32_t arrayLayers;
+        VkSampleCountFlagBits samples;
+        VkImageTiling tiling;
+        VkImageUsageFlags usage;
+        VkImageCreateFlags flags;
+
+        bool operator==(const ImageKey& p_Other) const;
+    };
+
+    struct MemoryTypeKey
+    {
+        uint32_t memoryTypeBits;
+        VmaMemoryUsage usage;
+        VmaAllocationCreateFlags vmaFlags;
+        VkMemoryPropertyFlags desiredProperties;
+        VkMemoryPropertyFlags preferredProperties;
+        uint32_t forceMemoryIndex;
+
+        bool operator==(const MemoryTypeKey& p_Other) const = default;
+    };
+
+    struct KeyHash
+    {
+        size_t operator()(const BufferKey& p_Key) const;
+        size_t operator()(const ImageKey& p_Key) const;
+        size_t operator()(const MemoryTypeKey& p_Key) const;
+    };
+
+    // How requirements are queried without a live object, PROBE creates and destroys a throwaway one
+    enum class QueryPath : uint8_t { CORE, EXTENSION, PROBE };
+
+    [[nodiscard]] VkMemoryRequirements queryBufferRequirements(const VkBufferCreateInfo& p_Info) const;
+    [[nodiscard]] VkMemoryRequirements queryImageRequirements(const VkImageCreateInfo& p_Info) const;
+    [[nodiscard]] static QueryPath getQueryPath(const VulkanDevice& p_Device);
+
+    ResourceID m_Device;
+
+    mutable std::shared_mutex m_Mutex;
+    mutable std::unordered_map<BufferKey, VkMemoryRequirements, KeyHash> m_BufferRequirements;
+    mutable std::unordered_map<ImageKey, VkMemoryRequirements, KeyHash> m_ImageRequirements;
+    mutable std::unordered_map<MemoryTypeKey, uint32_t, KeyHash> m_MemoryTypes;
+};
@@ -1,4 +1,8 @@
 #pragma once
+#include <array>
+#include <filesystem>
+#include <memory>
+#include <mutex>
 #include <span>
 #include <string>
 #include <unordered_map>
@@ -7,9 +11,11 @@
 #include <slang/slang.h>
 #include <Volk/volk.h>
 
+#include "vulkan_shader_cache.hpp"
 #include "utils/identifiable.hpp"
 
 class VulkanDevice;
+struct ShaderReflectionData;
 
 class VulkanShader
 {
@@ -28,10 +34,70 @@ public:
         std::string error;
     };
 
+    struct Stats
+    {
+        enum CacheResult : uint8_t { CACHE_DISABLED, CACHE_HIT, CACHE_MISS };
+
+        struct ModuleLoad
+        {
+            std::string name;
+            double milliseconds;
+            bool fromCache;
+        };
+
+        struct EntryPointCode
+        {
+            std::string name;
+            VkShaderStageFlagBits stage;
+            double milliseconds;
+            size_t spirvBytes;
+        };
+
+        CacheResult cache = CACHE_DISABLED;
+        double sessionMilliseconds = 0.0;
+        double linkMilliseconds = 0.0;
+        std::vector<ModuleLoad> modules;
+        std::vector<EntryPointCode> entryPoints;
+        size_t spirvBytes = 0;
+    };
+
+    struct ProfileReport
+    {
+        struct ModuleTotals
+        {
+            uint32_t loads = 0;
+            uint32_t cachedLoads = 0;
+            double milliseconds = 0.0;
+        };
+
+        uint32_t shaders = 0;
+        uint32_t cacheHits = 0;
+        uint32_t cacheMisses = 0;
+        uint32_t sessions = 0;
+        double sessionMilliseconds = 0.0;
+        double moduleMilliseconds = 0.0;
+        double linkMilliseconds = 0.0;
+        double codegenMilliseconds = 0.0;
+        size_t spirvBytes = 0;
+        // Keyed by module name so shared imports that get loaded over and over stand out
+        std::unordered_map<std::string, ModuleTotals> modules;
+    };
+
     static void reset(VulkanShader& p_Shader);
     static void reinit(VulkanShader& p_Shader, ThreadID p_CompilationThread, bool p_Optimize = true, std::span<const MacroDef> p_Macros = {});
 
-    VulkanShader() = default;
+    // Persistent SPIR-V cache shared by every shader. Must be set up before any compilation thread starts
+    static void enableDiskCache(std::string_view p_Directory, uint64_t p_MaxBytes = 256ULL * 1024 * 1024);
+    static void disableDiskCache();
+    [[nodiscard]] static VulkanShaderCache* getDiskCache() { return s_DiskCache.get(); }
+
+    // Totals over every shader since the last reset, safe to use while compilation threads are running
+    [[nodiscard]] static ProfileReport getProfileReport();
+    static void resetProfileReport();
+    // Logs the totals and the modules that took the longest to load overall
+    static void logProfileReport(uint32_t p_TopModules = 10);
+
+    VulkanShader();
 
     explicit VulkanShader(ThreadID p_CompilationThread, bool p_Optimize = true, std::span<const MacroDef> p_Macros = {});
     ~VulkanShader();
@@ -44,10 +110,16 @@ public:
     void linkAndFinalize();
 
     [[nodiscard]] const Result& getStatus() const { return m_Result; }
-    [[nodiscard]] std::vector<uint32_t> getSPIRVForStage(VkShaderStageFlagBits p_Stage);
-    [[nodiscard]] std::vector<uint32_t> getSPIRVFromName(std::string_view p_Name);
+    // Code for every entry point is generated once by linkAndFinalize, the views stay valid for the lifetime of the shader
+    [[nodiscard]] std::span<const uint32_t> getSPIRVForStage(VkShaderStageFlagBits p_Stage);
+    [[nodiscard]] std::span<const uint32_t> getSPIRVFromName(std::string_view p_Name);
     [[nodiscard]] const std::vector<MacroDef>& getMacros() const { return m_Macros; }
-    [[nodiscard]] slang::ProgramLayout* getLayout() const;
+    [[nodiscard]] bool isFromCache() const { return m_FromCache; }
+    [[nodiscard]] const Stats& getStats() const { return m_Stats; }
+    // On a cache hit this compiles the program on first use, since the cache only holds SPIR-V
+    [[nodiscard]] slang::ProgramLayout* getLayout();
+    // Restored from the disk cache when possible, otherwise built from the layout once and stored for later runs
+    [[nodiscard]] const ShaderReflectionData& getReflection();
 
     static SlangStage getSlangStageFromVkStage(VkShaderStageFlagBits p_Stage);
     static VkShaderStageFlagBits getVkStageFromSlangStage(SlangStage p_Stage);
@@ -55,7 +127,34 @@ public:
     void addSearchPath(const std::string& p_Path) { m_SearchPaths.insert(p_Path); }
 
 private:
+    struct PendingModule
+    {
+        std::string source;
+        std::string name;
+        std::filesystem::path baseDir;
+    };
+
+    static constexpr const char* SPIRV_PROFILE = "spirv_1_5";
+
+    void loadModuleSource(std::string_view p_Source, std::string_view p_ModuleName, const std::filesystem::path& p_BaseDir);
+    bool addModuleToSession(std::string_view p_Source, std::string_view p_ModuleName, const std::filesystem::path& p_BaseDir);
+    void preloadImports(std::string_view p_Source, const std::filesystem::path& p_BaseDir);
+    slang::IModule* loadCachedModule(uint64_t p_Key, const std::string& p_ModuleName, const std::string& p_Path);
+    static void storeModuleIR(slang::IModule* p_Module, uint64_t p_Key);
     bool buildSession();
+    bool buildProgram();
+    bool extractEntryPoints();
+    void buildEntryPointIndex();
+    [[nodiscard]] uint64_t computeCacheKey() const;
+    // Everything besides the sources that changes the output of a session
+    [[nodiscard]] uint64_t hashSessionOptions(uint64_t p_Seed) const;
+
+    // Each one updates both the shader stats and the global report
+    void recordSession(double p_Milliseconds);
+    void recordModuleLoad(std::string_view p_ModuleName, double p_Milliseconds, bool p_FromCache);
+    void recordLink(double p_Milliseconds);
+    void recordEntryPoint(std::string_view p_Name, VkShaderStageFlagBits p_Stage, double p_Milliseconds, size_t p_SPIRVBytes);
+    void recordCacheResult(Stats::CacheResult p_Result);
 
     ThreadID m_CompilationThread = 0;
     bool m_Optimize = true;
@@ -66,8 +165,31 @@ private:
 
     Result m_Result;
 
-    inline static std::unordered_map<ThreadID, slang::IGlobalSession*> s_SlangSessions;
+    // Only filled while the disk cache is enabled, sources are kept until the program is built
+    std::vector<PendingModule> m_PendingModules;
+    uint64_t m_SourceHash = VulkanShaderCache::HASH_SEED;
+    bool m_FromCache = false;
+    // Modules already in the session, a module can only be deserialized into it once
+    std::unordered_set<std::string> m_LoadedModules;
+
+    // Views into either the Slang code blobs or the entries loaded from the disk cache
+    std::vector<VulkanShaderCache::EntryPointView> m_EntryPoints;
+    std::vector<slang::IBlob*> m_CodeBlobs;
+    std::vector<VulkanShaderCache::EntryPoint> m_CachedEntryPoints;
+    std::array<uint32_t, 32> m_StageIndex{};
+    std::unordered_map<std::string_view, uint32_t> m_NameIndex;
+
+    std::unique_ptr<ShaderReflectionData> m_Reflection;
+
+    Stats m_Stats;
+
+    inline static ProfileReport s_ProfileReport;
+    inline static std::mutex s_ProfileMutex;
+
+    inline static std::unique_ptr<VulkanShaderCache> s_DiskCache;
 
+    // The global session m_SlangSession was created from, its pool reference is dropped with the session
+    slang::IGlobalSession* m_GlobalSession = nullptr;
     slang::ISession* m_SlangSession = nullptr;
 
     std::vector<slang::IComponentType*> m_SlangComponents;
@@ -94,4 +216,5 @@ private:
     friend class VulkanDevice;
     friend class VulkanPipeline;
     friend struct VulkanPipelineBuilder;
+    friend class VulkanShaderHotReloader;
 };
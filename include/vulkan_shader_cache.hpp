@@ -0,0 +1,99 @@
+#pragma once
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <Volk/volk.h>
+
+// Content-addressed SPIR-V cache on disk. Each entry holds every entry point of a linked program and is named after
+// its key. Serialized Slang modules live next to them so imported modules are only parsed once.
+// Writers go through a temporary file and an atomic rename so several processes can share the directory
+class VulkanShaderCache
+{
+public:
+    struct EntryPoint
+    {
+        std::string name;
+        VkShaderStageFlagBits stage;
+        std::vector<uint32_t> spirv;
+    };
+
+    struct EntryPointView
+    {
+        std::string_view name;
+        VkShaderStageFlagBits stage;
+        std::span<const uint32_t> spirv;
+    };
+
+    struct ImportedModule
+    {
+        std::string name;
+        std::filesystem::path path;
+        // Covers the module source and everything it imports or includes
+        uint64_t sourceHash;
+    };
+
+    explicit VulkanShaderCache(std::string_view p_Directory, uint64_t p_MaxBytes = 256ULL * 1024 * 1024);
+    VulkanShaderCache(const VulkanShaderCache&) = delete;
+    VulkanShaderCache& operator=(const VulkanShaderCache&) = delete;
+
+    [[nodiscard]] bool load(uint64_t p_Key, std::vector<EntryPoint>& p_EntryPoints) const;
+    void store(uint64_t p_Key, std::span<const EntryPointView> p_EntryPoints);
+
+    // Serialized module IR. Loaded modules are also kept in memory so later shaders in the same process skip the read
+    [[nodiscard]] std::shared_ptr<const std::vector<uint8_t>> loadModule(uint64_t p_Key);
+    void storeModule(uint64_t p_Key, std::span<const uint8_t> p_Data);
+
+    // Serialized ShaderReflectionData, stored under the same key as the SPIR-V of the program
+    [[nodiscard]] bool loadReflection(uint64_t p_Key, std::vector<uint8_t>& p_Data) const;
+    void storeReflection(uint64_t p_Key, std::span<const uint8_t> p_Data);
+
+    // Removes the least recently used entries until the directory fits in the size limit
+    void evict();
+    void clear();
+
+    [[nodiscard]] const std::filesystem::path& getDirectory() const { return m_Directory; }
+    [[nodiscard]] uint64_t getMaxBytes() const { return m_MaxBytes; }
+
+    // FNV-1a, stable across runs and platforms so keys survive a restart
+    static constexpr uint64_t HASH_SEED = 0xcbf29ce484222325ULL;
+    [[nodiscard]] static uint64_t hash(std::string_view p_Data, uint64_t p_Seed = HASH_SEED);
+    [[nodiscard]] static uint64_t hash(const void* p_Data, size_t p_Size, uint64_t p_Seed = HASH_SEED);
+
+    // Hashes a module source together with every file it imports or includes, resolved against the module directory
+    // and the search paths. Unresolved dependencies only contribute their name
+    [[nodiscard]] static uint64_t hashModuleSource(std::string_view p_Source, const std::filesystem::path& p_BaseDir, const std::unordered_set<std::string>& p_SearchPaths, uint64_t p_Seed = HASH_SEED);
+    // Every file the source transitively imports or includes that resolves on disk, using the same rules as hashModuleSource
+    [[nodiscard]] static std::vector<std::filesystem::path> collectDependencies(std::string_view p_Source, const std::filesystem::path& p_BaseDir, const std::unordered_set<std::string>& p_SearchPaths);
+    // Modules the source transitively imports by name, ordered so that every module comes after its own imports
+    [[nodiscard]] static std::vector<ImportedModule> collectImports(std::string_view p_Source, const std::filesystem::path& p_BaseDir, const std::unordered_set<std::string>& p_SearchPaths);
+
+private:
+    static constexpr uint32_t FILE_MAGIC = 0x43534B56; // "VKSC"
+    static constexpr uint32_t MODULE_MAGIC = 0x4D534B56; // "VKSM"
+    static constexpr uint32_t REFLECTION_MAGIC = 0x52534B56; // "VKSR"
+    static constexpr uint32_t FILE_VERSION = 1;
+
+    [[nodiscard]] std::filesystem::path getEntryPath(uint64_t p_Key, std::string_view p_Extension) const;
+    static bool writeEntry(const std::filesystem::path& p_Path, std::string_view p_Data);
+    // Entries made of the common header followed by an opaque blob
+    static bool readBlob(const std::filesystem::path& p_Path, uint32_t p_Magic, uint64_t p_Key, std::vector<uint8_t>& p_Data);
+    static bool writeBlob(const std::filesystem::path& p_Path, uint32_t p_Magic, uint64_t p_Key, std::span<const uint8_t> p_Data);
+
+    static uint64_t hashDependencies(std::string_view p_Source, const std::filesystem::path& p_BaseDir, const std::unordered_set<std::string>& p_SearchPaths, std::unordered_set<std::string>& p_Visited, uint64_t p_Hash);
+    static void collectDependencies(std::string_view p_Source, const std::filesystem::path& p_BaseDir, const std::unordered_set<std::string>& p_SearchPaths, std::unordered_set<std::string>& p_Visited, std::vector<std::filesystem::path>& p_Files);
+    static void collectImports(std::string_view p_Source, const std::filesystem::path& p_BaseDir, const std::unordered_set<std::string>& p_SearchPaths, std::unordered_set<std::string>& p_Visited, std::vector<ImportedModule>& p_Modules);
+
+    std::filesystem::path m_Directory;
+    uint64_t m_MaxBytes;
+
+    std::mutex m_EvictionMutex;
+
+    std::mutex m_ModuleMutex;
+    std::unordered_map<uint64_t, std::shared_ptr<const std::vector<uint8_t>>> m_Modules;
+};
@@ -0,0 +1,85 @@
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+#include <Volk/volk.h>
+
+#include "vulkan_shader.hpp"
+#include "utils/identifiable.hpp"
+#include "utils/shader_reflection.hpp"
+
+// Compiles batches of shaders on a pool of worker threads. Every worker leases its Slang global session through
+// a dedicated ThreadID, so callers must pick a range of IDs that no other compilation thread uses. The sessions go
+// back to VulkanShaderSessionPool when the compiler is destroyed
+class VulkanShaderCompiler
+{
+public:
+    struct Request
+    {
+        std::string filename;
+        std::string moduleName;
+        std::vector<VulkanShader::MacroDef> macros;
+        std::vector<VkShaderStageFlagBits> stages;
+        std::vector<std::string> searchPaths;
+        bool optimize = true;
+        bool reflect = true;
+    };
+
+    struct StageCode
+    {
+        VkShaderStageFlagBits stage;
+        std::vector<uint32_t> spirv;
+    };
+
+    struct Output
+    {
+        VulkanShader::Result result;
+        std::vector<StageCode> stages;
+        ShaderReflectionData reflection;
+        VulkanShader::Stats stats;
+    };
+
+    // A worker count of 0 uses one worker per hardware thread. Workers take the IDs [p_FirstWorkerThread, p_FirstWorkerThread + count)
+    explicit VulkanShaderCompiler(ThreadID p_FirstWorkerThread, uint32_t p_WorkerCount = 0);
+    ~VulkanShaderCompiler();
+    VulkanShaderCompiler(const VulkanShaderCompiler&) = delete;
+    VulkanShaderCompiler& operator=(const VulkanShaderCompiler&) = delete;
+
+    [[nodiscard]] std::future<Output> submit(Request p_Request);
+    [[nodiscard]] std::vector<std::future<Output>> submit(std::span<const Request> p_Requests);
+
+    // Hands each result to the callback on the calling thread as soon as it is ready, in completion order. This is
+    // where shader modules should be created, since device resource creation is not meant for the worker threads
+    void consume(std::span<std::future<Output>> p_Futures, const std::function<void(size_t, Output&&)>& p_Callback);
+
+    void waitIdle();
+
+    [[nodiscard]] uint32_t getWorkerCount() const { return static_cast<uint32_t>(m_Workers.size()); }
+    [[nodiscard]] size_t getPendingCount() const;
+
+private:
+    struct Job
+    {
+        Request request;
+        std::promise<Output> promise;
+    };
+
+    void workerLoop(ThreadID p_ThreadID);
+    static Output compile(const Request& p_Request, ThreadID p_ThreadID);
+
+    ThreadID m_FirstWorkerThread;
+    std::vector<std::thread> m_Workers;
+
+    mutable std::mutex m_Mutex;
+    std::condition_variable m_JobAvailable;
+    std::condition_variable m_JobFinished;
+    std::deque<Job> m_Jobs;
+    size_t m_Pending = 0;
+    bool m_Stop = false;
+};
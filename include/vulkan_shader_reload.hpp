@@ -0,0 +1,120 @@
+#pragma once
+#include <atomic>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <Volk/volk.h>
+
+#include "vulkan_pipeline.hpp"
+#include "vulkan_shader.hpp"
+#include "utils/identifiable.hpp"
+
+// Watches shader sources and every file they import. Changed shaders are recompiled on a background thread and the
+// new modules and pipelines are swapped in at a frame boundary, so module and pipeline IDs stay valid across reloads.
+// Uses inotify on Linux and falls back to polling modification times elsewhere
+class VulkanShaderHotReloader
+{
+public:
+    struct Source
+    {
+        std::string filename;
+        std::string moduleName;
+        std::vector<VulkanShader::MacroDef> macros;
+        std::vector<std::string> searchPaths;
+        bool optimize = true;
+    };
+
+    // The compilation thread ID leases its own Slang global session and must not be used by any other thread, the
+    // lease is released on destruction.
+    // Replaced handles are destroyed after p_FramesInFlight calls to applyPendingReloads
+    VulkanShaderHotReloader(ResourceID p_Device, ThreadID p_CompilationThread, uint32_t p_FramesInFlight = 2);
+    ~VulkanShaderHotReloader();
+    VulkanShaderHotReloader(const VulkanShaderHotReloader&) = delete;
+    VulkanShaderHotReloader& operator=(const VulkanShaderHotReloader&) = delete;
+
+    // Each module is rebuilt from the entry point matching its stage
+    void watchShaderModules(const Source& p_Source, std::span<const ResourceID> p_Modules);
+    void watchPipeline(ResourceID p_Pipeline, const VulkanPipelineBuilder& p_Builder);
+    void watchComputePipeline(ResourceID p_Pipeline, ResourceID p_Shader, std::string_view p_Entrypoint, const VulkanSpecialization& p_Specialization = {});
+
+    // Call once per frame on the thread that records commands, after the previous frame has been submitted.
+    // Returns the number of shaders that were swapped in
+    uint32_t applyPendingReloads();
+    // Destroys every replaced handle right away, the GPU must not be using them anymore
+    void flushRetired();
+
+    [[nodiscard]] size_t getWatchedFileCount() const;
+
+private:
+    struct WatchedModule
+    {
+        ResourceID module;
+        VkShaderStageFlagBits stage;
+    };
+
+    struct WatchedShader
+    {
+        Source source;
+        std::vector<WatchedModule> modules;
+        std::vector<std::string> files;
+    };
+
+    struct WatchedPipeline
+    {
+        ResourceID pipeline;
+        std::optional<VulkanPipelineBuilder> builder;
+        ResourceID computeShader = UINT32_MAX;
+        std::string entrypoint;
+        VulkanSpecialization specialization;
+    };
+
+    struct CompiledShader
+    {
+        uint32_t shader;
+        std::vector<std::pair<VkShaderStageFlagBits, std::vector<uint32_t>>> stages;
+    };
+
+    struct RetiredHandle
+    {
+        uint64_t frame;
+        VkShaderModule module = VK_NULL_HANDLE;
+        VkPipeline pipeline = VK_NULL_HANDLE;
+    };
+
+    void watcherLoop();
+    [[nodiscard]] std::vector<std::string> waitForChanges();
+    void recompile(uint32_t p_Shader);
+    void updateDependencies(uint32_t p_Shader);
+    void watchDirectory(const std::filesystem::path& p_Directory);
+    void destroyHandle(const RetiredHandle& p_Handle) const;
+
+    ResourceID m_Device;
+    ThreadID m_CompilationThread;
+    uint32_t m_FramesInFlight;
+    uint64_t m_Frame = 0;
+
+    mutable std::mutex m_Mutex;
+    std::vector<WatchedShader> m_Shaders;
+    std::vector<WatchedPipeline> m_Pipelines;
+    std::unordered_map<std::string, std::unordered_set<uint32_t>> m_Dependents;
+    std::unordered_set<std::string> m_WatchedDirectories;
+    std::vector<CompiledShader> m_Ready;
+
+    std::vector<RetiredHandle> m_Retired;
+
+#ifdef __linux__
+    int m_INotify = -1;
+    std::unordered_map<int, std::filesystem::path> m_WatchDescriptors;
+#else
+    std::unordered_map<std::string, std::filesystem::file_time_type> m_Timestamps;
+#endif
+
+    std::atomic<bool> m_Stop = false;
+    std::thread m_Thread;
+};
@@ -0,0 +1,72 @@
+#pragma once
+#include <future>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "utils/identifiable.hpp"
+
+namespace slang
+{
+    struct IGlobalSession;
+}
+
+// Owns every Slang global session and leases them to compilation threads by ThreadID. Creating a global session is
+// expensive, so prewarm builds them on background threads ahead of time and acquire only waits if one is still in
+// flight. A thread ID keeps the same session until it is released back to the pool. Every ISession created from a
+// global session is counted through retainSession and releaseSession, and a session only becomes idle again once its
+// lease is released and none of its ISessions are alive
+class VulkanShaderSessionPool
+{
+public:
+    enum class Mode : uint8_t
+    {
+        // One global session per leased thread ID, the only setup Slang documents as thread safe
+        PER_THREAD,
+        // A single global session for every thread, each shader still creating its own ISession from it. Calls on the
+        // global session are serialized through lockGlobalSession, but compilation on the sessions created from it
+        // runs in parallel, so only use it with Slang builds where those sessions are independent
+        SHARED
+    };
+
+    // Starts creating p_Count global sessions in the background and returns right away. SHARED creates a single one
+    static void prewarm(uint32_t p_Count, Mode p_Mode = Mode::PER_THREAD);
+
+    // Returns nullptr if the session could not be created
+    [[nodiscard]] static slang::IGlobalSession* acquire(ThreadID p_Thread);
+    // Ends the lease of the thread. Its global session stays out of the pool until every ISession created from it is released
+    static void release(ThreadID p_Thread);
+    // Counts an ISession created from p_Session, every call must be matched by releaseSession once the ISession is released
+    static void retainSession(slang::IGlobalSession* p_Session);
+    static void releaseSession(slang::IGlobalSession* p_Session);
+    // Waits for pending prewarms and destroys every unused session. Sessions still leased or with live ISessions are
+    // destroyed once their last lease and ISession are released
+    static void shutdown();
+
+    // Holds the shared global session in SHARED mode, the returned lock is empty in PER_THREAD mode
+    [[nodiscard]] static std::unique_lock<std::mutex> lockGlobalSession();
+
+    [[nodiscard]] static Mode getMode();
+    [[nodiscard]] static size_t getIdleCount();
+    [[nodiscard]] static size_t getLeasedCount();
+
+private:
+    [[nodiscard]] static slang::IGlobalSession* createGlobalSession();
+    // Called with s_Mutex held whenever a lease or an ISession of p_Session goes away
+    static void recycle(slang::IGlobalSession* p_Session);
+    [[nodiscard]] static bool isInUse(slang::IGlobalSession* p_Session);
+
+    inline static std::mutex s_Mutex;
+    inline static Mode s_Mode = Mode::PER_THREAD;
+
+    inline static std::vector<slang::IGlobalSession*> s_Idle;
+    inline static std::vector<std::future<slang::IGlobalSession*>> s_Pending;
+    inline static std::unordered_map<ThreadID, slang::IGlobalSession*> s_Leased;
+    // Live ISessions per global session, entries are erased when they reach zero
+    inline static std::unordered_map<slang::IGlobalSession*, uint32_t> s_SessionRefs;
+    // Sessions that outlived shutdown, destroyed by recycle once they are no longer in use
+    inline static std::vector<slang::IGlobalSession*> s_Retired;
+
+    inline static std::shared_future<slang::IGlobalSession*> s_Shared;
+    inline static std::mutex s_SharedMutex;
+};
@@ -0,0 +1,80 @@
+#pragma once
+#include <future>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <Volk/volk.h>
+
+#include "vulkan_pipeline.hpp"
+#include "vulkan_shader.hpp"
+#include "vulkan_shader_compiler.hpp"
+#include "utils/identifiable.hpp"
+#include "utils/shader_reflection.hpp"
+
+// Builds permutations of a base shader. Macros select the variant that gets compiled, while anything that can be
+// expressed as a specialization constant should go through addStages instead so it never triggers a recompile.
+// Variants are deduplicated by a hash of their normalized macro set. Not thread safe, modules are created on the
+// calling thread
+class VulkanShaderVariantManager
+{
+public:
+    struct Variant
+    {
+        std::vector<std::pair<VkShaderStageFlagBits, ResourceID>> modules;
+        ShaderReflectionData reflection;
+        bool compiled = false;
+        // Set when the last compilation failed, the next request for the variant compiles it again
+        std::string error;
+
+        [[nodiscard]] ResourceID getModule(VkShaderStageFlagBits p_Stage) const;
+    };
+
+    // The base request provides the file, stages, search paths and the macros shared by every variant
+    VulkanShaderVariantManager(ResourceID p_Device, VulkanShaderCompiler& p_Compiler, VulkanShaderCompiler::Request p_Base);
+    VulkanShaderVariantManager(const VulkanShaderVariantManager&) = delete;
+    VulkanShaderVariantManager& operator=(const VulkanShaderVariantManager&) = delete;
+
+    // Declares a macro and every value it can take, precompileAll builds the cartesian product of all dimensions
+    void addDimension(std::string_view p_Macro, std::span<const std::string> p_Values);
+
+    // Compiles every permutation not built yet in parallel and waits for all of them
+    void precompileAll();
+    // Starts compiling a variant in the background without waiting for it
+    void prefetch(std::span<const VulkanShader::MacroDef> p_Macros);
+    // Returns the variant for the given macros, compiling it first if needed. Macros override the base ones by name.
+    // A variant that failed to compile comes back with compiled unset and its error
+    [[nodiscard]] const Variant& getVariant(std::span<const VulkanShader::MacroDef> p_Macros);
+
+    // Adds one stage per module of the variant. The specialization is applied to every stage
+    void addStages(VulkanPipelineBuilder& p_Builder, std::span<const VulkanShader::MacroDef> p_Macros, const VulkanSpecialization& p_Specialization = {}, std::string_view p_Entrypoint = "main");
+
+    // Frees every shader module created by this manager
+    void free();
+
+    [[nodiscard]] size_t getVariantCount() const { return m_Variants.size(); }
+    [[nodiscard]] size_t getCompiledCount() const;
+    [[nodiscard]] size_t getPermutationCount() const;
+
+private:
+    struct Entry
+    {
+        std::vector<VulkanShader::MacroDef> macros;
+        std::future<VulkanShaderCompiler::Output> pending;
+        Variant variant;
+    };
+
+    [[nodiscard]] std::vector<VulkanShader::MacroDef> normalize(std::span<const VulkanShader::MacroDef> p_Macros) const;
+    [[nodiscard]] static uint64_t hashMacros(std::span<const VulkanShader::MacroDef> p_Macros);
+
+    Entry& findOrSubmit(std::span<const VulkanShader::MacroDef> p_Macros);
+    void finalize(Entry& p_Entry, VulkanShaderCompiler::Output&& p_Output) const;
+
+    ResourceID m_Device;
+    VulkanShaderCompiler& m_Compiler;
+    VulkanShaderCompiler::Request m_Base;
+
+    std::vector<std::pair<std::string, std::vector<std::string>>> m_Dimensions;
+    std::unordered_map<uint64_t, Entry> m_Variants;
+};
@@ -0,0 +1,104 @@
+#pragma once
+#include <span>
+#include <unordered_map>
+#include <vector>
+#include <Volk/volk.h>
+
+#include "vulkan_memory.hpp"
+#include "vulkan_queues.hpp"
+#include "utils/identifiable.hpp"
+
+class VulkanSparseResidencyManager
+{
+public:
+    VulkanSparseResidencyManager(ResourceID p_Device, const QueueSelection& p_SparseQueue);
+    ~VulkanSparseResidencyManager();
+    VulkanSparseResidencyManager(const VulkanSparseResidencyManager&) = delete;
+    VulkanSparseResidencyManager& operator=(const VulkanSparseResidencyManager&) = delete;
+
+    void registerBuffer(ResourceID p_Buffer);
+    void registerImage(ResourceID p_Image);
+    void release(ResourceID p_Resource);
+
+    [[nodiscard]] VkDeviceSize getBufferPageSize(ResourceID p_Buffer) const;
+    void makeBufferResident(ResourceID p_Buffer, VkDeviceSize p_Offset, VkDeviceSize p_Size);
+    void evictBuffer(ResourceID p_Buffer, VkDeviceSize p_Offset, VkDeviceSize p_Size);
+    [[nodiscard]] bool isBufferResident(ResourceID p_Buffer, VkDeviceSize p_Offset, VkDeviceSize p_Size) const;
+
+    // Tile extent of the image's first aspect. Depth and stencil may use different granularities, ranges are tiled per aspect
+    [[nodiscard]] VkExtent3D getImageTileExtent(ResourceID p_Image) const;
+    // First level that lives in a mip tail for any of the image's aspects
+    [[nodiscard]] uint32_t getImageMipTailFirstLevel(ResourceID p_Image) const;
+    void makeImageResident(ResourceID p_Image, uint32_t p_MipLevel, uint32_t p_ArrayLayer, VkOffset3D p_Offset, VkExtent3D p_Extent);
+    void evictImage(ResourceID p_Image, uint32_t p_MipLevel, uint32_t p_ArrayLayer, VkOffset3D p_Offset, VkExtent3D p_Extent);
+    [[nodiscard]] bool isImageResident(ResourceID p_Image, uint32_t p_MipLevel, uint32_t p_ArrayLayer, VkOffset3D p_Offset, VkExtent3D p_Extent) const;
+
+    // Flushes every queued bind and unbind in a single vkQueueBindSparse
+    void commit(std::span<const ResourceID> p_WaitSemaphores = {}, std::span<const ResourceID> p_SignalSemaphores = {});
+    void waitIdle();
+
+    [[nodiscard]] bool hasPendingBinds() const;
+    [[nodiscard]] VkDeviceSize getResidentBytes() const { return m_ResidentBytes; }
+
+private:
+    struct BufferTable
+    {
+        VkMemoryRequirements requirements;
+        std::vector<VmaAllocation> pages;
+    };
+
+    struct TileRange
+    {
+        uint32_t begin[3];
+        uint32_t end[3];
+    };
+
+    // Formats like depth/stencil can report separate sparse requirements per aspect, each one is tiled on its own
+    struct AspectTable
+    {
+        VkSparseImageMemoryRequirements sparseRequirements;
+        std::vector<uint32_t> levelOffsets;
+        uint32_t tilesPerLayer = 0;
+        std::vector<VmaAllocation> tiles;
+    };
+
+    struct ImageTable
+    {
+        VkMemoryRequirements requirements;
+        VkExtent3D extent;
+        uint32_t arrayLayers;
+        std::vector<AspectTable> aspects;
+        std::vector<VmaAllocation> mipTail;
+    };
+
+    [[nodiscard]] std::vector<VmaAllocation> allocatePages(const VkMemoryRequirements& p_Requirements, VkDeviceSize p_PageSize, size_t p_Count);
+    void retirePage(VmaAllocation p_Page, VkDeviceSize p_Size);
+    void bindImageMipTail(ResourceID p_Image, ImageTable& p_Table, const VkSparseImageMemoryRequirements& p_Requirements, VkSparseMemoryBindFlags p_Flags);
+    void makeAspectResident(ResourceID p_Image, const ImageTable& p_Table, AspectTable& p_Aspect, uint32_t p_MipLevel, uint32_t p_ArrayLayer, VkOffset3D p_Offset, VkExtent3D p_Extent);
+    void evictAspect(ResourceID p_Image, const ImageTable& p_Table, AspectTable& p_Aspect, uint32_t p_MipLevel, uint32_t p_ArrayLayer, VkOffset3D p_Offset, VkExtent3D p_Extent);
+    [[nodiscard]] static bool isAspectResident(const ImageTable& p_Table, const AspectTable& p_Aspect, uint32_t p_MipLevel, uint32_t p_ArrayLayer, VkOffset3D p_Offset, VkExtent3D p_Extent);
+
+    [[nodiscard]] const BufferTable& getBufferTable(ResourceID p_Buffer) const;
+    [[nodiscard]] const ImageTable& getImageTable(ResourceID p_Image) const;
+    [[nodiscard]] static TileRange getTileRange(const ImageTable& p_Table, const AspectTable& p_Aspect, uint32_t p_MipLevel, VkOffset3D p_Offset, VkExtent3D p_Extent);
+    [[nodiscard]] static VkExtent3D getLevelTiles(const ImageTable& p_Table, const AspectTable& p_Aspect, uint32_t p_MipLevel);
+
+    ResourceID m_Device;
+    QueueSelection m_Queue;
+    ResourceID m_Fence = UINT32_MAX;
+    // Only set once a bind was really submitted, a failed submit leaves the fence unsignaled forever
+    bool m_BindPending = false;
+
+    std::unordered_map<ResourceID, BufferTable> m_Buffers;
+    std::unordered_map<ResourceID, ImageTable> m_Images;
+
+    std::unordered_map<ResourceID, std::vector<VkSparseMemoryBind>> m_PendingBufferBinds;
+    std::unordered_map<ResourceID, std::vector<VkSparseMemoryBind>> m_PendingOpaqueBinds;
+    std::unordered_map<ResourceID, std::vector<VkSparseImageMemoryBind>> m_PendingImageBinds;
+
+    // Unbound pages are freed once the bind operation that released them has completed
+    std::vector<VmaAllocation> m_UnboundPages;
+    std::vector<VmaAllocation> m_RetiredPages;
+
+    VkDeviceSize m_ResidentBytes = 0;
+};
@@ -0,0 +1,110 @@
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <mutex>
+#include <span>
+#include <string>
+#include <vector>
+#include <Volk/volk.h>
+
+#include "vulkan_queues.hpp"
+#include "utils/identifiable.hpp"
+
+class VulkanDevice;
+
+class VulkanStreamingLoader
+{
+public:
+    struct BufferRange
+    {
+        ResourceID buffer;
+        VkDeviceSize fileOffset;
+        VkDeviceSize size;
+        VkDeviceSize dstOffset = 0;
+    };
+
+    struct ImageRange
+    {
+        ResourceID image;
+        VkDeviceSize fileOffset;
+        VkDeviceSize size;
+        VkBufferImageCopy region;
+    };
+
+    VulkanStreamingLoader(ResourceID p_Device, const QueueSelection& p_Queue, ThreadID p_ThreadID, VkDeviceSize p_ChunkSize = 8ULL * 1024 * 1024, uint32_t p_ChunkCount = 3);
+    ~VulkanStreamingLoader();
+    VulkanStreamingLoader(const VulkanStreamingLoader&) = delete;
+    VulkanStreamingLoader& operator=(const VulkanStreamingLoader&) = delete;
+
+    bool open(std::string_view p_Filename);
+    void close();
+
+    [[nodiscard]] bool isOpen() const { return m_File.is_open(); }
+    [[nodiscard]] VkDeviceSize getFileSize() const { return m_FileSize; }
+    [[nodiscard]] VkDeviceSize getChunkSize() const { return m_ChunkSize; }
+
+    void streamToBuffer(ResourceID p_Buffer, VkDeviceSize p_DstOffset = 0);
+    void streamRanges(std::span<const BufferRange> p_Ranges);
+    void streamImageRanges(std::span<const ImageRange> p_Ranges, VkImageLayout p_FinalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+private:
+    static constexpr VkDeviceSize PIECE_ALIGNMENT = 16;
+
+    struct Piece
+    {
+        ResourceID target;
+        bool isImage;
+        VkDeviceSize fileOffset;
+        VkDeviceSize size;
+        VkDeviceSize stagingOffset;
+        VkDeviceSize dstOffset;
+        VkBufferImageCopy region;
+    };
+
+    struct Batch
+    {
+        size_t firstPiece;
+        size_t pieceCount;
+    };
+
+    struct Slot
+    {
+        enum State : uint8_t { FREE, READING, FILLED, IN_FLIGHT };
+
+        State state = FREE;
+        size_t batch = 0;
+        ResourceID fence = UINT32_MAX;
+        ResourceID commandBuffer = UINT32_MAX;
+    };
+
+    void addPiece(const Piece& p_Piece);
+    void run(std::span<const ResourceID> p_Images, VkImageLayout p_FinalLayout);
+    void readerLoop();
+    void submitSlot(uint32_t p_Slot, std::span<const ResourceID> p_Images, VkImageLayout p_FinalLayout);
+    void retireSlot(uint32_t p_Slot);
+
+    ResourceID m_Device;
+    QueueSelection m_Queue;
+    ThreadID m_ThreadID;
+
+    VkDeviceSize m_ChunkSize;
+    std::vector<Slot> m_Slots;
+
+    ResourceID m_StagingBuffer = UINT32_MAX;
+    uint8_t* m_StagingData = nullptr;
+
+    std::ifstream m_File;
+    VkDeviceSize m_FileSize = 0;
+
+    std::vector<Piece> m_Pieces;
+    std::vector<Batch> m_Batches;
+
+    std::mutex m_Mutex;
+    std::condition_variable m_SlotFreed;
+    std::condition_variable m_SlotFilled;
+    std::deque<uint32_t> m_FilledSlots;
+    std::exception_ptr m_ReaderError = nullptr;
+    bool m_Abort = false;
+};
@@ -28,6 +28,7 @@ private:
 	friend class VulkanDevice;
 	friend class SDLWindow;
 	friend class VulkanCommandBuffer;
+	friend class VulkanExternalMemoryExtension;
 };
 
 class VulkanSemaphore final : public VulkanDeviceSubresource
@@ -0,0 +1,64 @@
+#pragma once
+#include <map>
+#include <unordered_map>
+#include <Volk/volk.h>
+
+#include "vulkan_queues.hpp"
+#include "utils/identifiable.hpp"
+
+class VulkanCommandBuffer;
+
+class VulkanUploadBatcher
+{
+public:
+    struct Stats
+    {
+        uint32_t writes = 0;
+        uint32_t regions = 0;
+        uint32_t copyCommands = 0;
+        VkDeviceSize bytes = 0;
+    };
+
+    VulkanUploadBatcher(ResourceID p_Device, const QueueSelection& p_Queue, VkDeviceSize p_Capacity = 4ULL * 1024 * 1024);
+    ~VulkanUploadBatcher();
+    VulkanUploadBatcher(const VulkanUploadBatcher&) = delete;
+    VulkanUploadBatcher& operator=(const VulkanUploadBatcher&) = delete;
+
+    void write(ResourceID p_Buffer, VkDeviceSize p_DstOffset, const void* p_Data, VkDeviceSize p_Size);
+    template <typename T>
+    void write(ResourceID p_Buffer, VkDeviceSize p_DstOffset, const T& p_Value) { write(p_Buffer, p_DstOffset, &p_Value, sizeof(T)); }
+    [[nodiscard]] void* reserve(ResourceID p_Buffer, VkDeviceSize p_DstOffset, VkDeviceSize p_Size);
+
+    void flush(const VulkanCommandBuffer& p_CommandBuffer);
+    void reset();
+
+    [[nodiscard]] bool hasPendingWrites() const { return !m_Pending.empty(); }
+    [[nodiscard]] VkDeviceSize getUsedBytes() const { return m_Head; }
+    [[nodiscard]] VkDeviceSize getCapacity() const { return m_Capacity; }
+    [[nodiscard]] const Stats& getLastFlushStats() const { return m_LastFlushStats; }
+
+private:
+    struct Region
+    {
+        VkDeviceSize dstEnd;
+        VkDeviceSize srcOffset;
+    };
+
+    void createStagingBuffer(VkDeviceSize p_Capacity);
+    void grow(VkDeviceSize p_MinCapacity);
+    void insertRegion(ResourceID p_Buffer, VkDeviceSize p_DstOffset, VkDeviceSize p_Size, VkDeviceSize p_SrcOffset);
+
+    ResourceID m_Device;
+    QueueSelection m_Queue;
+
+    ResourceID m_StagingBuffer = UINT32_MAX;
+    uint8_t* m_StagingData = nullptr;
+    VkDeviceSize m_Capacity = 0;
+    VkDeviceSize m_Head = 0;
+    VkDeviceSize m_FlushedHead = 0;
+
+    // Per destination buffer, keyed by destination offset so regions come out sorted at flush time
+    std::unordered_map<ResourceID, std::map<VkDeviceSize, Region>> m_Pending;
+    uint32_t m_PendingWrites = 0;
+    Stats m_LastFlushStats{};
+};
@@ -1,11 +1,21 @@
 #include "ext/vulkan_external_memory.hpp"
 
+#include <ranges>
+#include <stdexcept>
 #include <vulkan/vk_enum_string_helper.h>
 
 #include "vulkan_device.hpp"
 #include "utils/logger.hpp"
 #include "utils/vulkan_base.hpp"
 
+#ifdef _WIN32
+static constexpr VkExternalMemoryHandleTypeFlagBits MEMORY_HANDLE_TYPE = VK_EXTERNAL_MEMORY_HANDLE_TYPE_OPAQUE_WIN32_BIT;
+static constexpr VkExternalSemaphoreHandleTypeFlagBits SEMAPHORE_HANDLE_TYPE = VK_EXTERNAL_SEMAPHORE_HANDLE_TYPE_OPAQUE_WIN32_BIT;
+#else
+static constexpr VkExternalMemoryHandleTypeFlagBits MEMORY_HANDLE_TYPE = VK_EXTERNAL_MEMORY_HANDLE_TYPE_OPAQUE_FD_BIT;
+static constexpr VkExternalSemaphoreHandleTypeFlagBits SEMAPHORE_HANDLE_TYPE = VK_EXTERNAL_SEMAPHORE_HANDLE_TYPE_OPAQUE_FD_BIT;
+#endif
+
 VulkanExternalMemoryExtension* VulkanExternalMemoryExtension::get(const VulkanDevice& p_Device)
 {
     return p_Device.getExtensionManager()->getExtension<VulkanExternalMemoryExtension>(VK_KHR_EXTERNAL_MEMORY_EXTENSION_NAME);
@@ -21,43 +31,80 @@ VulkanExternalMemoryExtension::VulkanExternalMemoryExtension(const ResourceID p_
 {
 }
 
-ResourceID VulkanExternalMemoryExtension::createExternalImage(const VkImageType p_Type, const VkFormat p_Format, const VkExtent3D p_Extent, const VkImageUsageFlags p_Usage, const VkImageCreateFlags p_Flags, VkImageTiling p_Tiling) const
+void VulkanExternalMemoryExtension::free()
 {
-    VulkanDevice& l_Device = VulkanContext::getDevice(getDeviceID());
+    // The device frees its subresources before its extensions, so only the imported memory is left
+    const VulkanDevice& l_Device = VulkanContext::getDevice(getDeviceID());
+    for (const VkDeviceMemory l_Memory : m_ImportedMemory | std::views::values)
+    {
+        l_Device.getTable().vkFreeMemory(*l_Device, l_Memory, nullptr);
+    }
+    m_ImportedMemory.clear();
+}
 
-    VkImageCreateInfo l_ImageInfo{};
-	l_ImageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
-	l_ImageInfo.imageType = p_Type;
-	l_ImageInfo.format = p_Format;
-	l_ImageInfo.extent = p_Extent;
-	l_ImageInfo.mipLevels = 1;
-	l_ImageInfo.arrayLayers = 1;
-	l_ImageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
-	l_ImageInfo.tiling = p_Tiling;
-	l_ImageInfo.usage = p_Usage;
-	l_ImageInfo.flags = p_Flags;
-	l_ImageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-	l_ImageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-	l_ImageInfo.queueFamilyIndexCount = 0;
-	l_ImageInfo.pQueueFamilyIndices = nullptr;
+ResourceID VulkanExternalMemoryExtension::createExternalImage(const VkImageType p_Type, const VkFormat p_Format, const VkExtent3D p_Extent, const VkImageUsageFlags p_Usage, const VkImageCreateFlags p_Flags, const VkImageTiling p_Tiling) const
+{
+    return createExternalImage({.type = p_Type, .format = p_Format, .extent = p_Extent, .usage = p_Usage, .flags = p_Flags, .tiling = p_Tiling});
+}
+
+ResourceID VulkanExternalMemoryExtension::createExternalImage(const VulkanImage::Config& p_Config) const
+{
+    VulkanDevice& l_Device = VulkanContext::getDevice(getDeviceID());
 
     VkExternalMemoryImageCreateInfo l_ExternInfo{};
     l_ExternInfo.sType = VK_STRUCTURE_TYPE_EXTERNAL_MEMORY_IMAGE_CREATE_INFO;
-#ifdef _WIN32
-    l_ExternInfo.handleTypes = VK_EXTERNAL_MEMORY_HANDLE_TYPE_OPAQUE_WIN32_BIT;
-#else
-    l_ExternInfo.handleTypes = VK_EXTERNAL_MEMORY_HANDLE_TYPE_OPAQUE_FD_BIT;
-#endif
+    l_ExternInfo.handleTypes = MEMORY_HANDLE_TYPE;
+
+    VkImageCreateInfo l_ImageInfo{};
+    l_ImageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
     l_ImageInfo.pNext = &l_ExternInfo;
+    l_ImageInfo.imageType = p_Config.type;
+    l_ImageInfo.format = p_Config.format;
+    l_ImageInfo.extent = p_Config.extent;
+    l_ImageInfo.mipLevels = p_Config.mipLevels;
+    l_ImageInfo.arrayLayers = p_Config.arrayLayers;
+    l_ImageInfo.samples = p_Config.samples;
+    l_ImageInfo.tiling = p_Config.tiling;
+    l_ImageInfo.usage = p_Config.usage;
+    l_ImageInfo.flags = p_Config.flags;
+    l_ImageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    l_ImageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    l_ImageInfo.queueFamilyIndexCount = 0;
+    l_ImageInfo.pQueueFamilyIndices = nullptr;
 
     VkImage l_Image;
     VULKAN_TRY(l_Device.getTable().vkCreateImage(*l_Device, &l_ImageInfo, nullptr, &l_Image));
 
-    VulkanImage* l_NewRes = ARENA_ALLOC(VulkanImage){getDeviceID(), l_Image, p_Extent, p_Type, VK_IMAGE_LAYOUT_UNDEFINED};
-    LOG_DEBUG("Created image (ID:", l_NewRes->getID(), ")");
-    l_Device.insertImage(l_NewRes);
+    VulkanImage* l_NewRes = ARENA_ALLOC(VulkanImage){getDeviceID(), l_Image, p_Config.extent, p_Config.type, VK_IMAGE_LAYOUT_UNDEFINED, p_Config.format, p_Config.mipLevels, p_Config.arrayLayers, p_Config.samples, p_Config.usage, p_Config.tiling, p_Config.flags};
+    LOG_DEBUG("Created external image (ID:", l_NewRes->getID(), ")");
+    l_Device.insertSubresource(l_NewRes);
+
+    return l_NewRes->getID();
+}
+
+ResourceID VulkanExternalMemoryExtension::createExternalBuffer(const VulkanBuffer::Config& p_Config) const
+{
+    VulkanDevice& l_Device = VulkanContext::getDevice(getDeviceID());
+
+    VkExternalMemoryBufferCreateInfo l_ExternInfo{};
+    l_ExternInfo.sType = VK_STRUCTURE_TYPE_EXTERNAL_MEMORY_BUFFER_CREATE_INFO;
+    l_ExternInfo.handleTypes = MEMORY_HANDLE_TYPE;
+
+    VkBufferCreateInfo l_BufferInfo{};
+    l_BufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    l_BufferInfo.pNext = &l_ExternInfo;
+    l_BufferInfo.size = p_Config.size;
+    l_BufferInfo.usage = p_Config.usage;
+    l_BufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 
-	return l_NewRes->getID();
+    VkBuffer l_Buffer;
+    VULKAN_TRY(l_Device.getTable().vkCreateBuffer(*l_Device, &l_BufferInfo, nullptr, &l_Buffer));
+
+    VulkanBuffer* l_NewRes = ARENA_ALLOC(VulkanBuffer){getDeviceID(), l_Buffer, p_Config.size, p_Config.usage};
+    LOG_DEBUG("Created external buffer (ID:", l_NewRes->getID(), ") with size ", VulkanMemoryAllocator::compactBytes(p_Config.size));
+    l_Device.insertSubresource(l_NewRes);
+
+    return l_NewRes->getID();
 }
 
 void VulkanExternalMemoryExtension::allocateExport(ResourceID p_Resource, VulkanMemoryAllocator::MemoryPreferences p_MemoryProperties) const
@@ -72,11 +119,7 @@ void VulkanExternalMemoryExtension::allocateExport(ResourceID p_Resource, Vulkan
 
     VkExportMemoryAllocateInfo l_ExportAlloc = {};
     l_ExportAlloc.sType = VK_STRUCTURE_TYPE_EXPORT_MEMORY_ALLOCATE_INFO;
-#ifdef _WIN32
-    l_ExportAlloc.handleTypes = VK_EXTERNAL_MEMORY_HANDLE_TYPE_OPAQUE_WIN32_BIT;
-#else
-    l_ExportAlloc.handleTypes = VK_EXTERNAL_MEMORY_HANDLE_TYPE_OPAQUE_FD_BIT;
-#endif
+    l_ExportAlloc.handleTypes = MEMORY_HANDLE_TYPE;
 
     const VkMemoryRequirements l_Requirements = l_MemArray->getMemoryRequirements();
     const uint32_t l_MemType = l_Device.getMemoryAllocator().findMemoryType(l_Requirements, p_MemoryProperties);
@@ -92,45 +135,226 @@ void VulkanExternalMemoryExtension::allocateExport(ResourceID p_Resource, Vulkan
 
     const VmaAllocation l_Alloc = l_Device.getMemoryAllocator().allocateMemArray(p_Resource, p_MemoryProperties);
     l_MemArray->setBoundMemory(l_Alloc);
+    l_MemArray->m_Movable = false;
 }
 
-HANDLE VulkanExternalMemoryExtension::getResourceOpaqueHandle(const ResourceID p_Resource) const
+ExternalHandle VulkanExternalMemoryExtension::getResourceOpaqueHandle(const ResourceID p_Resource) const
 {
     const VulkanDevice& l_Device = VulkanContext::getDevice(getDeviceID());
     const VulkanMemArray* l_Resource = dynamic_cast<VulkanMemArray*>(l_Device.getSubresource(p_Resource));
-    if (!l_Resource)
+    if (!l_Resource || !l_Resource->isMemoryBound())
     {
-        LOG_ERR("Cannot get external memory handle for resource ID ", p_Resource, ", unsupported type");
-        return nullptr;
+        LOG_ERR("Cannot get external memory handle for resource ID ", p_Resource, ", unsupported type or no memory bound");
+        return INVALID_EXTERNAL_HANDLE;
     }
 
+    const VkDeviceMemory l_Memory = l_Device.getMemoryAllocator().getAllocationInfo(l_Resource->getAllocation()).deviceMemory;
+    ExternalHandle l_ExternalHandle = INVALID_EXTERNAL_HANDLE;
 #ifdef _WIN32
     VkMemoryGetWin32HandleInfoKHR l_GetWin32 = {};
     l_GetWin32.sType = VK_STRUCTURE_TYPE_MEMORY_GET_WIN32_HANDLE_INFO_KHR;
-    l_GetWin32.memory = l_Device.getMemoryAllocator().getAllocationInfo(l_Resource->getAllocation()).deviceMemory;
-    l_GetWin32.handleType = VK_EXTERNAL_MEMORY_HANDLE_TYPE_OPAQUE_WIN32_BIT;
-
-    HANDLE l_ExternalHandle;
+    l_GetWin32.memory = l_Memory;
+    l_GetWin32.handleType = MEMORY_HANDLE_TYPE;
     VULKAN_TRY(l_Device.getTable().vkGetMemoryWin32HandleKHR(*l_Device, &l_GetWin32, &l_ExternalHandle));
-    
+#else
+    VkMemoryGetFdInfoKHR l_GetFd = {};
+    l_GetFd.sType = VK_STRUCTURE_TYPE_MEMORY_GET_FD_INFO_KHR;
+    l_GetFd.memory = l_Memory;
+    l_GetFd.handleType = MEMORY_HANDLE_TYPE;
+    VULKAN_TRY(l_Device.getTable().vkGetMemoryFdKHR(*l_Device, &l_GetFd, &l_ExternalHandle));
+#endif
     return l_ExternalHandle;
+}
+
+VulkanExternalMemoryExtension::ExternalMemoryInfo VulkanExternalMemoryExtension::exportMemory(const ResourceID p_Resource) const
+{
+    const VulkanDevice& l_Device = VulkanContext::getDevice(getDeviceID());
+    const ExternalHandle l_Handle = getResourceOpaqueHandle(p_Resource);
+    if (l_Handle == INVALID_EXTERNAL_HANDLE)
+    {
+        return {INVALID_EXTERNAL_HANDLE, 0, UINT32_MAX};
+    }
+
+    // Export allocations are dedicated, so the allocation covers the whole VkDeviceMemory
+    const VulkanMemArray* l_Resource = dynamic_cast<VulkanMemArray*>(l_Device.getSubresource(p_Resource));
+    const VmaAllocationInfo l_Info = l_Device.getMemoryAllocator().getAllocationInfo(l_Resource->getAllocation());
+    return {l_Handle, l_Info.size, l_Info.memoryType};
+}
+
+ResourceID VulkanExternalMemoryExtension::importImage(const VulkanImage::Config& p_Config, const ExternalMemoryInfo& p_Memory)
+{
+    VulkanDevice& l_Device = VulkanContext::getDevice(getDeviceID());
+    const ResourceID l_ID = createExternalImage(p_Config);
+    const VkImage l_Image = *l_Device.getImage(l_ID);
+
+    const VkDeviceMemory l_Memory = importMemory(p_Memory, l_Image, VK_NULL_HANDLE);
+    if (l_Memory == VK_NULL_HANDLE)
+    {
+        l_Device.freeImage(l_ID);
+        return UINT32_MAX;
+    }
+    // The driver already owns the handle, so a failed bind has to release the memory and the image here
+    if (const VkResult l_Result = l_Device.getTable().vkBindImageMemory(*l_Device, l_Image, l_Memory, 0); l_Result != VK_SUCCESS)
+    {
+        l_Device.getTable().vkFreeMemory(*l_Device, l_Memory, nullptr);
+        l_Device.freeImage(l_ID);
+        throw std::runtime_error("Failed to bind imported memory to image (ID:" + std::to_string(l_ID) + "): " + string_VkResult(l_Result));
+    }
+
+    m_ImportedMemory[l_ID] = l_Memory;
+    LOG_DEBUG("Imported image (ID:", l_ID, ") with ", VulkanMemoryAllocator::compactBytes(p_Memory.size), " of external memory");
+    return l_ID;
+}
+
+ResourceID VulkanExternalMemoryExtension::importBuffer(const VulkanBuffer::Config& p_Config, const ExternalMemoryInfo& p_Memory)
+{
+    VulkanDevice& l_Device = VulkanContext::getDevice(getDeviceID());
+    const ResourceID l_ID = createExternalBuffer(p_Config);
+    const VkBuffer l_Buffer = *l_Device.getBuffer(l_ID);
+
+    const VkDeviceMemory l_Memory = importMemory(p_Memory, VK_NULL_HANDLE, l_Buffer);
+    if (l_Memory == VK_NULL_HANDLE)
+    {
+        l_Device.freeBuffer(l_ID);
+        return UINT32_MAX;
+    }
+    // The driver already owns the handle, so a failed bind has to release the memory and the buffer here
+    if (const VkResult l_Result = l_Device.getTable().vkBindBufferMemory(*l_Device, l_Buffer, l_Memory, 0); l_Result != VK_SUCCESS)
+    {
+        l_Device.getTable().vkFreeMemory(*l_Device, l_Memory, nullptr);
+        l_Device.freeBuffer(l_ID);
+        throw std::runtime_error("Failed to bind imported memory to buffer (ID:" + std::to_string(l_ID) + "): " + string_VkResult(l_Result));
+    }
+
+    m_ImportedMemory[l_ID] = l_Memory;
+    LOG_DEBUG("Imported buffer (ID:", l_ID, ") with ", VulkanMemoryAllocator::compactBytes(p_Memory.size), " of external memory");
+    return l_ID;
+}
+
+void VulkanExternalMemoryExtension::freeImported(const ResourceID p_Resource)
+{
+    const auto l_It = m_ImportedMemory.find(p_Resource);
+    if (l_It == m_ImportedMemory.end())
+    {
+        LOG_WARN("Tried to free resource (ID:", p_Resource, ") that was not imported from external memory");
+        return;
+    }
+
+    VulkanDevice& l_Device = VulkanContext::getDevice(getDeviceID());
+    l_Device.freeSubresource(p_Resource);
+    l_Device.getTable().vkFreeMemory(*l_Device, l_It->second, nullptr);
+    m_ImportedMemory.erase(l_It);
+}
+
+ResourceID VulkanExternalMemoryExtension::createExportableSemaphore() const
+{
+    VulkanDevice& l_Device = VulkanContext::getDevice(getDeviceID());
+
+    VkExportSemaphoreCreateInfo l_ExportInfo{};
+    l_ExportInfo.sType = VK_STRUCTURE_TYPE_EXPORT_SEMAPHORE_CREATE_INFO;
+    l_ExportInfo.handleTypes = SEMAPHORE_HANDLE_TYPE;
+
+    VkSemaphoreCreateInfo l_SemaphoreInfo{};
+    l_SemaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    l_SemaphoreInfo.pNext = &l_ExportInfo;
+
+    VkSemaphore l_Semaphore;
+    VULKAN_TRY(l_Device.getTable().vkCreateSemaphore(*l_Device, &l_SemaphoreInfo, nullptr, &l_Semaphore));
+
+    VulkanSemaphore* l_NewRes = ARENA_ALLOC(VulkanSemaphore){getDeviceID(), l_Semaphore};
+    LOG_DEBUG("Created exportable semaphore (ID:", l_NewRes->getID(), ")");
+    l_Device.insertSubresource(l_NewRes);
+    return l_NewRes->getID();
+}
+
+ExternalHandle VulkanExternalMemoryExtension::exportSemaphore(const ResourceID p_Semaphore) const
+{
+    const VulkanDevice& l_Device = VulkanContext::getDevice(getDeviceID());
+
+    ExternalHandle l_ExternalHandle = INVALID_EXTERNAL_HANDLE;
+#ifdef _WIN32
+    VkSemaphoreGetWin32HandleInfoKHR l_GetInfo{};
+    l_GetInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_GET_WIN32_HANDLE_INFO_KHR;
+    l_GetInfo.semaphore = *l_Device.getSemaphore(p_Semaphore);
+    l_GetInfo.handleType = SEMAPHORE_HANDLE_TYPE;
+    VULKAN_TRY(l_Device.getTable().vkGetSemaphoreWin32HandleKHR(*l_Device, &l_GetInfo, &l_ExternalHandle));
+#else
+    VkSemaphoreGetFdInfoKHR l_GetInfo{};
+    l_GetInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_GET_FD_INFO_KHR;
+    l_GetInfo.semaphore = *l_Device.getSemaphore(p_Semaphore);
+    l_GetInfo.handleType = SEMAPHORE_HANDLE_TYPE;
+    VULKAN_TRY(l_Device.getTable().vkGetSemaphoreFdKHR(*l_Device, &l_GetInfo, &l_ExternalHandle));
+#endif
+    return l_ExternalHandle;
+}
+
+void VulkanExternalMemoryExtension::importSemaphore(const ResourceID p_Semaphore, const ExternalHandle p_Handle, const bool p_Temporary) const
+{
+    const VulkanDevice& l_Device = VulkanContext::getDevice(getDeviceID());
+
+#ifdef _WIN32
+    VkImportSemaphoreWin32HandleInfoKHR l_ImportInfo{};
+    l_ImportInfo.sType = VK_STRUCTURE_TYPE_IMPORT_SEMAPHORE_WIN32_HANDLE_INFO_KHR;
+    l_ImportInfo.semaphore = *l_Device.getSemaphore(p_Semaphore);
+    l_ImportInfo.flags = p_Temporary ? VK_SEMAPHORE_IMPORT_TEMPORARY_BIT : 0;
+    l_ImportInfo.handleType = SEMAPHORE_HANDLE_TYPE;
+    l_ImportInfo.handle = p_Handle;
+    VULKAN_TRY(l_Device.getTable().vkImportSemaphoreWin32HandleKHR(*l_Device, &l_ImportInfo));
 #else
-    VkMemoryGetFdInfoKHR getFd = {};
-    getFd.sType = VK_STRUCTURE_TYPE_MEMORY_GET_FD_INFO_KHR;
-    l_GetWin32.memory = l_Device.getMemoryAllocator().getAllocationInfo(l_Resource->getAllocation()).deviceMemory;
-    getFd.handleType = VK_EXTERNAL_MEMORY_HANDLE_TYPE_OPAQUE_FD_BIT;
-
-    HANDLE externalFd = -1;
-    VULKAN_TRY(l_Device.getTable().vkGetMemoryFdKHR(*l_Device, &getFd, &externalFd));
-    return externalFd;
+    VkImportSemaphoreFdInfoKHR l_ImportInfo{};
+    l_ImportInfo.sType = VK_STRUCTURE_TYPE_IMPORT_SEMAPHORE_FD_INFO_KHR;
+    l_ImportInfo.semaphore = *l_Device.getSemaphore(p_Semaphore);
+    l_ImportInfo.flags = p_Temporary ? VK_SEMAPHORE_IMPORT_TEMPORARY_BIT : 0;
+    l_ImportInfo.handleType = SEMAPHORE_HANDLE_TYPE;
+    l_ImportInfo.fd = p_Handle;
+    VULKAN_TRY(l_Device.getTable().vkImportSemaphoreFdKHR(*l_Device, &l_ImportInfo));
 #endif
+    LOG_DEBUG("Imported external payload into semaphore (ID:", p_Semaphore, ")", p_Temporary ? " temporarily" : "");
 }
 
 std::vector<std::string> VulkanExternalMemoryExtension::getExtraExtensionNames()
 {
 #ifdef _WIN32
-    return { "VK_KHR_external_memory_win32" };
+    return { "VK_KHR_external_memory_win32", VK_KHR_EXTERNAL_SEMAPHORE_EXTENSION_NAME, "VK_KHR_external_semaphore_win32" };
 #else
-    return { VK_KHR_EXTERNAL_MEMORY_FD_EXTENSION_NAME };
+    return { VK_KHR_EXTERNAL_MEMORY_FD_EXTENSION_NAME, VK_KHR_EXTERNAL_SEMAPHORE_EXTENSION_NAME, VK_KHR_EXTERNAL_SEMAPHORE_FD_EXTENSION_NAME };
 #endif
 }
+
+VkDeviceMemory VulkanExternalMemoryExtension::importMemory(const ExternalMemoryInfo& p_Memory, const VkImage p_DedicatedImage, const VkBuffer p_DedicatedBuffer) const
+{
+    const VulkanDevice& l_Device = VulkanContext::getDevice(getDeviceID());
+
+    // The exporting side always uses dedicated allocations, and the import has to match
+    VkMemoryDedicatedAllocateInfo l_DedicatedInfo{};
+    l_DedicatedInfo.sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_ALLOCATE_INFO;
+    l_DedicatedInfo.image = p_DedicatedImage;
+    l_DedicatedInfo.buffer = p_DedicatedBuffer;
+
+#ifdef _WIN32
+    VkImportMemoryWin32HandleInfoKHR l_ImportInfo{};
+    l_ImportInfo.sType = VK_STRUCTURE_TYPE_IMPORT_MEMORY_WIN32_HANDLE_INFO_KHR;
+    l_ImportInfo.handle = p_Memory.handle;
+#else
+    VkImportMemoryFdInfoKHR l_ImportInfo{};
+    l_ImportInfo.sType = VK_STRUCTURE_TYPE_IMPORT_MEMORY_FD_INFO_KHR;
+    l_ImportInfo.fd = p_Memory.handle;
+#endif
+    l_ImportInfo.pNext = &l_DedicatedInfo;
+    l_ImportInfo.handleType = MEMORY_HANDLE_TYPE;
+
+    VkMemoryAllocateInfo l_AllocInfo{};
+    l_AllocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    l_AllocInfo.pNext = &l_ImportInfo;
+    l_AllocInfo.allocationSize = p_Memory.size;
+    l_AllocInfo.memoryTypeIndex = p_Memory.memoryTypeIndex;
+
+    VkDeviceMemory l_Memory = VK_NULL_HANDLE;
+    const VkResult l_Result = l_Device.getTable().vkAllocateMemory(*l_Device, &l_AllocInfo, nullptr, &l_Memory);
+    if (l_Result != VK_SUCCESS)
+    {
+        LOG_ERR("Failed to import external memory of ", VulkanMemoryAllocator::compactBytes(p_Memory.size), " at memory type ", p_Memory.memoryTypeIndex, ": ", string_VkResult(l_Result));
+        return VK_NULL_HANDLE;
+    }
+    return l_Memory;
+}
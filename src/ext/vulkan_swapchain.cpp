@@ -243,7 +243,7 @@ VulkanSwapchain::VulkanSwapchain(ResourceID p_Device, const VkSwapchainKHR p_Han
     m_Images.reserve(l_ImageCount);
     for (const VkImage l_Image : l_Images)
     {
-        m_Images.push_back({p_Device, l_Image, VkExtent3D{p_Extent.width, p_Extent.height, 1}, VK_IMAGE_TYPE_2D, VK_IMAGE_LAYOUT_UNDEFINED});
+        m_Images.push_back({p_Device, l_Image, VkExtent3D{p_Extent.width, p_Extent.height, 1}, VK_IMAGE_TYPE_2D, VK_IMAGE_LAYOUT_UNDEFINED, p_Format.format});
     }
 
     m_ImageViews.reserve(m_Images.size());
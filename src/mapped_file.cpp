@@ -0,0 +1,141 @@
+#include "utils/mapped_file.hpp"
+
+#include <string>
+#include <utility>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "utils/logger.hpp"
+
+MappedFile::MappedFile(const std::string_view p_Filename)
+{
+    open(p_Filename);
+}
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+MappedFile::MappedFile(MappedFile&& p_Other) noexcept
+{
+    *this = std::move(p_Other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& p_Other) noexcept
+{
+    if (this != &p_Other)
+    {
+        close();
+        m_Data = std::exchange(p_Other.m_Data, nullptr);
+        m_Size = std::exchange(p_Other.m_Size, 0);
+#ifdef _WIN32
+        m_FileHandle = std::exchange(p_Other.m_FileHandle, nullptr);
+        m_MappingHandle = std::exchange(p_Other.m_MappingHandle, nullptr);
+#endif
+    }
+    return *this;
+}
+
+bool MappedFile::open(const std::string_view p_Filename)
+{
+    close();
+
+    const std::string l_Filename{p_Filename};
+#ifdef _WIN32
+    const HANDLE l_File = CreateFileA(l_Filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (l_File == INVALID_HANDLE_VALUE)
+    {
+        LOG_ERR("Failed to open file for mapping: ", p_Filename);
+        return false;
+    }
+
+    LARGE_INTEGER l_Size;
+    if (!GetFileSizeEx(l_File, &l_Size) || l_Size.QuadPart == 0)
+    {
+        LOG_ERR("Failed to get size of mapped file or file is empty: ", p_Filename);
+        CloseHandle(l_File);
+        return false;
+    }
+
+    const HANDLE l_Mapping = CreateFileMappingA(l_File, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (l_Mapping == nullptr)
+    {
+        LOG_ERR("Failed to create file mapping: ", p_Filename);
+        CloseHandle(l_File);
+        return false;
+    }
+
+    const void* l_Data = MapViewOfFile(l_Mapping, FILE_MAP_READ, 0, 0, 0);
+    if (l_Data == nullptr)
+    {
+        LOG_ERR("Failed to map view of file: ", p_Filename);
+        CloseHandle(l_Mapping);
+        CloseHandle(l_File);
+        return false;
+    }
+
+    m_FileHandle = l_File;
+    m_MappingHandle = l_Mapping;
+    m_Data = static_cast<const uint8_t*>(l_Data);
+    m_Size = static_cast<size_t>(l_Size.QuadPart);
+#else
+    const int l_File = ::open(l_Filename.c_str(), O_RDONLY);
+    if (l_File < 0)
+    {
+        LOG_ERR("Failed to open file for mapping: ", p_Filename);
+        return false;
+    }
+
+    struct stat l_Stat{};
+    if (fstat(l_File, &l_Stat) != 0 || l_Stat.st_size == 0)
+    {
+        LOG_ERR("Failed to get size of mapped file or file is empty: ", p_Filename);
+        ::close(l_File);
+        return false;
+    }
+
+    void* l_Data = mmap(nullptr, static_cast<size_t>(l_Stat.st_size), PROT_READ, MAP_PRIVATE, l_File, 0);
+    ::close(l_File);
+    if (l_Data == MAP_FAILED)
+    {
+        LOG_ERR("Failed to map file: ", p_Filename);
+        return false;
+    }
+    madvise(l_Data, static_cast<size_t>(l_Stat.st_size), MADV_SEQUENTIAL);
+
+    m_Data = static_cast<const uint8_t*>(l_Data);
+    m_Size = static_cast<size_t>(l_Stat.st_size);
+#endif
+
+    LOG_DEBUG("Mapped file ", p_Filename, " (", m_Size, " bytes)");
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (m_Data == nullptr)
+    {
+        return;
+    }
+
+#ifdef _WIN32
+    UnmapViewOfFile(m_Data);
+    CloseHandle(m_MappingHandle);
+    CloseHandle(m_FileHandle);
+    m_MappingHandle = nullptr;
+    m_FileHandle = nullptr;
+#else
+    munmap(const_cast<uint8_t*>(m_Data), m_Size);
+#endif
+
+    m_Data = nullptr;
+    m_Size = 0;
+}
@@ -0,0 +1,227 @@
+#include "vulkan_aliasing.hpp"
+
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+#include <vulkan/vk_enum_string_helper.h>
+
+#include "vulkan_context.hpp"
+#include "vulkan_device.hpp"
+#include "utils/allocators.hpp"
+#include "utils/logger.hpp"
+#include "utils/vulkan_base.hpp"
+
+VulkanImageAliasingAllocator::VulkanImageAliasingAllocator(const ResourceID p_Device)
+    : m_Device(p_Device)
+{
+}
+
+VulkanImageAliasingAllocator::~VulkanImageAliasingAllocator()
+{
+    // Members and statics can outlive the device, whose images and allocator are already gone by then
+    if (!VulkanContext::hasDevice(m_Device))
+    {
+        if (!m_Blocks.empty())
+        {
+            LOG_WARN("Aliasing allocator destroyed after its device (ID:", m_Device, "), call reset() before freeing the device");
+        }
+        return;
+    }
+    reset();
+}
+
+uint32_t VulkanImageAliasingAllocator::declareImage(const VulkanImage::Config& p_Config, const uint32_t p_FirstPass, const uint32_t p_LastPass)
+{
+    if (m_Built)
+    {
+        throw std::runtime_error("Cannot declare images on an aliasing allocator that has already been built");
+    }
+    if (p_FirstPass > p_LastPass)
+    {
+        throw std::runtime_error("Aliased image first pass (" + std::to_string(p_FirstPass) + ") is after its last pass (" + std::to_string(p_LastPass) + ")");
+    }
+
+    m_Declarations.push_back({p_Config, p_FirstPass, p_LastPass});
+    return static_cast<uint32_t>(m_Declarations.size() - 1);
+}
+
+void VulkanImageAliasingAllocator::build()
+{
+    if (m_Built)
+    {
+        return;
+    }
+
+    VulkanDevice& l_Device = VulkanContext::getDevice(m_Device);
+    const VulkanMemoryAllocator& l_Allocator = l_Device.getMemoryAllocator();
+
+    for (Declaration& l_Declaration : m_Declarations)
+    {
+        l_Declaration.image = l_Device.createImage(l_Declaration.config);
+        l_Declaration.requirements = l_Device.getImage(l_Declaration.image).getMemoryRequirements();
+        l_Declaration.memoryType = selectMemoryType(l_Declaration);
+        if (l_Declaration.memoryType == UINT32_MAX)
+        {
+            throw std::runtime_error("No suitable memory type for aliased image (ID:" + std::to_string(l_Declaration.image) + ")");
+        }
+        m_RequestedBytes += l_Declaration.requirements.size;
+    }
+
+    // Largest first, so every block is sized by the first image placed in it and smaller images fill the gaps left by lifetimes
+    std::vector<uint32_t> l_Order(m_Declarations.size());
+    std::iota(l_Order.begin(), l_Order.end(), 0);
+    std::ranges::sort(l_Order, [this](const uint32_t p_A, const uint32_t p_B)
+    {
+        const Declaration& l_A = m_Declarations[p_A];
+        const Declaration& l_B = m_Declarations[p_B];
+        return l_A.requirements.size != l_B.requirements.size ? l_A.requirements.size > l_B.requirements.size : l_A.firstPass < l_B.firstPass;
+    });
+
+    for (const uint32_t l_Index : l_Order)
+    {
+        Declaration& l_Declaration = m_Declarations[l_Index];
+        const bool l_Placed = std::ranges::any_of(m_Blocks, [&](Block& p_Block)
+        {
+            return p_Block.memoryType == l_Declaration.memoryType && p_Block.tiling == l_Declaration.config.tiling && tryPlace(p_Block, l_Index);
+        });
+
+        if (!l_Placed)
+        {
+            m_Blocks.push_back({l_Declaration.memoryType, l_Declaration.config.tiling, l_Declaration.requirements.size, l_Declaration.requirements.alignment, {l_Index}});
+            l_Declaration.block = static_cast<uint32_t>(m_Blocks.size() - 1);
+            l_Declaration.offset = 0;
+        }
+    }
+
+    for (Block& l_Block : m_Blocks)
+    {
+        const VkMemoryRequirements l_Requirements{l_Block.size, l_Block.alignment, 1u << l_Block.memoryType};
+        VmaAllocationCreateInfo l_Aci{};
+        l_Aci.flags = VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT | VMA_ALLOCATION_CREATE_CAN_ALIAS_BIT;
+        l_Aci.usage = VMA_MEMORY_USAGE_UNKNOWN;
+        l_Aci.memoryTypeBits = l_Requirements.memoryTypeBits;
+        VULKAN_TRY(vmaAllocateMemory(*l_Allocator, &l_Requirements, &l_Aci, &l_Block.allocation, nullptr));
+        m_AllocatedBytes += l_Block.size;
+
+        // Equivalent to vmaCreateAliasingImage2, but reuses the image that was created to query its requirements
+        for (const uint32_t l_Index : l_Block.declarations)
+        {
+            const Declaration& l_Declaration = m_Declarations[l_Index];
+            VULKAN_TRY(vmaBindImageMemory2(*l_Allocator, l_Block.allocation, l_Declaration.offset, *l_Device.getImage(l_Declaration.image), nullptr));
+        }
+    }
+
+    m_Built = true;
+    LOG_DEBUG("Built aliasing allocator with ", m_Declarations.size(), " image(s) in ", m_Blocks.size(), " block(s): ", VulkanMemoryAllocator::compactBytes(m_AllocatedBytes), " allocated for ", VulkanMemoryAllocator::compactBytes(m_RequestedBytes), " requested");
+}
+
+void VulkanImageAliasingAllocator::reset()
+{
+    VulkanDevice& l_Device = VulkanContext::getDevice(m_Device);
+
+    // Images must go before the memory they alias
+    for (const Declaration& l_Declaration : m_Declarations)
+    {
+        if (l_Declaration.image != UINT32_MAX)
+        {
+            l_Device.freeImage(l_Declaration.image);
+        }
+    }
+    for (const Block& l_Block : m_Blocks)
+    {
+        if (l_Block.allocation != VK_NULL_HANDLE)
+        {
+            vmaFreeMemory(*l_Device.getMemoryAllocator(), l_Block.allocation);
+        }
+    }
+
+    m_Declarations.clear();
+    m_Blocks.clear();
+    m_Built = false;
+    m_RequestedBytes = 0;
+    m_AllocatedBytes = 0;
+}
+
+ResourceID VulkanImageAliasingAllocator::getImage(const uint32_t p_Declaration) const
+{
+    if (!m_Built)
+    {
+        throw std::runtime_error("Aliased images are only available after build()");
+    }
+    return m_Declarations.at(p_Declaration).image;
+}
+
+bool VulkanImageAliasingAllocator::isLazilyAllocated(const uint32_t p_Declaration) const
+{
+    const uint32_t l_Type = m_Declarations.at(p_Declaration).memoryType;
+    return l_Type != UINT32_MAX && VulkanContext::getDevice(m_Device).getMemoryAllocator().getMemoryStructure().doesMemoryContainProperties(l_Type, VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT);
+}
+
+uint32_t VulkanImageAliasingAllocator::selectMemoryType(const Declaration& p_Declaration) const
+{
+    const MemoryStructure& l_Memory = VulkanContext::getDevice(m_Device).getMemoryAllocator().getMemoryStructure();
+    const uint32_t l_TypeBits = p_Declaration.requirements.memoryTypeBits;
+
+    // Tile-based GPUs can keep transient attachments in on-chip memory and never back them with physical pages
+    if (p_Declaration.config.usage & VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT)
+    {
+        const std::vector<uint32_t> l_Lazy = l_Memory.getMemoryTypes(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT, l_TypeBits);
+        if (!l_Lazy.empty())
+        {
+            return l_Lazy.front();
+        }
+    }
+
+    for (const uint32_t l_Type : l_Memory.getMemoryTypes(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, l_TypeBits))
+    {
+        if (!l_Memory.doesMemoryContainProperties(l_Type, VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT))
+        {
+            return l_Type;
+        }
+    }
+    return UINT32_MAX;
+}
+
+bool VulkanImageAliasingAllocator::tryPlace(Block& p_Block, const uint32_t p_Declaration)
+{
+    Declaration& l_Declaration = m_Declarations[p_Declaration];
+    const VkDeviceSize l_Size = l_Declaration.requirements.size;
+    const VkDeviceSize l_Alignment = l_Declaration.requirements.alignment;
+    if (l_Size > p_Block.size)
+    {
+        return false;
+    }
+
+    // Only images alive at the same time as this one constrain where it can go
+    TRANS_VECTOR(l_Live, const Declaration*);
+    for (const uint32_t l_Index : p_Block.declarations)
+    {
+        const Declaration& l_Other = m_Declarations[l_Index];
+        if (l_Other.firstPass <= l_Declaration.lastPass && l_Declaration.firstPass <= l_Other.lastPass)
+        {
+            l_Live.push_back(&l_Other);
+        }
+    }
+    std::ranges::sort(l_Live, [](const Declaration* p_A, const Declaration* p_B) { return p_A->offset < p_B->offset; });
+
+    VkDeviceSize l_Offset = 0;
+    for (const Declaration* l_Other : l_Live)
+    {
+        if (alignUp(l_Offset, l_Alignment) + l_Size <= l_Other->offset)
+        {
+            break;
+        }
+        l_Offset = std::max(l_Offset, l_Other->offset + l_Other->requirements.size);
+    }
+    l_Offset = alignUp(l_Offset, l_Alignment);
+    if (l_Offset + l_Size > p_Block.size)
+    {
+        return false;
+    }
+
+    l_Declaration.block = static_cast<uint32_t>(&p_Block - m_Blocks.data());
+    l_Declaration.offset = l_Offset;
+    p_Block.alignment = std::max(p_Block.alignment, l_Alignment);
+    p_Block.declarations.push_back(p_Declaration);
+    return true;
+}
@@ -63,11 +63,14 @@ VkDeviceAddress VulkanBuffer::getDeviceAddress() const
 
 void* VulkanMemArray::map(const VkDeviceSize p_Size, const VkDeviceSize p_Offset)
 {
-    const VulkanDevice& l_Device = VulkanContext::getDevice(getDeviceID());
+    if (!isMemoryMapped())
+    {
+        const VulkanDevice& l_Device = VulkanContext::getDevice(getDeviceID());
 
-    void* l_Data = l_Device.getMemoryAllocator().map(m_Allocation);
-    LOG_DEBUG("Mapped buffer (ID:", m_ID, ") memory with size ", VulkanMemoryAllocator::compactBytes(p_Size), " and offset ", p_Offset);
-    return l_Data;
+        m_MappedData = l_Device.getMemoryAllocator().map(m_Allocation);
+        LOG_DEBUG("Mapped buffer (ID:", m_ID, ") memory with size ", VulkanMemoryAllocator::compactBytes(p_Size), " and offset ", p_Offset);
+    }
+    return static_cast<uint8_t*>(m_MappedData) + p_Offset;
 }
 
 VkMemoryRequirements VulkanBuffer::getMemoryRequirements() const
@@ -97,6 +100,11 @@ uint32_t VulkanBuffer::getQueue() const
     return m_QueueFamilyIndex;
 }
 
+VkBufferUsageFlags VulkanBuffer::getUsage() const
+{
+    return m_Usage;
+}
+
 void VulkanBuffer::setQueue(const uint32_t p_QueueFamilyIndex)
 {
     m_QueueFamilyIndex = p_QueueFamilyIndex;
@@ -122,12 +130,16 @@ void VulkanMemArray::unmap()
     m_MappedData = nullptr;
 }
 
-VulkanBuffer::VulkanBuffer(const uint32_t p_Device, const VkBuffer p_VkHandle, const VkDeviceSize p_Size)
-    : VulkanMemArray(p_Device), m_VkHandle(p_VkHandle), m_Size(p_Size) {}
+VulkanBuffer::VulkanBuffer(const uint32_t p_Device, const VkBuffer p_VkHandle, const VkDeviceSize p_Size, const VkBufferUsageFlags p_Usage)
+    : VulkanMemArray(p_Device), m_VkHandle(p_VkHandle), m_Size(p_Size), m_Usage(p_Usage) {}
 
 void VulkanBuffer::setBoundMemory(VmaAllocation p_Allocation)
 {
     m_Allocation = p_Allocation;
+    if (m_Allocation != VK_NULL_HANDLE)
+    {
+        vmaSetAllocationUserData(*VulkanContext::getDevice(getDeviceID()).getMemoryAllocator(), m_Allocation, reinterpret_cast<void*>(static_cast<uintptr_t>(m_ID)));
+    }
 }
 
 void VulkanBuffer::free()
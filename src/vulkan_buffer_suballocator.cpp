@@ -0,0 +1,145 @@
+#include "vulkan_buffer_suballocator.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <vulkan/vk_enum_string_helper.h>
+
+#include "vulkan_context.hpp"
+#include "vulkan_device.hpp"
+#include "utils/logger.hpp"
+#include "utils/vulkan_base.hpp"
+
+VulkanBufferSuballocator::VulkanBufferSuballocator(const ResourceID p_Device, const VulkanBuffer::MemoryPreferences& p_MemoryPreferences, const VulkanBuffer::Config& p_Config, const Mode p_Mode)
+    : m_Device(p_Device), m_Mode(p_Mode)
+{
+    VulkanDevice& l_Device = VulkanContext::getDevice(m_Device);
+
+    m_Buffer = l_Device.createAndAllocateBuffer(p_MemoryPreferences, p_Config);
+    VulkanBuffer& l_Buffer = l_Device.getBuffer(m_Buffer);
+    m_Capacity = l_Buffer.getSize();
+    m_MinAlignment = computeMinAlignment(m_Device, p_Config.usage);
+
+    VmaVirtualBlockCreateInfo l_BlockInfo{};
+    l_BlockInfo.size = m_Capacity;
+    l_BlockInfo.flags = m_Mode == LINEAR ? VMA_VIRTUAL_BLOCK_CREATE_LINEAR_ALGORITHM_BIT : 0;
+    VULKAN_TRY(vmaCreateVirtualBlock(&l_BlockInfo, &m_Block));
+
+    if (l_Device.getMemoryAllocator().getMemoryStructure().doesMemoryContainProperties(l_Buffer.getBoundMemoryType(), VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT))
+    {
+        m_MappedData = static_cast<uint8_t*>(l_Buffer.map(m_Capacity, 0));
+    }
+
+    LOG_DEBUG("Created ", m_Mode == LINEAR ? "linear" : "TLSF", " buffer suballocator over buffer (ID:", m_Buffer, ") of ", VulkanMemoryAllocator::compactBytes(m_Capacity), " with minimum alignment ", m_MinAlignment);
+}
+
+VulkanBufferSuballocator::~VulkanBufferSuballocator()
+{
+    if (m_Block != VK_NULL_HANDLE)
+    {
+        if (getAllocationCount() > 0)
+        {
+            LOG_WARN("Destroying buffer suballocator (buffer ID:", m_Buffer, ") with ", getAllocationCount(), " live slice(s)");
+            vmaClearVirtualBlock(m_Block);
+        }
+        vmaDestroyVirtualBlock(m_Block);
+    }
+
+    if (m_Buffer != UINT32_MAX)
+    {
+        VulkanDevice& l_Device = VulkanContext::getDevice(m_Device);
+        if (m_MappedData != nullptr)
+        {
+            l_Device.getBuffer(m_Buffer).unmap();
+        }
+        l_Device.freeBuffer(m_Buffer);
+    }
+}
+
+VulkanBufferSlice VulkanBufferSuballocator::allocate(const VkDeviceSize p_Size, const VkDeviceSize p_Alignment)
+{
+    if (p_Alignment != 0 && (p_Alignment & (p_Alignment - 1)) != 0)
+    {
+        throw std::invalid_argument("Suballocation alignment must be a power of two, got " + std::to_string(p_Alignment));
+    }
+
+    VmaVirtualAllocationCreateInfo l_AllocInfo{};
+    l_AllocInfo.size = p_Size;
+    l_AllocInfo.alignment = std::max(p_Alignment, m_MinAlignment);
+
+    VulkanBufferSlice l_Slice{};
+    VkDeviceSize l_Offset = 0;
+    const VkResult l_Result = vmaVirtualAllocate(m_Block, &l_AllocInfo, &l_Slice.allocation, &l_Offset);
+    if (l_Result != VK_SUCCESS)
+    {
+        LOG_WARN("Buffer suballocator (buffer ID:", m_Buffer, ") could not fit ", VulkanMemoryAllocator::compactBytes(p_Size), " (", string_VkResult(l_Result), ")");
+        return {};
+    }
+
+    l_Slice.buffer = m_Buffer;
+    l_Slice.offset = l_Offset;
+    l_Slice.size = p_Size;
+    return l_Slice;
+}
+
+void VulkanBufferSuballocator::free(const VulkanBufferSlice& p_Slice)
+{
+    if (m_Mode == LINEAR)
+    {
+        throw std::runtime_error("Linear buffer suballocator (buffer ID:" + std::to_string(m_Buffer) + ") releases slices with reset(), not free()");
+    }
+    if (p_Slice.buffer != m_Buffer)
+    {
+        throw std::runtime_error("Tried to free slice of buffer (ID:" + std::to_string(p_Slice.buffer) + ") in suballocator of buffer (ID:" + std::to_string(m_Buffer) + ")");
+    }
+
+    vmaVirtualFree(m_Block, p_Slice.allocation);
+}
+
+void VulkanBufferSuballocator::reset()
+{
+    vmaClearVirtualBlock(m_Block);
+}
+
+void* VulkanBufferSuballocator::getMappedData(const VulkanBufferSlice& p_Slice) const
+{
+    if (m_MappedData == nullptr)
+    {
+        throw std::runtime_error("Buffer (ID:" + std::to_string(m_Buffer) + ") of suballocator is not host visible");
+    }
+    return m_MappedData + p_Slice.offset;
+}
+
+VkDeviceSize VulkanBufferSuballocator::getUsedBytes() const
+{
+    VmaStatistics l_Stats;
+    vmaGetVirtualBlockStatistics(m_Block, &l_Stats);
+    return l_Stats.allocationBytes;
+}
+
+uint32_t VulkanBufferSuballocator::getAllocationCount() const
+{
+    VmaStatistics l_Stats;
+    vmaGetVirtualBlockStatistics(m_Block, &l_Stats);
+    return l_Stats.allocationCount;
+}
+
+VkDeviceSize VulkanBufferSuballocator::computeMinAlignment(const ResourceID p_Device, const VkBufferUsageFlags p_Usage)
+{
+    const VkPhysicalDeviceLimits l_Limits = VulkanContext::getDevice(p_Device).getGPU().getProperties().limits;
+
+    // Index buffer offsets must be a multiple of the index size, 4 covers every index type
+    VkDeviceSize l_Alignment = 4;
+    if (p_Usage & VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT)
+    {
+        l_Alignment = std::max(l_Alignment, l_Limits.minUniformBufferOffsetAlignment);
+    }
+    if (p_Usage & VK_BUFFER_USAGE_STORAGE_BUFFER_BIT)
+    {
+        l_Alignment = std::max(l_Alignment, l_Limits.minStorageBufferOffsetAlignment);
+    }
+    if (p_Usage & (VK_BUFFER_USAGE_UNIFORM_TEXEL_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_TEXEL_BUFFER_BIT))
+    {
+        l_Alignment = std::max(l_Alignment, l_Limits.minTexelBufferOffsetAlignment);
+    }
+    return l_Alignment;
+}
@@ -1,10 +1,12 @@
 #include "vulkan_command_buffer.hpp"
 
+#include <algorithm>
 #include <stdexcept>
 #include <vector>
 #include <vulkan/vk_enum_string_helper.h>
 
 #include "vulkan_buffer.hpp"
+#include "vulkan_buffer_suballocator.hpp"
 #include "vulkan_context.hpp"
 #include "vulkan_descriptors.hpp"
 #include "vulkan_device.hpp"
@@ -209,9 +211,24 @@ void VulkanMemoryBarrierBuilder::addImageMemoryBarrier(const VulkanImage& p_Imag
     l_Barrier.image = *p_Image;
     l_Barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
     l_Barrier.subresourceRange.baseMipLevel = 0;
-    l_Barrier.subresourceRange.levelCount = 1;
+    l_Barrier.subresourceRange.levelCount = p_Image.getMipLevels();
     l_Barrier.subresourceRange.baseArrayLayer = 0;
-    l_Barrier.subresourceRange.layerCount = 1;
+    l_Barrier.subresourceRange.layerCount = p_Image.getArrayLayers();
+    m_ImageMemoryBarriers.push_back(l_Barrier);
+}
+
+void VulkanMemoryBarrierBuilder::addImageSubresourceBarrier(const VulkanImage& p_Image, const VkImageSubresourceRange& p_Range, const VkImageLayout p_OldLayout, const VkImageLayout p_NewLayout, const VkAccessFlags p_SrcAccessMask, const VkAccessFlags p_DstAccessMask)
+{
+    VkImageMemoryBarrier l_Barrier{};
+    l_Barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    l_Barrier.srcAccessMask = p_SrcAccessMask;
+    l_Barrier.dstAccessMask = p_DstAccessMask;
+    l_Barrier.oldLayout = p_OldLayout;
+    l_Barrier.newLayout = p_NewLayout;
+    l_Barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    l_Barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    l_Barrier.image = *p_Image;
+    l_Barrier.subresourceRange = p_Range;
     m_ImageMemoryBarriers.push_back(l_Barrier);
 }
 
@@ -304,36 +321,48 @@ void VulkanCommandBuffer::cmdSimpleBlitImage(const VulkanImage& p_Source, const
         throw std::runtime_error("Command buffer (ID:" + std::to_string(m_ID) + ") is not recording");
     }
 
-    VkImageBlit l_Region{};
-    l_Region.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-    l_Region.srcSubresource.layerCount = 1;
-    l_Region.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-    l_Region.dstSubresource.layerCount = 1;
-    l_Region.srcOffsets[1] = {static_cast<int32_t>(p_Source.getSize().width), static_cast<int32_t>(p_Source.getSize().height), 1};
-    l_Region.dstOffsets[1] = {static_cast<int32_t>(p_Destination.getSize().width), static_cast<int32_t>(p_Destination.getSize().height), 1};
+    const uint32_t l_Levels = std::min(p_Source.getMipLevels(), p_Destination.getMipLevels());
+    const uint32_t l_Layers = std::min(p_Source.getArrayLayers(), p_Destination.getArrayLayers());
+
+    TRANS_VECTOR(l_Regions, VkImageBlit);
+    l_Regions.reserve(l_Levels);
+    for (uint32_t i = 0; i < l_Levels; i++)
+    {
+        const VkExtent3D l_SrcSize = p_Source.getMipSize(i);
+        const VkExtent3D l_DstSize = p_Destination.getMipSize(i);
+
+        VkImageBlit l_Region{};
+        l_Region.srcSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, i, 0, l_Layers};
+        l_Region.dstSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, i, 0, l_Layers};
+        l_Region.srcOffsets[1] = {static_cast<int32_t>(l_SrcSize.width), static_cast<int32_t>(l_SrcSize.height), static_cast<int32_t>(l_SrcSize.depth)};
+        l_Region.dstOffsets[1] = {static_cast<int32_t>(l_DstSize.width), static_cast<int32_t>(l_DstSize.height), static_cast<int32_t>(l_DstSize.depth)};
+        l_Regions.push_back(l_Region);
+    }
 
     //If source image layout is not transfer source, then we need to transition it
-    if (p_Source.getLayout() != VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL)
+    VkImageLayout l_SrcLayout = p_Source.getLayout();
+    if (l_SrcLayout != VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL)
     {
         VkImageMemoryBarrier l_Rarrier{};
         l_Rarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-        l_Rarrier.oldLayout = p_Source.getLayout();
+        l_Rarrier.oldLayout = l_SrcLayout;
         l_Rarrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
         l_Rarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
         l_Rarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
         l_Rarrier.image = *p_Source;
         l_Rarrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
         l_Rarrier.subresourceRange.baseMipLevel = 0;
-        l_Rarrier.subresourceRange.levelCount = 1;
+        l_Rarrier.subresourceRange.levelCount = p_Source.getMipLevels();
         l_Rarrier.subresourceRange.baseArrayLayer = 0;
-        l_Rarrier.subresourceRange.layerCount = 1;
+        l_Rarrier.subresourceRange.layerCount = p_Source.getArrayLayers();
         l_Rarrier.srcAccessMask = 0;
         l_Rarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
 
         l_Device.getTable().vkCmdPipelineBarrier(m_VkHandle, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 0, nullptr, 0, nullptr, 1, &l_Rarrier);
+        l_SrcLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
     }
 
-    l_Device.getTable().vkCmdBlitImage(m_VkHandle, *p_Source, p_Source.getLayout(), *p_Destination, p_Destination.getLayout(), 1, &l_Region, p_Filter);
+    l_Device.getTable().vkCmdBlitImage(m_VkHandle, *p_Source, l_SrcLayout, *p_Destination, p_Destination.getLayout(), static_cast<uint32_t>(l_Regions.size()), l_Regions.data(), p_Filter);
 }
 
 void VulkanCommandBuffer::ecmdDumpStagingBuffer(const ResourceID p_Buffer, const VkDeviceSize p_Size, const VkDeviceSize p_Offset) const
@@ -368,13 +397,7 @@ void VulkanCommandBuffer::ecmdDumpStagingBuffer(ResourceID p_Buffer, const std::
 
 void VulkanCommandBuffer::ecmdDumpStagingBufferToImage(const ResourceID p_Image, const VkExtent3D p_Size, const VkOffset3D p_Offset, const bool p_KeepLayout) const
 {
-    if (!m_IsRecording)
-    {
-        throw std::runtime_error("Command buffer (ID:" + std::to_string(m_ID) + ") is not recording");
-    }
-
-    VulkanDevice& l_Device = VulkanContext::getDevice(getDeviceID());
-
+    // The staging buffer holds a single layer of p_Size, array layers need the region overload
     VkBufferImageCopy l_Region;
     l_Region.bufferOffset = 0;
     l_Region.bufferRowLength = 0;
@@ -386,21 +409,44 @@ void VulkanCommandBuffer::ecmdDumpStagingBufferToImage(const ResourceID p_Image,
     l_Region.imageOffset = p_Offset;
     l_Region.imageExtent = p_Size;
 
-    const VkImageLayout l_Layout = l_Device.getImage(p_Image).getLayout();
+    const std::array<VkBufferImageCopy, 1> l_RegionArray = {l_Region};
+    ecmdDumpStagingBufferToImage(p_Image, l_RegionArray, p_KeepLayout);
+}
+
+void VulkanCommandBuffer::ecmdDumpStagingBufferToImage(const ResourceID p_Image, const std::span<const VkBufferImageCopy> p_Regions, const bool p_KeepLayout) const
+{
+    if (!m_IsRecording)
+    {
+        throw std::runtime_error("Command buffer (ID:" + std::to_string(m_ID) + ") is not recording");
+    }
+
+    VulkanDevice& l_Device = VulkanContext::getDevice(getDeviceID());
+    VulkanImage& l_Image = l_Device.getImage(p_Image);
+    const ResourceID l_StagingBufferID = l_Device.getStagingBufferData().stagingBuffer;
+    VulkanBuffer& l_StagingBuffer = l_Device.getBuffer(l_StagingBufferID);
+
+    if (l_StagingBuffer.isMemoryMapped())
+    {
+        LOG_DEBUG("Automatically unmapping staging buffer before dumping into image (ID: ", p_Image, ")");
+        l_StagingBuffer.unmap();
+    }
+
+    const VkImageLayout l_Layout = l_Image.getLayout();
 
     if (l_Layout != VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL)
     {
-        VulkanMemoryBarrierBuilder l_BarrierBuilder{getID(), VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0};
-        l_BarrierBuilder.addImageMemoryBarrier(p_Image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+        VulkanMemoryBarrierBuilder l_BarrierBuilder{getDeviceID(), VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0};
+        l_BarrierBuilder.addImageMemoryBarrier(l_Image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
         cmdPipelineBarrier(l_BarrierBuilder);
+        l_Image.setLayout(VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
     }
-    std::array<VkBufferImageCopy, 1> l_RegionArray = {l_Region};
-    cmdCopyBufferToImage(l_Device.getStagingBufferData().stagingBuffer, p_Image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, l_RegionArray);
-    if (l_Layout != VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL && p_KeepLayout)
+    cmdCopyBufferToImage(l_StagingBufferID, p_Image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, p_Regions);
+    if (l_Layout != VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL && l_Layout != VK_IMAGE_LAYOUT_UNDEFINED && p_KeepLayout)
     {
-        VulkanMemoryBarrierBuilder l_BarrierBuilder{getID(), VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0};
-        l_BarrierBuilder.addImageMemoryBarrier(p_Image, l_Layout);
+        VulkanMemoryBarrierBuilder l_BarrierBuilder{getDeviceID(), VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0};
+        l_BarrierBuilder.addImageMemoryBarrier(l_Image, l_Layout);
         cmdPipelineBarrier(l_BarrierBuilder);
+        l_Image.setLayout(l_Layout);
     }
 }
 
@@ -446,6 +492,128 @@ void VulkanCommandBuffer::ecmdDumpDataIntoImage(const ResourceID p_DestImage, co
     }
 }
 
+void VulkanCommandBuffer::ecmdDumpMipChainIntoImage(const ResourceID p_DestImage, const uint8_t* p_Data, const uint32_t p_BytesPerPixel, const bool p_KeepLayout) const
+{
+    VulkanDevice& l_Device = VulkanContext::getDevice(getDeviceID());
+    const VulkanImage& l_Image = l_Device.getImage(p_DestImage);
+
+    TRANS_VECTOR(l_Regions, VkBufferImageCopy);
+    TRANS_VECTOR(l_SourceOffsets, VkDeviceSize);
+    l_Regions.reserve(l_Image.getMipLevels());
+    l_SourceOffsets.reserve(l_Image.getMipLevels());
+
+    VkDeviceSize l_SourceOffset = 0;
+    VkDeviceSize l_StagingOffset = 0;
+    for (uint32_t i = 0; i < l_Image.getMipLevels(); i++)
+    {
+        const VkExtent3D l_Extent = l_Image.getMipSize(i);
+
+        VkBufferImageCopy l_Region{};
+        l_Region.bufferOffset = l_StagingOffset;
+        l_Region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        l_Region.imageSubresource.mipLevel = i;
+        l_Region.imageSubresource.baseArrayLayer = 0;
+        l_Region.imageSubresource.layerCount = l_Image.getArrayLayers();
+        l_Region.imageExtent = l_Extent;
+        l_Regions.push_back(l_Region);
+        l_SourceOffsets.push_back(l_SourceOffset);
+
+        const VkDeviceSize l_LevelSize = static_cast<VkDeviceSize>(l_Extent.width) * l_Extent.height * l_Extent.depth * p_BytesPerPixel * l_Image.getArrayLayers();
+        l_SourceOffset += l_LevelSize;
+        l_StagingOffset = alignUp(l_StagingOffset + l_LevelSize, 16);
+    }
+
+    const VulkanDevice::StagingBufferInfo l_StagingBufferInfo = l_Device.getStagingBufferData();
+    const VkDeviceSize l_InitStagingBufferSize = l_Device.getStagingBufferSize();
+    if (l_InitStagingBufferSize < l_StagingOffset)
+    {
+        LOG_DEBUG("Growing staging buffer to ", VulkanMemoryAllocator::compactBytes(l_StagingOffset), " to fit mip chain of image (ID: ", p_DestImage, ")");
+        l_Device.configureStagingBuffer(l_StagingOffset, l_StagingBufferInfo.queue);
+    }
+
+    uint8_t* l_StagePtr = static_cast<uint8_t*>(l_Device.mapStagingBuffer(l_StagingOffset, 0));
+    for (size_t i = 0; i < l_Regions.size(); i++)
+    {
+        const VkDeviceSize l_End = i + 1 < l_Regions.size() ? l_SourceOffsets[i + 1] : l_SourceOffset;
+        memcpy(l_StagePtr + l_Regions[i].bufferOffset, p_Data + l_SourceOffsets[i], l_End - l_SourceOffsets[i]);
+    }
+    ecmdDumpStagingBufferToImage(p_DestImage, l_Regions, p_KeepLayout);
+
+    if (l_InitStagingBufferSize != 0 && l_InitStagingBufferSize < l_StagingOffset)
+    {
+        l_Device.freeStagingBuffer();
+        l_Device.configureStagingBuffer(l_InitStagingBufferSize, l_StagingBufferInfo.queue);
+    }
+}
+
+void VulkanCommandBuffer::ecmdGenerateMipmaps(const ResourceID p_Image, const VkFilter p_Filter, const VkImageLayout p_FinalLayout) const
+{
+    if (!m_IsRecording)
+    {
+        throw std::runtime_error("Command buffer (ID:" + std::to_string(m_ID) + ") is not recording");
+    }
+
+    VulkanDevice& l_Device = VulkanContext::getDevice(getDeviceID());
+    VulkanImage& l_Image = l_Device.getImage(p_Image);
+    const uint32_t l_Levels = l_Image.getMipLevels();
+    const uint32_t l_Layers = l_Image.getArrayLayers();
+
+    if (l_Image.getFormat() != VK_FORMAT_UNDEFINED)
+    {
+        const VkFormatFeatureFlags l_Features = l_Device.getGPU().getFormatProperties(l_Image.getFormat()).optimalTilingFeatures;
+        VkFormatFeatureFlags l_Required = VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT;
+        if (p_Filter == VK_FILTER_LINEAR)
+        {
+            l_Required |= VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+        }
+        if ((l_Features & l_Required) != l_Required)
+        {
+            throw std::runtime_error("Image (ID:" + std::to_string(p_Image) + ") format " + string_VkFormat(l_Image.getFormat()) + " does not support blitting for mip generation");
+        }
+    }
+
+    if (l_Levels <= 1)
+    {
+        if (l_Image.getLayout() != p_FinalLayout)
+        {
+            VulkanMemoryBarrierBuilder l_BarrierBuilder{getDeviceID(), VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0};
+            l_BarrierBuilder.addImageMemoryBarrier(l_Image, p_FinalLayout);
+            cmdPipelineBarrier(l_BarrierBuilder);
+            l_Image.setLayout(p_FinalLayout);
+        }
+        return;
+    }
+
+    {
+        VulkanMemoryBarrierBuilder l_BarrierBuilder{getDeviceID(), VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0};
+        l_BarrierBuilder.addImageSubresourceBarrier(l_Image, {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, l_Layers}, l_Image.getLayout(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_ACCESS_MEMORY_WRITE_BIT, VK_ACCESS_TRANSFER_READ_BIT);
+        l_BarrierBuilder.addImageSubresourceBarrier(l_Image, {VK_IMAGE_ASPECT_COLOR_BIT, 1, l_Levels - 1, 0, l_Layers}, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_ACCESS_NONE, VK_ACCESS_TRANSFER_WRITE_BIT);
+        cmdPipelineBarrier(l_BarrierBuilder);
+    }
+
+    for (uint32_t i = 1; i < l_Levels; i++)
+    {
+        const VkExtent3D l_SrcSize = l_Image.getMipSize(i - 1);
+        const VkExtent3D l_DstSize = l_Image.getMipSize(i);
+
+        VkImageBlit l_Region{};
+        l_Region.srcSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, i - 1, 0, l_Layers};
+        l_Region.dstSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, i, 0, l_Layers};
+        l_Region.srcOffsets[1] = {static_cast<int32_t>(l_SrcSize.width), static_cast<int32_t>(l_SrcSize.height), static_cast<int32_t>(l_SrcSize.depth)};
+        l_Region.dstOffsets[1] = {static_cast<int32_t>(l_DstSize.width), static_cast<int32_t>(l_DstSize.height), static_cast<int32_t>(l_DstSize.depth)};
+        l_Device.getTable().vkCmdBlitImage(m_VkHandle, *l_Image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, *l_Image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &l_Region, p_Filter);
+
+        VulkanMemoryBarrierBuilder l_BarrierBuilder{getDeviceID(), VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0};
+        l_BarrierBuilder.addImageSubresourceBarrier(l_Image, {VK_IMAGE_ASPECT_COLOR_BIT, i, 1, 0, l_Layers}, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_TRANSFER_READ_BIT);
+        cmdPipelineBarrier(l_BarrierBuilder);
+    }
+
+    VulkanMemoryBarrierBuilder l_BarrierBuilder{getDeviceID(), VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0};
+    l_BarrierBuilder.addImageSubresourceBarrier(l_Image, {VK_IMAGE_ASPECT_COLOR_BIT, 0, l_Levels, 0, l_Layers}, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, p_FinalLayout, VK_ACCESS_TRANSFER_READ_BIT, VulkanMemoryBarrierBuilder::s_TransitionMapping[p_FinalLayout].dstAccessMask);
+    cmdPipelineBarrier(l_BarrierBuilder);
+    l_Image.setLayout(p_FinalLayout);
+}
+
 void VulkanCommandBuffer::cmdPushConstant(const ResourceID p_Layout, const VkShaderStageFlags p_StageFlags, const uint32_t p_Offset, const uint32_t p_Size, const void* p_Values) const
 {
     if (!m_IsRecording)
@@ -614,6 +782,27 @@ void VulkanCommandBuffer::cmdBindVertexBuffers(const std::span<const ResourceID>
     l_Device.getTable().vkCmdBindVertexBuffers(m_VkHandle, 0, static_cast<uint32_t>(l_VkBuffers.size()), l_VkBuffers.data(), p_Offsets.data());
 }
 
+void VulkanCommandBuffer::cmdBindVertexBuffers(const std::span<const VulkanBufferSlice> p_Slices, const uint32_t p_FirstBinding) const
+{
+    if (!m_IsRecording)
+    {
+        throw std::runtime_error("Tried to execute command CmdBindVertexBuffers, but command buffer (ID:" + std::to_string(m_ID) + ") is not recording");
+    }
+
+    VulkanDevice& l_Device = VulkanContext::getDevice(getDeviceID());
+
+    TRANS_VECTOR(l_VkBuffers, VkBuffer);
+    TRANS_VECTOR(l_Offsets, VkDeviceSize);
+    l_VkBuffers.reserve(p_Slices.size());
+    l_Offsets.reserve(p_Slices.size());
+    for (const VulkanBufferSlice& l_Slice : p_Slices)
+    {
+        l_VkBuffers.push_back(l_Device.getBuffer(l_Slice.buffer).m_VkHandle);
+        l_Offsets.push_back(l_Slice.offset);
+    }
+    l_Device.getTable().vkCmdBindVertexBuffers(m_VkHandle, p_FirstBinding, static_cast<uint32_t>(l_VkBuffers.size()), l_VkBuffers.data(), l_Offsets.data());
+}
+
 void VulkanCommandBuffer::cmdBindIndexBuffer(const ResourceID p_BufferID, const VkDeviceSize p_Offset, const VkIndexType p_IndexType) const
 {
     if (!m_IsRecording)
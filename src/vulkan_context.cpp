@@ -81,12 +81,18 @@ void VulkanContext::setupDebugMessenger()
     LOG_DEBUG("Created debug messenger for vulkan context");
 }
 
-void VulkanContext::init(const uint32_t p_VulkanApiVersion, const bool p_EnableValidationLayers, const bool p_AssertOnError, const std::span<const char*> p_Extensions)
+void VulkanContext::init(const uint32_t p_VulkanApiVersion, const bool p_EnableValidationLayers, const bool p_AssertOnError, const std::span<const char*> p_Extensions, const uint32_t p_PrewarmedShaderSessions, const VulkanShaderSessionPool::Mode p_ShaderSessionMode)
 {
+    if (p_PrewarmedShaderSessions > 0)
+    {
+        VulkanShaderSessionPool::prewarm(p_PrewarmedShaderSessions, p_ShaderSessionMode);
+    }
+
     VULKAN_TRY(volkInitialize());
 
     g_AssertOnError = p_AssertOnError;
     s_ValidationLayersEnabled = p_EnableValidationLayers;
+    s_ApiVersion = p_VulkanApiVersion;
 
 #ifdef _DEBUG
     if (p_EnableValidationLayers && !checkValidationLayerSupport())
@@ -272,6 +278,11 @@ VulkanDevice& VulkanContext::getDevice(const ResourceID p_Index)
     throw std::runtime_error("Device (ID:" + std::to_string(p_Index) + ") not found");
 }
 
+bool VulkanContext::hasDevice(const ResourceID p_Index)
+{
+    return std::ranges::any_of(m_Devices, [p_Index](const VulkanDevice* p_Device) { return p_Device->getID() == p_Index; });
+}
+
 void VulkanContext::freeDevice(const ResourceID p_Index)
 {
     for (auto l_It = m_Devices.begin(); l_It != m_Devices.end(); ++l_It)
@@ -301,6 +312,8 @@ void VulkanContext::free()
     }
     m_Devices.clear();
 
+    VulkanShaderSessionPool::shutdown();
+
     if (s_ValidationLayersEnabled)
     {
         destroyDebugUtilsMessengerEXT(s_VkHandle, s_DebugMessenger, nullptr);
@@ -0,0 +1,303 @@
+#include "vulkan_defragmenter.hpp"
+
+#include <array>
+#include <ranges>
+#include <stdexcept>
+#include <vulkan/vk_enum_string_helper.h>
+
+#include "vulkan_buffer.hpp"
+#include "vulkan_command_buffer.hpp"
+#include "vulkan_context.hpp"
+#include "vulkan_device.hpp"
+#include "vulkan_image.hpp"
+#include "utils/logger.hpp"
+#include "utils/vulkan_base.hpp"
+
+namespace
+{
+    VkImageAspectFlags getFormatAspect(const VkFormat p_Format)
+    {
+        switch (p_Format)
+        {
+        case VK_FORMAT_D16_UNORM:
+        case VK_FORMAT_X8_D24_UNORM_PACK32:
+        case VK_FORMAT_D32_SFLOAT:
+            return VK_IMAGE_ASPECT_DEPTH_BIT;
+        case VK_FORMAT_S8_UINT:
+            return VK_IMAGE_ASPECT_STENCIL_BIT;
+        case VK_FORMAT_D16_UNORM_S8_UINT:
+        case VK_FORMAT_D24_UNORM_S8_UINT:
+        case VK_FORMAT_D32_SFLOAT_S8_UINT:
+            return VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+        default:
+            return VK_IMAGE_ASPECT_COLOR_BIT;
+        }
+    }
+}
+
+VulkanDefragmenter::VulkanDefragmenter(const ResourceID p_Device, const Config& p_Config)
+    : m_Device(p_Device)
+{
+    const VulkanMemoryAllocator& l_Allocator = VulkanContext::getDevice(m_Device).getMemoryAllocator();
+
+    VmaDefragmentationInfo l_Info{};
+    l_Info.flags = p_Config.flags;
+    l_Info.pool = p_Config.pool != UINT32_MAX ? l_Allocator.getPool(p_Config.pool) : VK_NULL_HANDLE;
+    l_Info.maxBytesPerPass = p_Config.maxBytesPerPass;
+    l_Info.maxAllocationsPerPass = p_Config.maxAllocationsPerPass;
+    VULKAN_TRY(vmaBeginDefragmentation(*l_Allocator, &l_Info, &m_Context));
+
+    LOG_DEBUG("Started defragmentation on device (ID:", m_Device, ") with a budget of ", VulkanMemoryAllocator::compactBytes(p_Config.maxBytesPerPass), " per pass");
+}
+
+VulkanDefragmenter::~VulkanDefragmenter()
+{
+    if (!isFinished())
+    {
+        finish();
+    }
+}
+
+bool VulkanDefragmenter::step(const VulkanCommandBuffer& p_CommandBuffer)
+{
+    if (m_PassActive)
+    {
+        endPass();
+    }
+    if (isFinished())
+    {
+        return false;
+    }
+
+    m_MovedResources.clear();
+    const VulkanMemoryAllocator& l_Allocator = VulkanContext::getDevice(m_Device).getMemoryAllocator();
+    const VkResult l_Result = vmaBeginDefragmentationPass(*l_Allocator, m_Context, &m_PassInfo);
+    if (l_Result == VK_SUCCESS)
+    {
+        endDefragmentation();
+        return false;
+    }
+    if (l_Result != VK_INCOMPLETE)
+    {
+        throw std::runtime_error("Failed to begin defragmentation pass on device (ID:" + std::to_string(m_Device) + "): " + string_VkResult(l_Result));
+    }
+
+    m_PassActive = true;
+    recordMoves(p_CommandBuffer);
+    return true;
+}
+
+void VulkanDefragmenter::finish()
+{
+    if (isFinished())
+    {
+        return;
+    }
+    if (m_PassActive)
+    {
+        endPass();
+    }
+    if (!isFinished())
+    {
+        endDefragmentation();
+    }
+}
+
+void VulkanDefragmenter::recordMoves(const VulkanCommandBuffer& p_CommandBuffer)
+{
+    VulkanDevice& l_Device = VulkanContext::getDevice(m_Device);
+    const VulkanMemoryAllocator& l_Allocator = l_Device.getMemoryAllocator();
+    const VkCommandBuffer l_CommandBuffer = *p_CommandBuffer;
+
+    const VkMemoryBarrier l_PreBarrier{VK_STRUCTURE_TYPE_MEMORY_BARRIER, nullptr, VK_ACCESS_MEMORY_WRITE_BIT, VK_ACCESS_TRANSFER_READ_BIT};
+    l_Device.getTable().vkCmdPipelineBarrier(l_CommandBuffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &l_PreBarrier, 0, nullptr, 0, nullptr);
+
+    for (uint32_t i = 0; i < m_PassInfo.moveCount; i++)
+    {
+        VmaDefragmentationMove& l_Move = m_PassInfo.pMoves[i];
+        const void* l_UserData = l_Allocator.getAllocationInfo(l_Move.srcAllocation).pUserData;
+        const ResourceID l_ID = static_cast<ResourceID>(reinterpret_cast<uintptr_t>(l_UserData));
+
+        bool l_Moved = false;
+        if (l_UserData != nullptr && l_Device.getSubresource<VulkanBuffer>(l_ID) != nullptr)
+        {
+            l_Moved = moveBuffer(l_Move, l_ID, l_CommandBuffer);
+        }
+        else if (l_UserData != nullptr && l_Device.getSubresource<VulkanImage>(l_ID) != nullptr)
+        {
+            l_Moved = moveImage(l_Move, l_ID, l_CommandBuffer);
+        }
+
+        if (l_Moved)
+        {
+            m_MovedResources.push_back(l_ID);
+        }
+        else
+        {
+            l_Move.operation = VMA_DEFRAGMENTATION_MOVE_OPERATION_IGNORE;
+        }
+    }
+
+    const VkMemoryBarrier l_PostBarrier{VK_STRUCTURE_TYPE_MEMORY_BARRIER, nullptr, VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT};
+    l_Device.getTable().vkCmdPipelineBarrier(l_CommandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 1, &l_PostBarrier, 0, nullptr, 0, nullptr);
+
+    LOG_DEBUG("Recorded defragmentation pass with ", m_MovedResources.size(), " of ", m_PassInfo.moveCount, " move(s) on device (ID:", m_Device, ")");
+}
+
+bool VulkanDefragmenter::moveBuffer(VmaDefragmentationMove& p_Move, const ResourceID p_Buffer, const VkCommandBuffer p_CommandBuffer)
+{
+    VulkanDevice& l_Device = VulkanContext::getDevice(m_Device);
+    const VulkanMemoryAllocator& l_Allocator = l_Device.getMemoryAllocator();
+    VulkanBuffer& l_Buffer = l_Device.getBuffer(p_Buffer);
+
+    constexpr VkBufferUsageFlags TRANSFER_USAGE = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+    if (!l_Buffer.isMovable() || l_Buffer.isMemoryMapped() || (l_Buffer.m_Usage & TRANSFER_USAGE) != TRANSFER_USAGE)
+    {
+        return false;
+    }
+
+    VkBufferCreateInfo l_BufferInfo{};
+    l_BufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    l_BufferInfo.size = l_Buffer.m_Size;
+    l_BufferInfo.usage = l_Buffer.m_Usage;
+    l_BufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    VkBuffer l_NewBuffer;
+    VULKAN_TRY(l_Device.getTable().vkCreateBuffer(*l_Device, &l_BufferInfo, nullptr, &l_NewBuffer));
+
+    VkMemoryRequirements l_Reqs;
+    l_Device.getTable().vkGetBufferMemoryRequirements(*l_Device, l_NewBuffer, &l_Reqs);
+    if (l_Reqs.size > l_Allocator.getAllocationInfo(p_Move.dstTmpAlloc).size || vmaBindBufferMemory(*l_Allocator, p_Move.dstTmpAlloc, l_NewBuffer) != VK_SUCCESS)
+    {
+        l_Device.getTable().vkDestroyBuffer(*l_Device, l_NewBuffer, nullptr);
+        return false;
+    }
+
+    const VkBufferCopy l_Region{0, 0, l_Buffer.m_Size};
+    l_Device.getTable().vkCmdCopyBuffer(p_CommandBuffer, l_Buffer.m_VkHandle, l_NewBuffer, 1, &l_Region);
+
+    m_RetiredBuffers.push_back(l_Buffer.m_VkHandle);
+    l_Buffer.m_VkHandle = l_NewBuffer;
+    return true;
+}
+
+bool VulkanDefragmenter::moveImage(VmaDefragmentationMove& p_Move, const ResourceID p_Image, const VkCommandBuffer p_CommandBuffer)
+{
+    VulkanDevice& l_Device = VulkanContext::getDevice(m_Device);
+    const VulkanMemoryAllocator& l_Allocator = l_Device.getMemoryAllocator();
+    VulkanImage& l_Image = l_Device.getImage(p_Image);
+
+    // Images with no contents yet only need a new handle, everything else has to be copied over
+    const bool l_HasContents = l_Image.m_Layout != VK_IMAGE_LAYOUT_UNDEFINED;
+    constexpr VkImageUsageFlags TRANSFER_USAGE = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+    if (!l_Image.isMovable() || l_Image.m_Usage == 0 || l_Image.isMemoryMapped() || (l_HasContents && (l_Image.m_Usage & TRANSFER_USAGE) != TRANSFER_USAGE))
+    {
+        return false;
+    }
+    for (const VulkanImageView* l_View : l_Image.m_ImageViews | std::views::values)
+    {
+        if (l_View->m_CreateInfo.sType != VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO)
+        {
+            return false;
+        }
+    }
+
+    VkImageCreateInfo l_ImageInfo{};
+    l_ImageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    l_ImageInfo.imageType = l_Image.m_Type;
+    l_ImageInfo.format = l_Image.m_Format;
+    l_ImageInfo.extent = l_Image.m_Size;
+    l_ImageInfo.mipLevels = l_Image.m_MipLevels;
+    l_ImageInfo.arrayLayers = l_Image.m_ArrayLayers;
+    l_ImageInfo.samples = l_Image.m_Samples;
+    l_ImageInfo.tiling = l_Image.m_Tiling;
+    l_ImageInfo.usage = l_Image.m_Usage;
+    l_ImageInfo.flags = l_Image.m_CreateFlags;
+    l_ImageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    l_ImageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    VkImage l_NewImage;
+    VULKAN_TRY(l_Device.getTable().vkCreateImage(*l_Device, &l_ImageInfo, nullptr, &l_NewImage));
+
+    VkMemoryRequirements l_Reqs;
+    l_Device.getTable().vkGetImageMemoryRequirements(*l_Device, l_NewImage, &l_Reqs);
+    if (l_Reqs.size > l_Allocator.getAllocationInfo(p_Move.dstTmpAlloc).size || vmaBindImageMemory(*l_Allocator, p_Move.dstTmpAlloc, l_NewImage) != VK_SUCCESS)
+    {
+        l_Device.getTable().vkDestroyImage(*l_Device, l_NewImage, nullptr);
+        return false;
+    }
+
+    if (l_HasContents)
+    {
+        const VkImageSubresourceRange l_Range{getFormatAspect(l_Image.m_Format), 0, l_Image.m_MipLevels, 0, l_Image.m_ArrayLayers};
+        const VkImageLayout l_FinalLayout = l_Image.m_Layout == VK_IMAGE_LAYOUT_PREINITIALIZED ? VK_IMAGE_LAYOUT_GENERAL : l_Image.m_Layout;
+
+        std::array<VkImageMemoryBarrier, 2> l_PreBarriers{};
+        l_PreBarriers[0] = {VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER, nullptr, VK_ACCESS_MEMORY_WRITE_BIT, VK_ACCESS_TRANSFER_READ_BIT, l_Image.m_Layout, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, l_Image.m_VkHandle, l_Range};
+        l_PreBarriers[1] = {VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER, nullptr, 0, VK_ACCESS_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, l_NewImage, l_Range};
+        l_Device.getTable().vkCmdPipelineBarrier(p_CommandBuffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, static_cast<uint32_t>(l_PreBarriers.size()), l_PreBarriers.data());
+
+        TRANS_VECTOR(l_Regions, VkImageCopy);
+        l_Regions.reserve(l_Image.m_MipLevels);
+        for (uint32_t i = 0; i < l_Image.m_MipLevels; i++)
+        {
+            const VkImageSubresourceLayers l_Layers{l_Range.aspectMask, i, 0, l_Image.m_ArrayLayers};
+            l_Regions.push_back({l_Layers, {0, 0, 0}, l_Layers, {0, 0, 0}, l_Image.getMipSize(i)});
+        }
+        l_Device.getTable().vkCmdCopyImage(p_CommandBuffer, l_Image.m_VkHandle, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, l_NewImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, static_cast<uint32_t>(l_Regions.size()), l_Regions.data());
+
+        const VkImageMemoryBarrier l_PostBarrier{VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER, nullptr, VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, l_FinalLayout, VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, l_NewImage, l_Range};
+        l_Device.getTable().vkCmdPipelineBarrier(p_CommandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 0, nullptr, 0, nullptr, 1, &l_PostBarrier);
+        l_Image.m_Layout = l_FinalLayout;
+    }
+
+    for (VulkanImageView* l_View : l_Image.m_ImageViews | std::views::values)
+    {
+        VkImageViewCreateInfo l_ViewInfo = l_View->m_CreateInfo;
+        l_ViewInfo.image = l_NewImage;
+
+        VkImageView l_NewView;
+        VULKAN_TRY(l_Device.getTable().vkCreateImageView(*l_Device, &l_ViewInfo, nullptr, &l_NewView));
+        m_RetiredViews.push_back(l_View->m_VkHandle);
+        l_View->m_VkHandle = l_NewView;
+        l_View->m_CreateInfo.image = l_NewImage;
+    }
+
+    m_RetiredImages.push_back(l_Image.m_VkHandle);
+    l_Image.m_VkHandle = l_NewImage;
+    return true;
+}
+
+void VulkanDefragmenter::endPass()
+{
+    VulkanDevice& l_Device = VulkanContext::getDevice(m_Device);
+
+    for (const VkImageView l_View : m_RetiredViews)
+    {
+        l_Device.getTable().vkDestroyImageView(*l_Device, l_View, nullptr);
+    }
+    for (const VkImage l_Image : m_RetiredImages)
+    {
+        l_Device.getTable().vkDestroyImage(*l_Device, l_Image, nullptr);
+    }
+    for (const VkBuffer l_Buffer : m_RetiredBuffers)
+    {
+        l_Device.getTable().vkDestroyBuffer(*l_Device, l_Buffer, nullptr);
+    }
+    m_RetiredViews.clear();
+    m_RetiredImages.clear();
+    m_RetiredBuffers.clear();
+
+    m_PassActive = false;
+    if (vmaEndDefragmentationPass(*l_Device.getMemoryAllocator(), m_Context, &m_PassInfo) == VK_SUCCESS)
+    {
+        endDefragmentation();
+    }
+}
+
+void VulkanDefragmenter::endDefragmentation()
+{
+    vmaEndDefragmentation(*VulkanContext::getDevice(m_Device).getMemoryAllocator(), m_Context, &m_Stats);
+    m_Context = VK_NULL_HANDLE;
+    LOG_DEBUG("Finished defragmentation on device (ID:", m_Device, "): moved ", m_Stats.allocationsMoved, " allocation(s), ", VulkanMemoryAllocator::compactBytes(m_Stats.bytesMoved), ", freed ", m_Stats.deviceMemoryBlocksFreed, " block(s)");
+}
@@ -1,14 +1,23 @@
 #include "vulkan_device.hpp"
 
+#include <algorithm>
+#include <map>
 #include <ranges>
 #include <stdexcept>
 #include <vulkan/vk_enum_string_helper.h>
 
 #include "vulkan_context.hpp"
 #include "ext/vulkan_extension_management.hpp"
+#include "utils/shader_reflection.hpp"
 #include "utils/logger.hpp"
 #include "utils/vulkan_base.hpp"
 
+template <typename T>
+static void appendKey(std::string& p_Key, const T& p_Value)
+{
+    p_Key.append(reinterpret_cast<const char*>(&p_Value), sizeof(T));
+}
+
 VulkanQueue VulkanDevice::getQueue(const QueueSelection& p_QueueSelection) const
 {
     VkQueue l_Queue;
@@ -251,13 +260,45 @@ ResourceID VulkanDevice::createAndAllocateBuffer(const VulkanMemoryAllocator::Me
 
     const VulkanMemoryAllocator::AllocationReturn l_Ret = m_MemoryAllocator.createBuffer(l_BufferInfo, p_MemoryPreferences);
 
-    VulkanBuffer* l_NewRes = ARENA_ALLOC(VulkanBuffer){m_ID, l_Ret.as<VkBuffer>(), p_Config.size};
+    VulkanBuffer* l_NewRes = ARENA_ALLOC(VulkanBuffer){m_ID, l_Ret.as<VkBuffer>(), p_Config.size, p_Config.usage};
     m_Subresources[l_NewRes->getID()] = l_NewRes;
     l_NewRes->setBoundMemory(l_Ret.allocation);
+    m_MemoryAllocator.trackFrameResource(p_MemoryPreferences.pool, l_NewRes->getID());
     LOG_DEBUG("Created and allocated buffer (ID:", l_NewRes->getID(), ") with size ", VulkanMemoryAllocator::compactBytes(l_NewRes->getSize()));
     return l_NewRes->getID();
 }
 
+std::vector<ResourceID> VulkanDevice::createAndAllocateBuffers(const VulkanMemoryAllocator::MemoryPreferences& p_MemoryPreferences, const std::span<const VulkanBuffer::Config> p_Configs)
+{
+    std::vector<ResourceID> l_Buffers;
+    l_Buffers.reserve(p_Configs.size());
+    for (const VulkanBuffer::Config& l_Config : p_Configs)
+    {
+        l_Buffers.push_back(createBuffer(l_Config));
+    }
+
+    std::vector<VmaAllocation> l_Allocations;
+    try
+    {
+        l_Allocations = m_MemoryAllocator.allocateBuffers(l_Buffers, p_MemoryPreferences);
+    }
+    catch (...)
+    {
+        for (const ResourceID l_Buffer : l_Buffers)
+        {
+            freeBuffer(l_Buffer);
+        }
+        throw;
+    }
+
+    for (size_t i = 0; i < l_Buffers.size(); i++)
+    {
+        getBuffer(l_Buffers[i]).setBoundMemory(l_Allocations[i]);
+    }
+    LOG_DEBUG("Created and allocated ", l_Buffers.size(), " buffer(s) in batch");
+    return l_Buffers;
+}
+
 ResourceID VulkanDevice::createBuffer(const VulkanBuffer::Config& p_Config)
 {
     VkBufferCreateInfo l_BufferInfo{};
@@ -275,12 +316,41 @@ ResourceID VulkanDevice::createBuffer(const VulkanBuffer::Config& p_Config)
     VkBuffer l_Buffer;
     VULKAN_TRY(getTable().vkCreateBuffer(m_VkHandle, &l_BufferInfo, nullptr, &l_Buffer));
 
-    VulkanBuffer* l_NewRes = ARENA_ALLOC(VulkanBuffer){m_ID, l_Buffer, p_Config.size};
+    VulkanBuffer* l_NewRes = ARENA_ALLOC(VulkanBuffer){m_ID, l_Buffer, p_Config.size, p_Config.usage};
     m_Subresources[l_NewRes->getID()] = l_NewRes;
     LOG_DEBUG("Created buffer (ID:", l_NewRes->getID(), ") with size ", VulkanMemoryAllocator::compactBytes(l_NewRes->getSize()));
     return l_NewRes->getID();
 }
 
+ResourceID VulkanDevice::createSparseBuffer(const VulkanBuffer::Config& p_Config)
+{
+    const VkPhysicalDeviceFeatures l_Features = m_PhysicalDevice.getFeatures();
+    if (!l_Features.sparseBinding || !l_Features.sparseResidencyBuffer)
+    {
+        throw std::runtime_error("Device (ID:" + std::to_string(m_ID) + ") does not support sparse residency buffers");
+    }
+
+    VkBufferCreateInfo l_BufferInfo{};
+    l_BufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    l_BufferInfo.size = p_Config.size;
+    l_BufferInfo.usage = p_Config.usage;
+    l_BufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    l_BufferInfo.flags = VK_BUFFER_CREATE_SPARSE_BINDING_BIT | VK_BUFFER_CREATE_SPARSE_RESIDENCY_BIT;
+    if (p_Config.ownerQueueFamilyIndex != VK_QUEUE_FAMILY_IGNORED)
+    {
+        l_BufferInfo.queueFamilyIndexCount = 1;
+        l_BufferInfo.pQueueFamilyIndices = &p_Config.ownerQueueFamilyIndex;
+    }
+
+    VkBuffer l_Buffer;
+    VULKAN_TRY(getTable().vkCreateBuffer(m_VkHandle, &l_BufferInfo, nullptr, &l_Buffer));
+
+    VulkanBuffer* l_NewRes = ARENA_ALLOC(VulkanBuffer){m_ID, l_Buffer, p_Config.size, p_Config.usage};
+    m_Subresources[l_NewRes->getID()] = l_NewRes;
+    LOG_DEBUG("Created sparse buffer (ID:", l_NewRes->getID(), ") with size ", VulkanMemoryAllocator::compactBytes(l_NewRes->getSize()));
+    return l_NewRes->getID();
+}
+
 ResourceID VulkanDevice::createAndAllocateImage(const VulkanMemoryAllocator::MemoryPreferences& p_MemoryPreferences, const VulkanImage::Config& p_Config)
 {
     VkImageCreateInfo l_ImageInfo{};
@@ -288,9 +358,9 @@ ResourceID VulkanDevice::createAndAllocateImage(const VulkanMemoryAllocator::Mem
     l_ImageInfo.imageType = p_Config.type;
     l_ImageInfo.format = p_Config.format;
     l_ImageInfo.extent = p_Config.extent;
-    l_ImageInfo.mipLevels = 1;
-    l_ImageInfo.arrayLayers = 1;
-    l_ImageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+    l_ImageInfo.mipLevels = p_Config.mipLevels;
+    l_ImageInfo.arrayLayers = p_Config.arrayLayers;
+    l_ImageInfo.samples = p_Config.samples;
     l_ImageInfo.tiling = p_Config.tiling;
     l_ImageInfo.usage = p_Config.usage;
     l_ImageInfo.flags = p_Config.flags;
@@ -301,13 +371,45 @@ ResourceID VulkanDevice::createAndAllocateImage(const VulkanMemoryAllocator::Mem
 
     const VulkanMemoryAllocator::AllocationReturn l_Ret = m_MemoryAllocator.createImage(l_ImageInfo, p_MemoryPreferences);
 
-    VulkanImage* l_NewRes = ARENA_ALLOC(VulkanImage) { m_ID, l_Ret.as<VkImage>(), p_Config.extent, p_Config.type, VK_IMAGE_LAYOUT_UNDEFINED };
+    VulkanImage* l_NewRes = ARENA_ALLOC(VulkanImage) { m_ID, l_Ret.as<VkImage>(), p_Config.extent, p_Config.type, VK_IMAGE_LAYOUT_UNDEFINED, p_Config.format, p_Config.mipLevels, p_Config.arrayLayers, p_Config.samples, p_Config.usage, p_Config.tiling, p_Config.flags };
     m_Subresources[l_NewRes->getID()] = l_NewRes;
     l_NewRes->setBoundMemory(l_Ret.allocation);
-    LOG_DEBUG("Created and allocated image (ID:", l_NewRes->getID(), ")");
+    m_MemoryAllocator.trackFrameResource(p_MemoryPreferences.pool, l_NewRes->getID());
+    LOG_DEBUG("Created and allocated image (ID:", l_NewRes->getID(), ") with ", p_Config.mipLevels, " mip level(s) and ", p_Config.arrayLayers, " layer(s)");
     return l_NewRes->getID();
 }
 
+std::vector<ResourceID> VulkanDevice::createAndAllocateImages(const VulkanMemoryAllocator::MemoryPreferences& p_MemoryPreferences, const std::span<const VulkanImage::Config> p_Configs)
+{
+    std::vector<ResourceID> l_Images;
+    l_Images.reserve(p_Configs.size());
+    for (const VulkanImage::Config& l_Config : p_Configs)
+    {
+        l_Images.push_back(createImage(l_Config));
+    }
+
+    std::vector<VmaAllocation> l_Allocations;
+    try
+    {
+        l_Allocations = m_MemoryAllocator.allocateImages(l_Images, p_MemoryPreferences);
+    }
+    catch (...)
+    {
+        for (const ResourceID l_Image : l_Images)
+        {
+            freeImage(l_Image);
+        }
+        throw;
+    }
+
+    for (size_t i = 0; i < l_Images.size(); i++)
+    {
+        getImage(l_Images[i]).setBoundMemory(l_Allocations[i]);
+    }
+    LOG_DEBUG("Created and allocated ", l_Images.size(), " image(s) in batch");
+    return l_Images;
+}
+
 ResourceID VulkanDevice::createImage(const VulkanImage::Config& p_Config)
 {
     VkImageCreateInfo l_ImageInfo{};
@@ -315,9 +417,9 @@ ResourceID VulkanDevice::createImage(const VulkanImage::Config& p_Config)
     l_ImageInfo.imageType = p_Config.type;
     l_ImageInfo.format = p_Config.format;
     l_ImageInfo.extent = p_Config.extent;
-    l_ImageInfo.mipLevels = 1;
-    l_ImageInfo.arrayLayers = 1;
-    l_ImageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+    l_ImageInfo.mipLevels = p_Config.mipLevels;
+    l_ImageInfo.arrayLayers = p_Config.arrayLayers;
+    l_ImageInfo.samples = p_Config.samples;
     l_ImageInfo.tiling = p_Config.tiling;
     l_ImageInfo.usage = p_Config.usage;
     l_ImageInfo.flags = p_Config.flags;
@@ -329,13 +431,54 @@ ResourceID VulkanDevice::createImage(const VulkanImage::Config& p_Config)
     VkImage l_Image;
     VULKAN_TRY(getTable().vkCreateImage(m_VkHandle, &l_ImageInfo, nullptr, &l_Image));
 
-    VulkanImage* l_NewRes = ARENA_ALLOC(VulkanImage){m_ID, l_Image, p_Config.extent, p_Config.type, VK_IMAGE_LAYOUT_UNDEFINED};
+    VulkanImage* l_NewRes = ARENA_ALLOC(VulkanImage){m_ID, l_Image, p_Config.extent, p_Config.type, VK_IMAGE_LAYOUT_UNDEFINED, p_Config.format, p_Config.mipLevels, p_Config.arrayLayers, p_Config.samples, p_Config.usage, p_Config.tiling, p_Config.flags};
     m_Subresources[l_NewRes->getID()] = l_NewRes;
-    LOG_DEBUG("Created image (ID:", l_NewRes->getID(), ")");
+    LOG_DEBUG("Created image (ID:", l_NewRes->getID(), ") with ", p_Config.mipLevels, " mip level(s) and ", p_Config.arrayLayers, " layer(s)");
 
     return l_NewRes->getID();
 }
 
+ResourceID VulkanDevice::createSparseImage(const VulkanImage::Config& p_Config)
+{
+    const VkPhysicalDeviceFeatures l_Features = m_PhysicalDevice.getFeatures();
+    const bool l_Supported = p_Config.type == VK_IMAGE_TYPE_3D ? l_Features.sparseResidencyImage3D : l_Features.sparseResidencyImage2D;
+    if (!l_Features.sparseBinding || !l_Supported || p_Config.type == VK_IMAGE_TYPE_1D)
+    {
+        throw std::runtime_error("Device (ID:" + std::to_string(m_ID) + ") does not support sparse residency for this image type");
+    }
+
+    VkBool32 l_SamplesSupported;
+    switch (p_Config.samples)
+    {
+    case VK_SAMPLE_COUNT_1_BIT:
+        l_SamplesSupported = VK_TRUE;
+        break;
+    case VK_SAMPLE_COUNT_2_BIT:
+        l_SamplesSupported = l_Features.sparseResidency2Samples;
+        break;
+    case VK_SAMPLE_COUNT_4_BIT:
+        l_SamplesSupported = l_Features.sparseResidency4Samples;
+        break;
+    case VK_SAMPLE_COUNT_8_BIT:
+        l_SamplesSupported = l_Features.sparseResidency8Samples;
+        break;
+    case VK_SAMPLE_COUNT_16_BIT:
+        l_SamplesSupported = l_Features.sparseResidency16Samples;
+        break;
+    default:
+        l_SamplesSupported = VK_FALSE;
+        break;
+    }
+    if (!l_SamplesSupported)
+    {
+        throw std::runtime_error("Device (ID:" + std::to_string(m_ID) + ") does not support sparse residency for images with " + string_VkSampleCountFlagBits(p_Config.samples));
+    }
+
+    VulkanImage::Config l_Config = p_Config;
+    l_Config.flags |= VK_IMAGE_CREATE_SPARSE_BINDING_BIT | VK_IMAGE_CREATE_SPARSE_RESIDENCY_BIT;
+    return createImage(l_Config);
+}
+
 void VulkanDevice::configureStagingBuffer(const VkDeviceSize p_Size, const QueueSelection& p_Queue, const bool p_ForceAllowStagingMemory)
 {
     if (m_StagingBufferInfo.stagingBuffer != UINT32_MAX)
@@ -448,12 +591,98 @@ ResourceID VulkanDevice::createPipelineLayout(const std::span<const ResourceID>
     VkPipelineLayout l_Layout;
     VULKAN_TRY(getTable().vkCreatePipelineLayout(m_VkHandle, &l_PipelineLayoutInfo, nullptr, &l_Layout));
 
-    VulkanPipelineLayout* l_NewRes = ARENA_ALLOC(VulkanPipelineLayout){m_ID, l_Layout};
+    VulkanPipelineLayout* l_NewRes = ARENA_ALLOC(VulkanPipelineLayout){m_ID, l_Layout, p_DescriptorSetLayouts};
     m_Subresources[l_NewRes->getID()] = l_NewRes;
     LOG_DEBUG("Created pipeline layout (ID:", l_NewRes->getID(), ") with ", l_Layouts.size(), " descriptor set layout(s) and ", p_PushConstantRanges.size(), " push constant range(s)");
     return l_NewRes->getID();
 }
 
+ResourceID VulkanDevice::createPipelineLayout(const std::span<const ShaderReflectionData* const> p_Reflections)
+{
+    std::map<uint32_t, std::vector<VkDescriptorSetLayoutBinding>> l_Sets;
+    std::vector<VkPushConstantRange> l_PushConstants;
+    for (const ShaderReflectionData* l_Reflection : p_Reflections)
+    {
+        for (const ShaderReflectionData::DescriptorBinding& l_Binding : l_Reflection->descriptorBindings)
+        {
+            std::vector<VkDescriptorSetLayoutBinding>& l_Bindings = l_Sets[l_Binding.set];
+            const auto l_Existing = std::ranges::find(l_Bindings, l_Binding.binding, &VkDescriptorSetLayoutBinding::binding);
+            if (l_Existing == l_Bindings.end())
+            {
+                l_Bindings.push_back({l_Binding.binding, l_Binding.type, l_Binding.count, l_Reflection->stageFlags, nullptr});
+                continue;
+            }
+
+            if (l_Existing->descriptorType != l_Binding.type || l_Existing->descriptorCount != l_Binding.count)
+            {
+                throw std::runtime_error("Binding " + std::to_string(l_Binding.binding) + " of descriptor set " + std::to_string(l_Binding.set) + " is declared differently across shader stages");
+            }
+            l_Existing->stageFlags |= l_Reflection->stageFlags;
+        }
+
+        if (l_Reflection->hasPushConstants())
+        {
+            // Every stage reads its block from offset 0, so stages only share a range when their blocks have the same size
+            const VkPushConstantRange l_Range = l_Reflection->getPushConstantRange();
+            if (std::ranges::any_of(l_PushConstants, [&](const VkPushConstantRange& p_Other) { return (p_Other.stageFlags & l_Range.stageFlags) != 0; }))
+            {
+                throw std::runtime_error("A shader stage declares push constants in more than one reflection");
+            }
+            const auto l_Same = std::ranges::find(l_PushConstants, l_Range.size, &VkPushConstantRange::size);
+            if (l_Same != l_PushConstants.end())
+            {
+                l_Same->stageFlags |= l_Range.stageFlags;
+            }
+            else
+            {
+                l_PushConstants.push_back(l_Range);
+            }
+        }
+    }
+
+    // Sets the shaders skip still need a layout so the following set indices stay in place
+    TRANS_VECTOR(l_SetLayouts, ResourceID);
+    const uint32_t l_SetCount = l_Sets.empty() ? 0 : l_Sets.rbegin()->first + 1;
+    l_SetLayouts.reserve(l_SetCount);
+    for (uint32_t i = 0; i < l_SetCount; i++)
+    {
+        const auto l_Set = l_Sets.find(i);
+        l_SetLayouts.push_back(l_Set != l_Sets.end() ? getOrCreateDescriptorSetLayout(l_Set->second) : getOrCreateDescriptorSetLayout({}));
+    }
+
+    return getOrCreatePipelineLayout(l_SetLayouts, l_PushConstants);
+}
+
+ResourceID VulkanDevice::getOrCreatePipelineLayout(const std::span<const ResourceID> p_DescriptorSetLayouts, const std::span<const VkPushConstantRange> p_PushConstantRanges)
+{
+    std::string l_Key;
+    appendKey(l_Key, static_cast<uint32_t>(p_DescriptorSetLayouts.size()));
+    for (const ResourceID l_Layout : p_DescriptorSetLayouts)
+    {
+        appendKey(l_Key, l_Layout);
+    }
+    for (const VkPushConstantRange& l_Range : p_PushConstantRanges)
+    {
+        appendKey(l_Key, l_Range.stageFlags);
+        appendKey(l_Key, l_Range.offset);
+        appendKey(l_Key, l_Range.size);
+    }
+
+    const auto l_Cached = m_PipelineLayoutCache.find(l_Key);
+    if (l_Cached != m_PipelineLayoutCache.end())
+    {
+        if (m_Subresources.contains(l_Cached->second))
+        {
+            return l_Cached->second;
+        }
+        m_PipelineLayoutCache.erase(l_Cached);
+    }
+
+    const ResourceID l_Layout = createPipelineLayout(p_DescriptorSetLayouts, p_PushConstantRanges);
+    m_PipelineLayoutCache.emplace(std::move(l_Key), l_Layout);
+    return l_Layout;
+}
+
 ResourceID VulkanDevice::createDescriptorPool(const std::span<const VkDescriptorPoolSize> p_PoolSizes, const uint32_t p_MaxSets, const VkDescriptorPoolCreateFlags p_Flags)
 {
     VkDescriptorPoolCreateInfo l_PoolInfo{};
@@ -489,6 +718,43 @@ ResourceID VulkanDevice::createDescriptorSetLayout(const std::span<const VkDescr
     return l_NewRes->getID();
 }
 
+ResourceID VulkanDevice::getOrCreateDescriptorSetLayout(const std::span<const VkDescriptorSetLayoutBinding> p_Bindings, const VkDescriptorSetLayoutCreateFlags p_Flags)
+{
+    if (std::ranges::any_of(p_Bindings, [](const VkDescriptorSetLayoutBinding& p_Binding) { return p_Binding.pImmutableSamplers != nullptr; }))
+    {
+        return createDescriptorSetLayout(p_Bindings, p_Flags);
+    }
+
+    // Binding order does not change the layout, so sorting lets differently ordered declarations share it
+    TRANS_VECTOR(l_Bindings, VkDescriptorSetLayoutBinding);
+    l_Bindings.assign(p_Bindings.begin(), p_Bindings.end());
+    std::ranges::sort(l_Bindings, {}, &VkDescriptorSetLayoutBinding::binding);
+
+    std::string l_Key;
+    appendKey(l_Key, p_Flags);
+    for (const VkDescriptorSetLayoutBinding& l_Binding : l_Bindings)
+    {
+        appendKey(l_Key, l_Binding.binding);
+        appendKey(l_Key, l_Binding.descriptorType);
+        appendKey(l_Key, l_Binding.descriptorCount);
+        appendKey(l_Key, l_Binding.stageFlags);
+    }
+
+    const auto l_Cached = m_DescriptorSetLayoutCache.find(l_Key);
+    if (l_Cached != m_DescriptorSetLayoutCache.end())
+    {
+        if (m_Subresources.contains(l_Cached->second))
+        {
+            return l_Cached->second;
+        }
+        m_DescriptorSetLayoutCache.erase(l_Cached);
+    }
+
+    const ResourceID l_Layout = createDescriptorSetLayout({l_Bindings.data(), l_Bindings.size()}, p_Flags);
+    m_DescriptorSetLayoutCache.emplace(std::move(l_Key), l_Layout);
+    return l_Layout;
+}
+
 ResourceID VulkanDevice::createDescriptorSet(ResourceID p_Pool, ResourceID p_Layout)
 {
     const VkDescriptorSetLayout l_DescriptorSetLayout = getDescriptorSetLayout(p_Layout).m_VkHandle;
@@ -540,17 +806,21 @@ void VulkanDevice::updateDescriptorSets(const std::span<const VkWriteDescriptorS
 
 ResourceID VulkanDevice::createShaderModule(VulkanShader& p_ShaderCode, const VkShaderStageFlagBits p_Stage)
 {
-    const std::vector<uint32_t> l_Code = p_ShaderCode.getSPIRVForStage(p_Stage);
+    const std::span<const uint32_t> l_Code = p_ShaderCode.getSPIRVForStage(p_Stage);
     if (p_ShaderCode.getStatus().status == VulkanShader::Result::FAILED)
     {
         LOG_ERR("Failed to load shader -> ", p_ShaderCode.getStatus().error);
         throw std::runtime_error("Failed to create shader module");
     }
+    return createShaderModule(l_Code, p_Stage);
+}
 
+ResourceID VulkanDevice::createShaderModule(const std::span<const uint32_t> p_Code, const VkShaderStageFlagBits p_Stage)
+{
     VkShaderModuleCreateInfo l_CreateInfo{};
     l_CreateInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-    l_CreateInfo.codeSize = 4 * l_Code.size();
-    l_CreateInfo.pCode = l_Code.data();
+    l_CreateInfo.codeSize = 4 * p_Code.size();
+    l_CreateInfo.pCode = p_Code.data();
 
     VkShaderModule l_Shader;
     VULKAN_TRY(getTable().vkCreateShaderModule(m_VkHandle, &l_CreateInfo, nullptr, &l_Shader));
@@ -616,10 +886,32 @@ bool VulkanDevice::isStagingBufferConfigured() const
 }
 
 ResourceID VulkanDevice::createPipeline(const VulkanPipelineBuilder& p_Builder, const ResourceID p_PipelineLayout, const ResourceID p_RenderPass, const uint32_t p_Subpass)
+{
+    const VkPipeline l_Pipeline = buildGraphicsPipeline(p_Builder, p_PipelineLayout, p_RenderPass, p_Subpass);
+
+    VulkanPipeline* l_NewRes = ARENA_ALLOC(VulkanPipeline){m_ID, l_Pipeline, p_PipelineLayout, p_RenderPass, p_Subpass};
+    m_Subresources[l_NewRes->getID()] = l_NewRes;
+    LOG_DEBUG("Created pipeline (ID:", l_NewRes->getID(), ")");
+    return l_NewRes->getID();
+}
+
+ResourceID VulkanDevice::createComputePipeline(const ResourceID p_Layout, const ResourceID p_Shader, const std::string_view p_Entrypoint, const VulkanSpecialization& p_Specialization)
+{
+    const VkPipeline l_Pipeline = buildComputePipeline(p_Layout, p_Shader, p_Entrypoint, p_Specialization);
+
+    VulkanPipeline* l_NewRes = ARENA_ALLOC(VulkanPipeline){m_ID, l_Pipeline, p_Layout, UINT32_MAX, UINT32_MAX};
+    m_Subresources[l_NewRes->getID()] = l_NewRes;
+    LOG_DEBUG("Created compute pipeline (ID:", l_NewRes->getID(), ")");
+    return l_NewRes->getID();
+}
+
+VkPipeline VulkanDevice::buildGraphicsPipeline(const VulkanPipelineBuilder& p_Builder, const ResourceID p_PipelineLayout, const ResourceID p_RenderPass, const uint32_t p_Subpass) const
 {
     TRANS_VECTOR(l_ShaderModules, VkPipelineShaderStageCreateInfo);
+    TRANS_VECTOR(l_Specializations, VkSpecializationInfo);
     l_ShaderModules.resize(p_Builder.getShaderStageCount());
-    p_Builder.createShaderStages(l_ShaderModules.data());
+    l_Specializations.resize(p_Builder.getShaderStageCount());
+    p_Builder.createShaderStages(l_ShaderModules.data(), l_Specializations.data());
 
     VkGraphicsPipelineCreateInfo l_PipelineInfo{};
     l_PipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
@@ -645,14 +937,10 @@ ResourceID VulkanDevice::createPipeline(const VulkanPipelineBuilder& p_Builder,
 
     VkPipeline l_Pipeline;
     VULKAN_TRY(getTable().vkCreateGraphicsPipelines(m_VkHandle, VK_NULL_HANDLE, 1, &l_PipelineInfo, nullptr, &l_Pipeline));
-
-    VulkanPipeline* l_NewRes = ARENA_ALLOC(VulkanPipeline){m_ID, l_Pipeline, p_PipelineLayout, p_RenderPass, p_Subpass};
-    m_Subresources[l_NewRes->getID()] = l_NewRes;
-    LOG_DEBUG("Created pipeline (ID:", l_NewRes->getID(), ")");
-    return l_NewRes->getID();
+    return l_Pipeline;
 }
 
-ResourceID VulkanDevice::createComputePipeline(const ResourceID p_Layout, const ResourceID p_Shader, const std::string_view p_Entrypoint)
+VkPipeline VulkanDevice::buildComputePipeline(const ResourceID p_Layout, const ResourceID p_Shader, const std::string_view p_Entrypoint, const VulkanSpecialization& p_Specialization) const
 {
     VkPipelineShaderStageCreateInfo l_StageInfo{};
     const VulkanShaderModule& l_Shader = getShaderModule(p_Shader);
@@ -661,6 +949,12 @@ ResourceID VulkanDevice::createComputePipeline(const ResourceID p_Layout, const
     l_StageInfo.module = l_Shader.m_VkHandle;
     l_StageInfo.pName = p_Entrypoint.data();
 
+    const VkSpecializationInfo l_Specialization = p_Specialization.getInfo();
+    if (!p_Specialization.empty())
+    {
+        l_StageInfo.pSpecializationInfo = &l_Specialization;
+    }
+
     VkComputePipelineCreateInfo l_PipelineInfo{};
     l_PipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
     l_PipelineInfo.stage = l_StageInfo;
@@ -668,10 +962,7 @@ ResourceID VulkanDevice::createComputePipeline(const ResourceID p_Layout, const
 
     VkPipeline l_Pipeline;
     VULKAN_TRY(getTable().vkCreateComputePipelines(m_VkHandle, VK_NULL_HANDLE, 1, &l_PipelineInfo, nullptr, &l_Pipeline));
-    VulkanPipeline* l_NewRes = ARENA_ALLOC(VulkanPipeline){m_ID, l_Pipeline, p_Layout, UINT32_MAX, UINT32_MAX};
-    m_Subresources[l_NewRes->getID()] = l_NewRes;
-    LOG_DEBUG("Created compute pipeline (ID:", l_NewRes->getID(), ")");
-    return l_NewRes->getID();
+    return l_Pipeline;
 }
 
 bool VulkanDevice::isExtensionEnabled(const std::string_view p_Extension) const
@@ -710,6 +1001,8 @@ bool VulkanDevice::free()
 
     m_ThreadCommandInfos.clear();
 
+    reportLeaks();
+
     TRANS_VECTOR(l_Subresources, ResourceID);
     l_Subresources.reserve(m_Subresources.size());
     for (const VulkanDeviceSubresource* l_Component : m_Subresources | std::views::values)
@@ -736,6 +1029,37 @@ bool VulkanDevice::free()
     return true;
 }
 
+void VulkanDevice::reportLeaks() const
+{
+    uint32_t l_Count = 0;
+    VkDeviceSize l_Bytes = 0;
+    for (const auto& [l_ID, l_Component] : m_Subresources)
+    {
+        if (l_ID == m_StagingBufferInfo.stagingBuffer)
+        {
+            continue;
+        }
+
+        // Pipelines, layouts and other handles are freed with the device anyway, only owned memory is a leak
+        const VulkanMemArray* l_MemArray = dynamic_cast<const VulkanMemArray*>(l_Component);
+        if (l_MemArray == nullptr || !l_MemArray->isMemoryBound())
+        {
+            continue;
+        }
+        l_Count++;
+
+        const VmaAllocationInfo l_Info = m_MemoryAllocator.getAllocationInfo(l_MemArray->getAllocation());
+        const std::optional<VulkanMemoryAllocator::AllocationTag> l_Tag = m_MemoryAllocator.getAllocationTag(l_MemArray->getAllocation());
+        l_Bytes += l_Info.size;
+        LOG_WARN("Leaked ", dynamic_cast<const VulkanBuffer*>(l_MemArray) ? "buffer" : "image", " (ID:", l_ID, ") holding ", VulkanMemoryAllocator::compactBytes(l_Info.size), " in memory type ", l_Info.memoryType, l_Tag ? ", tag " + l_Tag->category + "/" + l_Tag->name : "");
+    }
+
+    if (l_Count > 0)
+    {
+        LOG_WARN("Device (ID:", m_ID, ") freed with ", l_Count, " resource(s) still holding memory, ", VulkanMemoryAllocator::compactBytes(l_Bytes), " of memory still allocated");
+    }
+}
+
 VkCommandPool VulkanDevice::getCommandPool(const uint32_t p_QueueFamilyIndex, ThreadID p_ThreadID, const VulkanCommandBuffer::TypeFlags p_Flags)
 {
     if ((p_Flags & VulkanCommandBuffer::TypeFlagBits::ONE_TIME) != 0)
@@ -754,13 +1078,13 @@ VulkanDevice::VulkanDevice(const VulkanGPU p_PhysicalDevice, const VkDevice p_De
     m_MemoryAllocator = VulkanMemoryAllocator{*this};
 }
 
-void VulkanDevice::insertImage(VulkanImage* p_Image)
+void VulkanDevice::insertSubresource(VulkanDeviceSubresource* p_Resource)
 {
-    if (m_Subresources.contains(p_Image->getID()))
+    if (m_Subresources.contains(p_Resource->getID()))
     {
-        LOG_DEBUG("Image with ID ", p_Image->getID(), " already exists, not inserting again");
+        LOG_DEBUG("Subresource with ID ", p_Resource->getID(), " already exists, not inserting again");
         return;
     }
-    m_Subresources[p_Image->getID()] = p_Image;
-    LOG_DEBUG("Inserted image (ID:", p_Image->getID(), ") into device");
+    m_Subresources[p_Resource->getID()] = p_Resource;
+    LOG_DEBUG("Inserted subresource (ID:", p_Resource->getID(), ") into device");
 }
@@ -1,5 +1,6 @@
 #include "vulkan_image.hpp"
 
+#include <algorithm>
 #include <ranges>
 #include <stdexcept>
 #include <vulkan/vk_enum_string_helper.h>
@@ -10,8 +11,8 @@
 #include "vulkan_context.hpp"
 #include "vulkan_device.hpp"
 
-VulkanImageView::VulkanImageView(const ResourceID p_Device, const VkImageView p_VkHandle)
-    : VulkanDeviceSubresource(p_Device), m_VkHandle(p_VkHandle) {}
+VulkanImageView::VulkanImageView(const ResourceID p_Device, const VkImageView p_VkHandle, const VkImageViewCreateInfo& p_CreateInfo)
+    : VulkanDeviceSubresource(p_Device), m_VkHandle(p_VkHandle), m_CreateInfo(p_CreateInfo) {}
 
 VulkanImageSampler::VulkanImageSampler(const ResourceID p_Device, const VkSampler p_VkHandle)
     : VulkanDeviceSubresource(p_Device), m_VkHandle(p_VkHandle) {}
@@ -71,6 +72,58 @@ uint32_t VulkanImage::getQueue() const
     return m_QueueFamilyIndex;
 }
 
+VkFormat VulkanImage::getFormat() const
+{
+    return m_Format;
+}
+
+uint32_t VulkanImage::getMipLevels() const
+{
+    return m_MipLevels;
+}
+
+uint32_t VulkanImage::getArrayLayers() const
+{
+    return m_ArrayLayers;
+}
+
+VkSampleCountFlagBits VulkanImage::getSamples() const
+{
+    return m_Samples;
+}
+
+VkImageUsageFlags VulkanImage::getUsage() const
+{
+    return m_Usage;
+}
+
+VkImageTiling VulkanImage::getTiling() const
+{
+    return m_Tiling;
+}
+
+VkImageCreateFlags VulkanImage::getCreateFlags() const
+{
+    return m_CreateFlags;
+}
+
+VkExtent3D VulkanImage::getMipSize(const uint32_t p_MipLevel) const
+{
+    return {std::max(1U, m_Size.width >> p_MipLevel), std::max(1U, m_Size.height >> p_MipLevel), std::max(1U, m_Size.depth >> p_MipLevel)};
+}
+
+uint32_t VulkanImage::getMaxMipLevels(const VkExtent3D p_Extent)
+{
+    uint32_t l_Largest = std::max({p_Extent.width, p_Extent.height, p_Extent.depth});
+    uint32_t l_Levels = 1;
+    while (l_Largest > 1)
+    {
+        l_Largest >>= 1;
+        l_Levels++;
+    }
+    return l_Levels;
+}
+
 void VulkanImage::setLayout(const VkImageLayout p_Layout)
 {
     m_Layout = p_Layout;
@@ -92,10 +145,10 @@ ResourceID VulkanImage::createImageView(const VkFormat p_Format, const VkImageAs
     switch (m_Type)
     {
     case VK_IMAGE_TYPE_1D:
-        l_Type = VK_IMAGE_VIEW_TYPE_1D;
+        l_Type = m_ArrayLayers > 1 ? VK_IMAGE_VIEW_TYPE_1D_ARRAY : VK_IMAGE_VIEW_TYPE_1D;
         break;
     case VK_IMAGE_TYPE_2D:
-        l_Type = VK_IMAGE_VIEW_TYPE_2D;
+        l_Type = m_ArrayLayers > 1 ? VK_IMAGE_VIEW_TYPE_2D_ARRAY : VK_IMAGE_VIEW_TYPE_2D;
         break;
     case VK_IMAGE_TYPE_3D:
         l_Type = VK_IMAGE_VIEW_TYPE_3D;
@@ -111,16 +164,16 @@ ResourceID VulkanImage::createImageView(const VkFormat p_Format, const VkImageAs
     l_CreateInfo.format = p_Format;
     l_CreateInfo.subresourceRange.aspectMask = p_AspectFlags;
     l_CreateInfo.subresourceRange.baseMipLevel = 0;
-    l_CreateInfo.subresourceRange.levelCount = 1;
+    l_CreateInfo.subresourceRange.levelCount = m_MipLevels;
     l_CreateInfo.subresourceRange.baseArrayLayer = 0;
-    l_CreateInfo.subresourceRange.layerCount = 1;
+    l_CreateInfo.subresourceRange.layerCount = m_ArrayLayers;
 
     const VulkanDevice& l_Device = VulkanContext::getDevice(getDeviceID());
 
     VkImageView l_ImageView;
     VULKAN_TRY(l_Device.getTable().vkCreateImageView(l_Device.m_VkHandle, &l_CreateInfo, nullptr, &l_ImageView));
 
-    VulkanImageView* l_ImageViewObj = ARENA_ALLOC(VulkanImageView)(getDeviceID(), l_ImageView);
+    VulkanImageView* l_ImageViewObj = ARENA_ALLOC(VulkanImageView)(getDeviceID(), l_ImageView, l_CreateInfo);
     m_ImageViews.emplace(l_ImageViewObj->getID(), l_ImageViewObj);
     Logger::print(Logger::DEBUG, "Created image view ", l_ImageViewObj->getID(), " for image ", m_ID);
     return l_ImageViewObj->getID();
@@ -206,7 +259,7 @@ ResourceID VulkanImage::createSampler(const VkFilter p_Filter, const VkSamplerAd
     l_CreateInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
     l_CreateInfo.mipLodBias = 0.0f;
     l_CreateInfo.minLod = 0.0f;
-    l_CreateInfo.maxLod = 0.0f;
+    l_CreateInfo.maxLod = static_cast<float>(m_MipLevels);
 
     const VulkanDevice& l_Device = VulkanContext::getDevice(getDeviceID());
 
@@ -244,12 +297,16 @@ void VulkanImage::freeSampler(const VulkanImageSampler& p_Sampler)
     freeSampler(p_Sampler.getID());
 }
 
-VulkanImage::VulkanImage(const ResourceID p_Device, const VkImage p_VkHandle, const VkExtent3D p_Size, const VkImageType p_Type, const VkImageLayout p_Layout)
-    : VulkanMemArray(p_Device), m_Size(p_Size), m_Type(p_Type), m_Layout(p_Layout), m_VkHandle(p_VkHandle) {}
+VulkanImage::VulkanImage(const ResourceID p_Device, const VkImage p_VkHandle, const VkExtent3D p_Size, const VkImageType p_Type, const VkImageLayout p_Layout, const VkFormat p_Format, const uint32_t p_MipLevels, const uint32_t p_ArrayLayers, const VkSampleCountFlagBits p_Samples, const VkImageUsageFlags p_Usage, const VkImageTiling p_Tiling, const VkImageCreateFlags p_CreateFlags)
+    : VulkanMemArray(p_Device), m_Size(p_Size), m_Type(p_Type), m_Layout(p_Layout), m_Format(p_Format), m_MipLevels(p_MipLevels), m_ArrayLayers(p_ArrayLayers), m_Samples(p_Samples), m_Usage(p_Usage), m_Tiling(p_Tiling), m_CreateFlags(p_CreateFlags), m_VkHandle(p_VkHandle) {}
 
 void VulkanImage::setBoundMemory(const VmaAllocation p_Allocation)
 {
     m_Allocation = p_Allocation;
+    if (m_Allocation != VK_NULL_HANDLE)
+    {
+        vmaSetAllocationUserData(*VulkanContext::getDevice(getDeviceID()).getMemoryAllocator(), m_Allocation, reinterpret_cast<void*>(static_cast<uintptr_t>(m_ID)));
+    }
 }
 
 void VulkanImage::free()
@@ -0,0 +1,249 @@
+#include "vulkan_ktx.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <stdexcept>
+#include <vulkan/vk_enum_string_helper.h>
+
+#include "vulkan_command_buffer.hpp"
+#include "vulkan_context.hpp"
+#include "vulkan_device.hpp"
+#include "utils/logger.hpp"
+#include "utils/vulkan_base.hpp"
+
+namespace
+{
+    constexpr std::array<uint8_t, 12> KTX2_IDENTIFIER = {0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A};
+
+    // Identifier, 9 header fields, DFD/KVD offsets and lengths, SGD offset and length
+    constexpr size_t KTX2_LEVEL_INDEX_OFFSET = 12 + 9 * sizeof(uint32_t) + 4 * sizeof(uint32_t) + 2 * sizeof(uint64_t);
+
+    template <typename T>
+    T readValue(const uint8_t* p_Data, const size_t p_Offset)
+    {
+        T l_Value;
+        memcpy(&l_Value, p_Data + p_Offset, sizeof(T));
+        return l_Value;
+    }
+}
+
+VulkanKTX2Loader::VulkanKTX2Loader(const ResourceID p_Device)
+    : m_Device(p_Device)
+{
+
+}
+
+bool VulkanKTX2Loader::open(const std::string_view p_Filename)
+{
+    close();
+
+    if (!m_File.open(p_Filename))
+    {
+        return false;
+    }
+
+    if (!parse(p_Filename))
+    {
+        m_File.close();
+        return false;
+    }
+
+    LOG_DEBUG("Opened KTX2 file ", p_Filename, " (", string_VkFormat(m_Format), ", ", m_Extent.width, "x", m_Extent.height, "x", m_Extent.depth, ", ", m_Levels.size(), " level(s), ", m_LayerCount, " layer(s), ", m_FaceCount, " face(s))");
+    return true;
+}
+
+void VulkanKTX2Loader::close()
+{
+    m_File.close();
+    m_Levels.clear();
+    m_Format = VK_FORMAT_UNDEFINED;
+    m_GenerateMips = false;
+}
+
+uint32_t VulkanKTX2Loader::getMipLevels() const
+{
+    return m_GenerateMips ? VulkanImage::getMaxMipLevels(m_Extent) : static_cast<uint32_t>(m_Levels.size());
+}
+
+VulkanImage::Config VulkanKTX2Loader::getImageConfig(const VkImageUsageFlags p_Usage) const
+{
+    if (!isOpen())
+    {
+        throw std::runtime_error("KTX2 loader has no open file");
+    }
+
+    VkImageUsageFlags l_Usage = p_Usage | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+    if (m_GenerateMips)
+    {
+        l_Usage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+    }
+
+    VulkanImage::Config l_Config{};
+    l_Config.type = m_Type;
+    l_Config.format = m_Format;
+    l_Config.extent = m_Extent;
+    l_Config.usage = l_Usage;
+    l_Config.flags = m_FaceCount == 6 ? VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT : 0;
+    l_Config.mipLevels = getMipLevels();
+    l_Config.arrayLayers = m_LayerCount * m_FaceCount;
+    return l_Config;
+}
+
+ResourceID VulkanKTX2Loader::createImage(const VulkanImage::MemoryPreferences& p_MemoryPreferences, const VkImageUsageFlags p_Usage) const
+{
+    return VulkanContext::getDevice(m_Device).createAndAllocateImage(p_MemoryPreferences, getImageConfig(p_Usage));
+}
+
+void VulkanKTX2Loader::upload(const VulkanCommandBuffer& p_CommandBuffer, const ResourceID p_Image, const VkImageLayout p_FinalLayout, const VkPipelineStageFlags p_DstStage, const VkAccessFlags p_DstAccess) const
+{
+    if (!isOpen())
+    {
+        throw std::runtime_error("KTX2 loader has no open file");
+    }
+
+    VulkanDevice& l_Device = VulkanContext::getDevice(m_Device);
+    if (!l_Device.isStagingBufferConfigured())
+    {
+        throw std::runtime_error("Staging buffer of device (ID:" + std::to_string(m_Device) + ") must be configured before uploading KTX2 data");
+    }
+
+    const VulkanImage& l_Image = l_Device.getImage(p_Image);
+    if (l_Image.getFormat() != m_Format || l_Image.getArrayLayers() != m_LayerCount * m_FaceCount || l_Image.getMipLevels() < m_Levels.size())
+    {
+        throw std::runtime_error("Image (ID:" + std::to_string(p_Image) + ") does not match the layout of the open KTX2 file");
+    }
+
+    // Levels are stored with the alignment Vulkan requires for buffer copies, so the whole
+    // level data range goes into staging with a single copy and keeps its relative offsets
+    uint64_t l_DataBegin = UINT64_MAX;
+    uint64_t l_DataEnd = 0;
+    for (const Level& l_Level : m_Levels)
+    {
+        l_DataBegin = std::min(l_DataBegin, l_Level.byteOffset);
+        l_DataEnd = std::max(l_DataEnd, l_Level.byteOffset + l_Level.byteLength);
+    }
+    const VkDeviceSize l_DataSize = l_DataEnd - l_DataBegin;
+
+    const uint32_t l_ImageCount = m_LayerCount * m_FaceCount;
+    TRANS_VECTOR(l_Regions, VkBufferImageCopy);
+    l_Regions.reserve(m_Levels.size() * l_ImageCount);
+    for (uint32_t i = 0; i < m_Levels.size(); i++)
+    {
+        const Level& l_Level = m_Levels[i];
+        const VkDeviceSize l_ImageSize = l_Level.byteLength / l_ImageCount;
+        for (uint32_t j = 0; j < l_ImageCount; j++)
+        {
+            VkBufferImageCopy l_Region{};
+            l_Region.bufferOffset = l_Level.byteOffset - l_DataBegin + j * l_ImageSize;
+            l_Region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            l_Region.imageSubresource.mipLevel = i;
+            l_Region.imageSubresource.baseArrayLayer = j;
+            l_Region.imageSubresource.layerCount = 1;
+            l_Region.imageExtent = l_Image.getMipSize(i);
+            l_Regions.push_back(l_Region);
+        }
+    }
+
+    if (l_Device.getStagingBufferSize() < l_DataSize)
+    {
+        LOG_DEBUG("Growing staging buffer to ", VulkanMemoryAllocator::compactBytes(l_DataSize), " to fit KTX2 data of image (ID: ", p_Image, ")");
+        l_Device.configureStagingBuffer(l_DataSize, l_Device.getStagingBufferData().queue);
+    }
+
+    void* l_StagePtr = l_Device.mapStagingBuffer(l_DataSize, 0);
+    memcpy(l_StagePtr, m_File.getData() + l_DataBegin, l_DataSize);
+    p_CommandBuffer.ecmdDumpStagingBufferToImage(p_Image, l_Regions);
+
+    if (m_GenerateMips && l_Image.getMipLevels() > 1)
+    {
+        p_CommandBuffer.ecmdGenerateMipmaps(p_Image, VK_FILTER_LINEAR, p_FinalLayout);
+        return;
+    }
+
+    VulkanMemoryBarrierBuilder l_BarrierBuilder{m_Device, VK_PIPELINE_STAGE_TRANSFER_BIT, p_DstStage, 0};
+    l_BarrierBuilder.addImageMemoryBarrier(p_Image, p_FinalLayout, VK_QUEUE_FAMILY_IGNORED, VK_ACCESS_FLAG_BITS_MAX_ENUM, p_DstAccess);
+    p_CommandBuffer.cmdPipelineBarrier(l_BarrierBuilder);
+    l_Device.getImage(p_Image).setLayout(p_FinalLayout);
+}
+
+bool VulkanKTX2Loader::parse(const std::string_view p_Filename)
+{
+    const uint8_t* l_Data = m_File.getData();
+    const size_t l_Size = m_File.getSize();
+
+    if (l_Size < KTX2_LEVEL_INDEX_OFFSET || memcmp(l_Data, KTX2_IDENTIFIER.data(), KTX2_IDENTIFIER.size()) != 0)
+    {
+        LOG_ERR("File ", p_Filename, " is not a valid KTX2 file");
+        return false;
+    }
+
+    const auto l_VkFormat = readValue<uint32_t>(l_Data, 12);
+    const auto l_PixelWidth = readValue<uint32_t>(l_Data, 20);
+    const auto l_PixelHeight = readValue<uint32_t>(l_Data, 24);
+    const auto l_PixelDepth = readValue<uint32_t>(l_Data, 28);
+    const auto l_LayerCount = readValue<uint32_t>(l_Data, 32);
+    const auto l_FaceCount = readValue<uint32_t>(l_Data, 36);
+    const auto l_LevelCount = readValue<uint32_t>(l_Data, 40);
+    const auto l_Supercompression = readValue<uint32_t>(l_Data, 44);
+
+    if (l_Supercompression != 0)
+    {
+        LOG_ERR("KTX2 file ", p_Filename, " uses supercompression scheme ", l_Supercompression, ", which is not supported");
+        return false;
+    }
+    if (l_VkFormat == VK_FORMAT_UNDEFINED)
+    {
+        LOG_ERR("KTX2 file ", p_Filename, " has no Vulkan format (Basis Universal data must be transcoded first)");
+        return false;
+    }
+    if (l_PixelWidth == 0 || (l_FaceCount != 1 && l_FaceCount != 6))
+    {
+        LOG_ERR("KTX2 file ", p_Filename, " has an invalid header");
+        return false;
+    }
+
+    const uint32_t l_StoredLevels = std::max(l_LevelCount, 1U);
+    if (l_Size < KTX2_LEVEL_INDEX_OFFSET + l_StoredLevels * sizeof(Level))
+    {
+        LOG_ERR("KTX2 file ", p_Filename, " is truncated");
+        return false;
+    }
+
+    m_Format = static_cast<VkFormat>(l_VkFormat);
+    m_Type = l_PixelDepth > 0 ? VK_IMAGE_TYPE_3D : (l_PixelHeight > 0 ? VK_IMAGE_TYPE_2D : VK_IMAGE_TYPE_1D);
+    m_Extent = {l_PixelWidth, std::max(l_PixelHeight, 1U), std::max(l_PixelDepth, 1U)};
+    m_LayerCount = std::max(l_LayerCount, 1U);
+    m_FaceCount = l_FaceCount;
+    m_GenerateMips = l_LevelCount == 0;
+
+    m_Levels.resize(l_StoredLevels);
+    for (uint32_t i = 0; i < l_StoredLevels; i++)
+    {
+        const size_t l_EntryOffset = KTX2_LEVEL_INDEX_OFFSET + i * sizeof(Level);
+        Level& l_Level = m_Levels[i];
+        l_Level.byteOffset = readValue<uint64_t>(l_Data, l_EntryOffset);
+        l_Level.byteLength = readValue<uint64_t>(l_Data, l_EntryOffset + 8);
+        l_Level.uncompressedByteLength = readValue<uint64_t>(l_Data, l_EntryOffset + 16);
+
+        if (l_Level.byteOffset + l_Level.byteLength > l_Size || l_Level.byteLength % (m_LayerCount * m_FaceCount) != 0)
+        {
+            LOG_ERR("KTX2 file ", p_Filename, " has an invalid level index entry for level ", i);
+            return false;
+        }
+    }
+
+    const VkFormatFeatureFlags l_Features = VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT | VK_FORMAT_FEATURE_TRANSFER_DST_BIT | (m_GenerateMips ? VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT : 0);
+    try
+    {
+        const std::array<VkFormat, 1> l_Candidates = {m_Format};
+        (void)VulkanContext::getDevice(m_Device).getGPU().findSupportedFormat(l_Candidates, VK_IMAGE_TILING_OPTIMAL, l_Features);
+    }
+    catch (const std::runtime_error&)
+    {
+        LOG_ERR("Format ", string_VkFormat(m_Format), " of KTX2 file ", p_Filename, " is not supported by the device");
+        return false;
+    }
+
+    return true;
+}
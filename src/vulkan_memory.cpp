@@ -1,8 +1,11 @@
 #include "vulkan_memory.hpp"
 
 #include <algorithm>
+#include <array>
+#include <map>
 #include <ranges>
 #include <stdexcept>
+#include <tuple>
 #include <vulkan/vk_enum_string_helper.h>
 #include <Volk/volk.h>
 
@@ -103,6 +106,29 @@ uint32_t MemoryStructure::getMemoryHeapCount() const
     return getMemoryProperties().memoryHeapCount;
 }
 
+MemoryStructure::HeapBudget MemoryStructure::getHeapBudget(const uint32_t p_Heap) const
+{
+    if (p_Heap >= getMemoryHeapCount())
+    {
+        throw std::out_of_range("Memory heap " + std::to_string(p_Heap) + " does not exist (heap count " + std::to_string(getMemoryHeapCount()) + ")");
+    }
+    return getHeapBudgets()[p_Heap];
+}
+
+std::vector<MemoryStructure::HeapBudget> MemoryStructure::getHeapBudgets() const
+{
+    std::array<VmaBudget, VK_MAX_MEMORY_HEAPS> l_Budgets{};
+    vmaGetHeapBudgets(m_Allocator, l_Budgets.data());
+
+    std::vector<HeapBudget> l_Result;
+    l_Result.reserve(getMemoryHeapCount());
+    for (uint32_t i = 0; i < getMemoryHeapCount(); i++)
+    {
+        l_Result.push_back({l_Budgets[i].budget, l_Budgets[i].usage, l_Budgets[i].statistics.allocationBytes, l_Budgets[i].statistics.blockBytes});
+    }
+    return l_Result;
+}
+
 MemoryStructure::MemoryStructure(const VulkanGPU p_GPU) : m_GPU(p_GPU)
 {
     vkGetPhysicalDeviceMemoryProperties(*m_GPU, &m_MemoryProperties);
@@ -130,6 +156,21 @@ bool VulkanMemoryAllocator::PoolPreferences::operator==(const PoolPreferences& p
     return l_Equal && pNextIdentifier == p_Other.pNextIdentifier;
 }
 
+size_t VulkanMemoryAllocator::PoolPreferencesHash::operator()(const PoolPreferences& p_Prefs) const
+{
+    size_t l_Hash = std::hash<uint32_t>{}(p_Prefs.memoryTypeIndex);
+    const auto l_Combine = [&l_Hash](const size_t p_Value) { l_Hash ^= p_Value + 0x9e3779b97f4a7c15ULL + (l_Hash << 6) + (l_Hash >> 2); };
+    l_Combine(std::hash<VmaPoolCreateFlags>{}(p_Prefs.flags));
+    l_Combine(std::hash<VkDeviceSize>{}(p_Prefs.blockSize));
+    l_Combine(std::hash<uint32_t>{}(p_Prefs.minBlockCount));
+    l_Combine(std::hash<uint32_t>{}(p_Prefs.maxBlockCount));
+    l_Combine(std::hash<float>{}(p_Prefs.priority));
+    l_Combine(std::hash<size_t>{}(p_Prefs.customMinAlignment));
+    // Must agree with operator==, which only looks at the identifier when a pNext chain is present
+    l_Combine(p_Prefs.pNext == nullptr ? 0 : std::hash<uint64_t>{}(p_Prefs.pNextIdentifier) + 1);
+    return l_Hash;
+}
+
 uint32_t VulkanMemoryAllocator::findMemoryType(const MemoryPreferences& p_Preferences) const
 {
     return findMemoryType(p_Preferences, UINT32_MAX);
@@ -160,7 +201,7 @@ uint32_t VulkanMemoryAllocator::findMemoryType(const MemoryPreferences& p_Prefer
     return UINT32_MAX;
 }
 
-VmaAllocation VulkanMemoryAllocator::allocateMemArray(ResourceID p_MemArray, const MemoryPreferences& p_Preferences) const
+VmaAllocation VulkanMemoryAllocator::allocateMemArray(ResourceID p_MemArray, const MemoryPreferences& p_Preferences)
 {
     VulkanDeviceSubresource* l_MemArray = VulkanContext::getDevice(m_Device).getSubresource(p_MemArray);
     if (dynamic_cast<VulkanBuffer*>(l_MemArray))
@@ -175,12 +216,13 @@ VmaAllocation VulkanMemoryAllocator::allocateMemArray(ResourceID p_MemArray, con
     return {};
 }
 
-VmaAllocation VulkanMemoryAllocator::allocateBuffer(const ResourceID p_Buffer, const MemoryPreferences& p_Preferences) const
+VmaAllocation VulkanMemoryAllocator::allocateBuffer(const ResourceID p_Buffer, const MemoryPreferences& p_Preferences)
 {
     VulkanDevice& l_Device = VulkanContext::getDevice(m_Device);
     const VulkanBuffer& l_Buffer = l_Device.getBuffer(p_Buffer);
 
-    const VkMemoryRequirements l_Reqs = l_Buffer.getMemoryRequirements();
+    const DedicatedRequirements l_Dedicated = getBufferRequirements(*l_Buffer);
+    const VkMemoryRequirements& l_Reqs = l_Dedicated.requirements;
 
     const uint32_t l_ForcedTypeIdx = p_Preferences.forceMemoryIndex;
 
@@ -197,18 +239,27 @@ VmaAllocation VulkanMemoryAllocator::allocateBuffer(const ResourceID p_Buffer, c
 
     VmaAllocation l_Alloc{};
     VmaAllocationInfo l_Info{};
-    const VmaAllocationCreateInfo l_Aci = toVmaAllocCI(p_Preferences, l_Visible);
-    VULKAN_TRY(vmaAllocateMemoryForBuffer(m_Allocator, *l_Buffer, &l_Aci, &l_Alloc, &l_Info));
+    VmaAllocationCreateInfo l_Aci = toVmaAllocCI(p_Preferences, l_Visible);
+    const bool l_UseDedicated = wantsDedicated(l_Dedicated, p_Preferences);
+    if (l_UseDedicated)
+    {
+        l_Aci.flags |= VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT;
+    }
+    VULKAN_TRY(allocateWithFallback(p_Preferences, l_Aci, l_Reqs.memoryTypeBits, [&](const VmaAllocationCreateInfo& p_Aci) { return vmaAllocateMemoryForBuffer(m_Allocator, *l_Buffer, &p_Aci, &l_Alloc, &l_Info); }));
     VULKAN_TRY(vmaBindBufferMemory(m_Allocator, l_Alloc, *l_Buffer));
+    tagAllocation(l_Alloc, p_Preferences);
+    recordDedicated(l_Alloc);
+    trackFrameResource(p_Preferences.pool, p_Buffer);
     return l_Alloc;
 }
 
-VmaAllocation VulkanMemoryAllocator::allocateImage(const ResourceID p_Image, const MemoryPreferences& p_Preferences) const
+VmaAllocation VulkanMemoryAllocator::allocateImage(const ResourceID p_Image, const MemoryPreferences& p_Preferences)
 {
     VulkanDevice& l_Device = VulkanContext::getDevice(m_Device);
     const VulkanImage& l_Image = l_Device.getImage(p_Image);
 
-    const VkMemoryRequirements l_Reqs = l_Image.getMemoryRequirements();
+    const DedicatedRequirements l_Dedicated = getImageRequirements(*l_Image);
+    const VkMemoryRequirements& l_Reqs = l_Dedicated.requirements;
 
     const uint32_t l_ForcedTypeIdx = p_Preferences.forceMemoryIndex;
     
@@ -219,35 +270,184 @@ VmaAllocation VulkanMemoryAllocator::allocateImage(const ResourceID p_Image, con
     }
     else 
     {
-        const uint32_t l_Idx = findMemoryType(l_Reqs, p_Preferences);
+        const uint32_t l_Idx = l_Device.getRequirementsCache().findMemoryType(l_Reqs, p_Preferences);
         if (l_Idx == UINT32_MAX) return {};
         l_Visible = (1u << l_Idx);
     }
     
     VmaAllocation l_Alloc{};
     VmaAllocationInfo l_Info{};
-    const VmaAllocationCreateInfo l_Aci = toVmaAllocCI(p_Preferences, l_Visible);
-    VULKAN_TRY(vmaAllocateMemoryForImage(m_Allocator, *l_Image, &l_Aci, &l_Alloc, &l_Info));
+    VmaAllocationCreateInfo l_Aci = toVmaAllocCI(p_Preferences, l_Visible);
+    const bool l_UseDedicated = wantsDedicated(l_Dedicated, p_Preferences);
+    if (l_UseDedicated)
+    {
+        l_Aci.flags |= VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT;
+    }
+    VULKAN_TRY(allocateWithFallback(p_Preferences, l_Aci, l_Reqs.memoryTypeBits, [&](const VmaAllocationCreateInfo& p_Aci) { return vmaAllocateMemoryForImage(m_Allocator, *l_Image, &p_Aci, &l_Alloc, &l_Info); }));
     VULKAN_TRY(vmaBindImageMemory(m_Allocator, l_Alloc, *l_Image));
+    tagAllocation(l_Alloc, p_Preferences);
+    recordDedicated(l_Alloc);
+    trackFrameResource(p_Preferences.pool, p_Image);
     return l_Alloc;
 }
 
+std::vector<VmaAllocation> VulkanMemoryAllocator::allocateBuffers(const std::span<const ResourceID> p_Buffers, const MemoryPreferences& p_Preferences)
+{
+    const VulkanDevice& l_Device = VulkanContext::getDevice(m_Device);
+
+    TRANS_VECTOR(l_Requirements, DedicatedRequirements);
+    l_Requirements.reserve(p_Buffers.size());
+    for (const ResourceID l_Buffer : p_Buffers)
+    {
+        l_Requirements.push_back(getBufferRequirements(*l_Device.getBuffer(l_Buffer)));
+    }
+
+    std::vector<VmaAllocation> l_Allocations = allocateBatch(l_Requirements, p_Preferences, [&](const size_t p_Index, const VmaAllocationCreateInfo& p_Aci, VmaAllocation& p_Allocation)
+    {
+        return vmaAllocateMemoryForBuffer(m_Allocator, *l_Device.getBuffer(p_Buffers[p_Index]), &p_Aci, &p_Allocation, nullptr);
+    });
+
+    TRANS_VECTOR(l_BindInfos, VkBindBufferMemoryInfo);
+    l_BindInfos.reserve(p_Buffers.size());
+    for (size_t i = 0; i < p_Buffers.size(); i++)
+    {
+        const VmaAllocationInfo l_Info = getAllocationInfo(l_Allocations[i]);
+        l_BindInfos.push_back({VK_STRUCTURE_TYPE_BIND_BUFFER_MEMORY_INFO, nullptr, *l_Device.getBuffer(p_Buffers[i]), l_Info.deviceMemory, l_Info.offset});
+    }
+    // Checked by hand, VULKAN_TRY does not throw in release and the pages would stay allocated behind an unbound resource
+    if (const VkResult l_Result = l_Device.getTable().vkBindBufferMemory2(*l_Device, static_cast<uint32_t>(l_BindInfos.size()), l_BindInfos.data()); l_Result != VK_SUCCESS)
+    {
+        deallocatePages(l_Allocations);
+        throw std::runtime_error("Failed to bind buffer memory in batch: " + std::string(string_VkResult(l_Result)));
+    }
+
+    for (const ResourceID l_Buffer : p_Buffers)
+    {
+        trackFrameResource(p_Preferences.pool, l_Buffer);
+    }
+    return l_Allocations;
+}
+
+std::vector<VmaAllocation> VulkanMemoryAllocator::allocateImages(const std::span<const ResourceID> p_Images, const MemoryPreferences& p_Preferences)
+{
+    const VulkanDevice& l_Device = VulkanContext::getDevice(m_Device);
+
+    TRANS_VECTOR(l_Requirements, DedicatedRequirements);
+    l_Requirements.reserve(p_Images.size());
+    for (const ResourceID l_Image : p_Images)
+    {
+        l_Requirements.push_back(getImageRequirements(*l_Device.getImage(l_Image)));
+    }
+
+    std::vector<VmaAllocation> l_Allocations = allocateBatch(l_Requirements, p_Preferences, [&](const size_t p_Index, const VmaAllocationCreateInfo& p_Aci, VmaAllocation& p_Allocation)
+    {
+        return vmaAllocateMemoryForImage(m_Allocator, *l_Device.getImage(p_Images[p_Index]), &p_Aci, &p_Allocation, nullptr);
+    });
+
+    TRANS_VECTOR(l_BindInfos, VkBindImageMemoryInfo);
+    l_BindInfos.reserve(p_Images.size());
+    for (size_t i = 0; i < p_Images.size(); i++)
+    {
+        const VmaAllocationInfo l_Info = getAllocationInfo(l_Allocations[i]);
+        l_BindInfos.push_back({VK_STRUCTURE_TYPE_BIND_IMAGE_MEMORY_INFO, nullptr, *l_Device.getImage(p_Images[i]), l_Info.deviceMemory, l_Info.offset});
+    }
+    // Checked by hand, VULKAN_TRY does not throw in release and the pages would stay allocated behind an unbound resource
+    if (const VkResult l_Result = l_Device.getTable().vkBindImageMemory2(*l_Device, static_cast<uint32_t>(l_BindInfos.size()), l_BindInfos.data()); l_Result != VK_SUCCESS)
+    {
+        deallocatePages(l_Allocations);
+        throw std::runtime_error("Failed to bind image memory in batch: " + std::string(string_VkResult(l_Result)));
+    }
+
+    for (const ResourceID l_Image : p_Images)
+    {
+        trackFrameResource(p_Preferences.pool, l_Image);
+    }
+    return l_Allocations;
+}
+
 uint32_t VulkanMemoryAllocator::getOrCreatePool(const PoolPreferences& p_Prefs)
 {
-    for (const PoolData& l_Pool : m_Pools)
+    if (const auto l_It = m_PoolLookup.find(p_Prefs); l_It != m_PoolLookup.end())
     {
-        if (l_Pool.prefs == p_Prefs)
-        {
-            return l_Pool.id;
-        }
+        return l_It->second;
     }
     return createPool(p_Prefs);
 }
 
 uint32_t VulkanMemoryAllocator::createPool(const PoolPreferences& p_Prefs)
 {
-    static uint32_t l_NewID = 0;
+    const uint32_t l_ID = createVmaPool(p_Prefs);
+    m_PoolLookup.try_emplace(m_Pools[l_ID].prefs, l_ID);
+    return l_ID;
+}
 
+void VulkanMemoryAllocator::createFramePools(const uint32_t p_FrameCount, const uint32_t p_MemoryTypeIndex, const VkDeviceSize p_BlockSize)
+{
+    if (!m_FramePools.empty())
+    {
+        throw std::runtime_error("Frame pools have already been created for device (ID:" + std::to_string(m_Device) + ")");
+    }
+
+    const PoolPreferences l_Prefs{
+        .memoryTypeIndex = p_MemoryTypeIndex,
+        .flags = VMA_POOL_CREATE_LINEAR_ALGORITHM_BIT,
+        .blockSize = p_BlockSize,
+        .minBlockCount = 1,
+        .maxBlockCount = 1
+    };
+
+    {
+        std::scoped_lock l_Lock(*m_FrameMutex);
+        m_FrameResources.resize(p_FrameCount);
+    }
+    for (uint32_t i = 0; i < p_FrameCount; i++)
+    {
+        const uint32_t l_ID = createVmaPool(l_Prefs);
+        m_Pools[l_ID].frameSlot = i;
+        m_FramePools.push_back(l_ID);
+    }
+    LOG_DEBUG("Created ", p_FrameCount, " frame transient pool(s) of ", compactBytes(p_BlockSize), " at memory type ", p_MemoryTypeIndex);
+}
+
+uint32_t VulkanMemoryAllocator::getFramePool(const uint32_t p_FrameIndex) const
+{
+    if (m_FramePools.empty())
+    {
+        LOG_WARN("Tried to get frame pool ", p_FrameIndex, " but no frame pools have been created");
+        return UINT32_MAX;
+    }
+    return m_FramePools[p_FrameIndex % m_FramePools.size()];
+}
+
+void VulkanMemoryAllocator::resetFramePool(const uint32_t p_FrameIndex)
+{
+    if (m_FramePools.empty())
+    {
+        return;
+    }
+
+    // Taken out under the lock, freeing goes through the device and must not hold it
+    std::vector<ResourceID> l_Resources;
+    {
+        std::scoped_lock l_Lock(*m_FrameMutex);
+        l_Resources.swap(m_FrameResources[p_FrameIndex % m_FramePools.size()]);
+    }
+
+    VulkanDevice& l_Device = VulkanContext::getDevice(m_Device);
+    uint32_t l_Count = 0;
+    for (const ResourceID l_Resource : l_Resources)
+    {
+        // Resources freed manually during the frame are skipped
+        if (l_Device.freeSubresource(l_Resource))
+        {
+            l_Count++;
+        }
+    }
+    LOG_DEBUG("Reset frame pool ", p_FrameIndex % m_FramePools.size(), ", freed ", l_Count, " transient resource(s)");
+}
+
+uint32_t VulkanMemoryAllocator::createVmaPool(const PoolPreferences& p_Prefs)
+{
     const VmaPoolCreateInfo l_Pci{
         .memoryTypeIndex = p_Prefs.memoryTypeIndex,
         .flags = p_Prefs.flags,
@@ -261,7 +461,7 @@ uint32_t VulkanMemoryAllocator::createPool(const PoolPreferences& p_Prefs)
 
     VmaPool l_Pool;
     VULKAN_TRY(vmaCreatePool(m_Allocator, &l_Pci, &l_Pool));
-    m_Pools.push_back({l_NewID++, l_Pool, p_Prefs});
+    m_Pools.push_back({static_cast<uint32_t>(m_Pools.size()), l_Pool, p_Prefs});
     m_Pools.back().prefs.pNext = m_Pools.back().prefs.pNext == nullptr ? nullptr : reinterpret_cast<void*>(UINT64_MAX);
     LOG_DEBUG("Created memory pool with ID ", m_Pools.back().id, " for memory type ", p_Prefs.memoryTypeIndex);
     return m_Pools.back().id;
@@ -279,9 +479,123 @@ void VulkanMemoryAllocator::unmap(const VmaAllocation p_Alloc) const
     vmaUnmapMemory(m_Allocator, p_Alloc);
 }
 
+void VulkanMemoryAllocator::flush(const VmaAllocation p_Alloc, const VkDeviceSize p_Offset, const VkDeviceSize p_Size) const
+{
+    VULKAN_TRY(vmaFlushAllocation(m_Allocator, p_Alloc, p_Offset, p_Size));
+}
+
 void VulkanMemoryAllocator::deallocate(const VmaAllocation p_Alloc) const
 {
+    forgetAllocation(p_Alloc);
     vmaFreeMemory(m_Allocator, p_Alloc);
+    checkBudgets();
+}
+
+void VulkanMemoryAllocator::deallocatePages(const std::span<const VmaAllocation> p_Allocations) const
+{
+    for (const VmaAllocation l_Allocation : p_Allocations)
+    {
+        forgetAllocation(l_Allocation);
+    }
+    vmaFreeMemoryPages(m_Allocator, p_Allocations.size(), p_Allocations.data());
+    checkBudgets();
+}
+
+void VulkanMemoryAllocator::forgetAllocation(const VmaAllocation p_Allocation) const
+{
+    {
+        std::scoped_lock l_Lock(*m_TagMutex);
+        m_AllocationTags.erase(p_Allocation);
+    }
+    if (std::scoped_lock l_Lock(*m_DedicatedMutex); m_DedicatedAllocations.erase(p_Allocation) > 0)
+    {
+        const VmaAllocationInfo l_Info = getAllocationInfo(p_Allocation);
+        DedicatedStats& l_Stats = m_DedicatedStats[m_MemoryStructure.getTypeData(l_Info.memoryType).heapIndex];
+        l_Stats.bytes -= l_Info.size;
+        l_Stats.allocationCount--;
+    }
+}
+
+std::optional<VulkanMemoryAllocator::AllocationTag> VulkanMemoryAllocator::getAllocationTag(const VmaAllocation p_Allocation) const
+{
+    std::scoped_lock l_Lock(*m_TagMutex);
+    const auto l_It = m_AllocationTags.find(p_Allocation);
+    return l_It != m_AllocationTags.end() ? std::optional{l_It->second} : std::nullopt;
+}
+
+static std::string escapeJson(const std::string_view p_String)
+{
+    std::string l_Result;
+    l_Result.reserve(p_String.size());
+    for (const char l_Char : p_String)
+    {
+        switch (l_Char)
+        {
+        case '"': l_Result += "\\\""; break;
+        case '\\': l_Result += "\\\\"; break;
+        case '\n': l_Result += "\\n"; break;
+        case '\t': l_Result += "\\t"; break;
+        default:
+            if (static_cast<unsigned char>(l_Char) >= 0x20)
+            {
+                l_Result += l_Char;
+            }
+        }
+    }
+    return l_Result;
+}
+
+std::string VulkanMemoryAllocator::dumpMemoryMap() const
+{
+    char* l_VmaStats = nullptr;
+    vmaBuildStatsString(m_Allocator, &l_VmaStats, VK_TRUE);
+    std::string l_Json = "{\"Allocator\": ";
+    l_Json += l_VmaStats;
+    vmaFreeStatsString(m_Allocator, l_VmaStats);
+
+    std::unordered_map<VmaAllocation, AllocationTag> l_Tags;
+    {
+        std::scoped_lock l_Lock(*m_TagMutex);
+        l_Tags = m_AllocationTags;
+    }
+
+    std::unordered_map<std::string, VkDeviceSize> l_CategoryBytes;
+    l_Json += ", \"Allocations\": [";
+    bool l_First = true;
+    for (const auto& [l_Allocation, l_Tag] : l_Tags)
+    {
+        const VmaAllocationInfo l_Info = getAllocationInfo(l_Allocation);
+        l_CategoryBytes[l_Tag.category] += l_Info.size;
+
+        l_Json += l_First ? "" : ", ";
+        l_Json += "{\"Name\": \"" + escapeJson(l_Tag.name) + "\"";
+        l_Json += ", \"Category\": \"" + escapeJson(l_Tag.category) + "\"";
+        l_Json += ", \"Resource\": " + std::to_string(reinterpret_cast<uintptr_t>(l_Info.pUserData));
+        l_Json += ", \"MemoryType\": " + std::to_string(l_Info.memoryType);
+        l_Json += ", \"Heap\": " + std::to_string(m_MemoryStructure.getTypeData(l_Info.memoryType).heapIndex);
+        l_Json += ", \"Offset\": " + std::to_string(l_Info.offset);
+        l_Json += ", \"Size\": " + std::to_string(l_Info.size) + "}";
+        l_First = false;
+    }
+
+    l_Json += "], \"Categories\": {";
+    l_First = true;
+    for (const auto& [l_Category, l_Bytes] : l_CategoryBytes)
+    {
+        l_Json += l_First ? "" : ", ";
+        l_Json += "\"" + escapeJson(l_Category) + "\": " + std::to_string(l_Bytes);
+        l_First = false;
+    }
+
+    l_Json += "}, \"DedicatedHeaps\": [";
+    std::scoped_lock l_Lock(*m_DedicatedMutex);
+    for (uint32_t i = 0; i < m_DedicatedStats.size(); i++)
+    {
+        l_Json += i == 0 ? "" : ", ";
+        l_Json += "{\"Bytes\": " + std::to_string(m_DedicatedStats[i].bytes) + ", \"Count\": " + std::to_string(m_DedicatedStats[i].allocationCount) + "}";
+    }
+    l_Json += "]}";
+    return l_Json;
 }
 
 const MemoryStructure& VulkanMemoryAllocator::getMemoryStructure() const
@@ -296,6 +610,23 @@ VmaAllocationInfo VulkanMemoryAllocator::getAllocationInfo(const VmaAllocation p
     return l_Info;
 }
 
+void VulkanMemoryAllocator::setBudgetThresholds(const std::span<const float> p_Thresholds)
+{
+    {
+        std::scoped_lock l_Lock(*m_BudgetMutex);
+        m_BudgetThresholds.assign(p_Thresholds.begin(), p_Thresholds.end());
+        std::ranges::sort(m_BudgetThresholds);
+        m_HeapThresholdLevels.assign(m_MemoryStructure.getMemoryHeapCount(), 0);
+    }
+    checkBudgets();
+}
+
+void VulkanMemoryAllocator::updateBudgets(const uint32_t p_FrameIndex)
+{
+    vmaSetCurrentFrameIndex(m_Allocator, p_FrameIndex);
+    checkBudgets();
+}
+
 VulkanMemoryAllocator::VulkanMemoryAllocator(const VulkanDevice& p_Device)
     : m_MemoryStructure(p_Device.getGPU()), m_Device(p_Device.getID())
 {
@@ -310,28 +641,56 @@ VulkanMemoryAllocator::VulkanMemoryAllocator(const VulkanDevice& p_Device)
     l_AllocInfo.vulkanApiVersion = VK_HEADER_VERSION_COMPLETE;
     l_AllocInfo.pVulkanFunctions = &l_Funcs;
 
+    if (p_Device.isExtensionEnabled(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME))
+    {
+        l_AllocInfo.flags |= VMA_ALLOCATOR_CREATE_EXT_MEMORY_BUDGET_BIT;
+        m_MemoryStructure.m_HasBudgetExtension = true;
+    }
+
     VULKAN_TRY(vmaCreateAllocator(&l_AllocInfo, &m_Allocator));
+    m_MemoryStructure.m_Allocator = m_Allocator;
+    m_DedicatedStats.resize(m_MemoryStructure.getMemoryHeapCount());
 }
 
 VulkanMemoryAllocator::AllocationReturn VulkanMemoryAllocator::createBuffer(const VkBufferCreateInfo& p_Info, const MemoryPreferences& p_Preferences) const
 {
-    const VmaAllocationCreateInfo l_Aci = toVmaAllocCI(p_Preferences, 0);
+    VmaAllocationCreateInfo l_Aci = toVmaAllocCI(p_Preferences, 0);
+    const bool l_OverThreshold = p_Preferences.pool == UINT32_MAX && m_DedicatedThreshold != 0 && p_Info.size >= m_DedicatedThreshold;
+    if (l_OverThreshold)
+    {
+        l_Aci.flags |= VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT;
+    }
     VkBuffer l_Buffer;
     VmaAllocation l_Alloc;
     VmaAllocationInfo l_Info;
-    VULKAN_TRY(vmaCreateBuffer(m_Allocator, &p_Info, &l_Aci, &l_Buffer, &l_Alloc, &l_Info));
-    LOG_DEBUG("Created buffer with size ", VulkanMemoryAllocator::compactBytes(l_Info.size), " at memory type ", l_Info.memoryType, " with offset ", l_Info.offset, ". Handle ", reinterpret_cast<void*>(l_Alloc));
+    VULKAN_TRY(allocateWithFallback(p_Preferences, l_Aci, UINT32_MAX, [&](const VmaAllocationCreateInfo& p_Aci) { return vmaCreateBuffer(m_Allocator, &p_Info, &p_Aci, &l_Buffer, &l_Alloc, &l_Info); }));
+    tagAllocation(l_Alloc, p_Preferences);
+    // VMA follows the driver's dedicated preference on its own, it only needs to be recorded
+    recordDedicated(l_Alloc);
+    LOG_DEBUG("Created buffer with size ", VulkanMemoryAllocator::compactBytes(l_Info.size), " at memory type ", l_Info.memoryType, " with offset ", l_Info.offset, ". Handle ", reinterpret_cast<void*>(l_Alloc), ", tag ", getAllocationTag(l_Alloc)->category, "/", p_Preferences.name);
     return { reinterpret_cast<uintptr_t>(l_Buffer), l_Alloc };
 }
 
 VulkanMemoryAllocator::AllocationReturn VulkanMemoryAllocator::createImage(const VkImageCreateInfo& p_Info, const MemoryPreferences& p_Preferences) const
 {
-    const VmaAllocationCreateInfo l_Aci = toVmaAllocCI(p_Preferences, 0);
+    VmaAllocationCreateInfo l_Aci = toVmaAllocCI(p_Preferences, 0);
+    bool l_OverThreshold = false;
+    if (p_Preferences.pool == UINT32_MAX && m_DedicatedThreshold != 0)
+    {
+        const VulkanImage::Config l_Config{p_Info.imageType, p_Info.format, p_Info.extent, p_Info.usage, p_Info.flags, p_Info.tiling, p_Info.mipLevels, p_Info.arrayLayers, p_Info.samples};
+        l_OverThreshold = VulkanContext::getDevice(m_Device).getRequirementsCache().getImageRequirements(l_Config).size >= m_DedicatedThreshold;
+    }
+    if (l_OverThreshold)
+    {
+        l_Aci.flags |= VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT;
+    }
     VkImage l_Image;
     VmaAllocation l_Alloc;
     VmaAllocationInfo l_Info;
-    VULKAN_TRY(vmaCreateImage(m_Allocator, &p_Info, &l_Aci, &l_Image, &l_Alloc, &l_Info));
-    LOG_DEBUG("Created image with size ", VulkanMemoryAllocator::compactBytes(l_Info.size), " at memory type ", l_Info.memoryType, " with offset ", l_Info.offset, ". Handle ", reinterpret_cast<void*>(l_Alloc));
+    VULKAN_TRY(allocateWithFallback(p_Preferences, l_Aci, UINT32_MAX, [&](const VmaAllocationCreateInfo& p_Aci) { return vmaCreateImage(m_Allocator, &p_Info, &p_Aci, &l_Image, &l_Alloc, &l_Info); }));
+    tagAllocation(l_Alloc, p_Preferences);
+    recordDedicated(l_Alloc);
+    LOG_DEBUG("Created image with size ", VulkanMemoryAllocator::compactBytes(l_Info.size), " at memory type ", l_Info.memoryType, " with offset ", l_Info.offset, ". Handle ", reinterpret_cast<void*>(l_Alloc), ", tag ", getAllocationTag(l_Alloc)->category, "/", p_Preferences.name);
     return { reinterpret_cast<uintptr_t>(l_Image), l_Alloc };
 }
 
@@ -342,7 +701,7 @@ VmaAllocationCreateInfo VulkanMemoryAllocator::toVmaAllocCI(const MemoryPreferen
     l_Aci.requiredFlags = p_Preferences.desiredProperties;
     l_Aci.preferredFlags = p_Preferences.preferredProperties;
     l_Aci.memoryTypeBits = p_MemoryTypeBits;
-    l_Aci.pool = p_Preferences.pool < m_Pools.size() ? getPool(p_Preferences.pool) : VK_NULL_HANDLE;
+    l_Aci.pool = p_Preferences.pool != UINT32_MAX ? getPool(p_Preferences.pool) : VK_NULL_HANDLE;
     l_Aci.flags = p_Preferences.vmaFlags;
 
     if (VulkanContext::getDevice(m_Device).isExtensionEnabled(VK_EXT_MEMORY_PRIORITY_EXTENSION_NAME))
@@ -351,15 +710,257 @@ VmaAllocationCreateInfo VulkanMemoryAllocator::toVmaAllocCI(const MemoryPreferen
     return l_Aci;
 }
 
-VmaPool VulkanMemoryAllocator::getPool(const uint32_t p_Id) const
+VkResult VulkanMemoryAllocator::allocateWithFallback(const MemoryPreferences& p_Preferences, VmaAllocationCreateInfo p_Aci, const uint32_t p_CompatibleTypeBits, const std::function<VkResult(const VmaAllocationCreateInfo&)>& p_Allocate) const
+{
+    if (!p_Preferences.critical)
+    {
+        p_Aci.flags |= VMA_ALLOCATION_CREATE_WITHIN_BUDGET_BIT;
+    }
+
+    VkResult l_Result = p_Allocate(p_Aci);
+    if (l_Result == VK_ERROR_OUT_OF_DEVICE_MEMORY && !p_Preferences.critical)
+    {
+        uint32_t l_HostTypes = 0;
+        for (const uint32_t l_Type : m_MemoryStructure.getMemoryTypes(VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT, p_CompatibleTypeBits))
+        {
+            l_HostTypes |= 1u << l_Type;
+        }
+
+        // Export pools carry the external memory pNext, leaving them would silently produce a non-exportable allocation
+        const bool l_FromExportPool = p_Aci.pool != VK_NULL_HANDLE && std::ranges::any_of(m_Pools, [&](const PoolData& p_Pool) { return p_Pool.pool == p_Aci.pool && p_Pool.prefs.pNext != nullptr; });
+        if (l_HostTypes != 0 && !l_FromExportPool)
+        {
+            // The usage stays as the caller set it, vmaAllocateMemoryFor* and vmaAllocateMemoryPages reject the AUTO usages
+            VmaAllocationCreateInfo l_Fallback = p_Aci;
+            l_Fallback.flags &= ~VMA_ALLOCATION_CREATE_WITHIN_BUDGET_BIT;
+            l_Fallback.requiredFlags = (l_Fallback.requiredFlags & ~VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT) | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+            l_Fallback.preferredFlags = (l_Fallback.preferredFlags & ~VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT) | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+            l_Fallback.memoryTypeBits = l_HostTypes;
+            l_Fallback.pool = VK_NULL_HANDLE;
+
+            LOG_WARN("Device memory budget exhausted, placing non-critical allocation in host-visible memory");
+            l_Result = p_Allocate(l_Fallback);
+        }
+    }
+
+    if (l_Result == VK_SUCCESS)
+    {
+        checkBudgets();
+    }
+    return l_Result;
+}
+
+std::vector<VmaAllocation> VulkanMemoryAllocator::allocateBatch(const std::span<const DedicatedRequirements> p_Requirements, const MemoryPreferences& p_Preferences, const std::function<VkResult(size_t, const VmaAllocationCreateInfo&, VmaAllocation&)>& p_AllocateDedicated) const
 {
-    for (const PoolData& l_Pool : m_Pools)
+    const uint32_t l_ForcedMask = p_Preferences.forceMemoryIndex != UINT32_MAX ? 1u << p_Preferences.forceMemoryIndex : UINT32_MAX;
+    for (const DedicatedRequirements& l_Requirements : p_Requirements)
     {
-        if (l_Pool.id == p_Id)
+        if ((l_Requirements.requirements.memoryTypeBits & l_ForcedMask) == 0)
         {
-            return l_Pool.pool;
+            throw std::runtime_error("Tried to allocate resources in batch: forced memory type " + std::to_string(p_Preferences.forceMemoryIndex) + " is not compatible with memory type bits " + std::to_string(l_Requirements.requirements.memoryTypeBits));
         }
     }
+
+    std::vector<VmaAllocation> l_Allocations(p_Requirements.size(), VK_NULL_HANDLE);
+
+    // Bucket by the full requirements so every bucket is one vmaAllocateMemoryPages call.
+    // Dedicated resources are allocated one by one so the driver gets the resource handle
+    std::map<std::tuple<uint32_t, VkDeviceSize, VkDeviceSize>, std::vector<size_t>> l_Buckets;
+
+    // A failed allocation must not leave the earlier ones behind, the caller never sees a partially filled vector
+    try
+    {
+        for (size_t i = 0; i < p_Requirements.size(); i++)
+        {
+            const VkMemoryRequirements& l_Reqs = p_Requirements[i].requirements;
+            if (!wantsDedicated(p_Requirements[i], p_Preferences))
+            {
+                l_Buckets[{l_Reqs.memoryTypeBits, l_Reqs.size, l_Reqs.alignment}].push_back(i);
+                continue;
+            }
+
+            VmaAllocationCreateInfo l_Aci = toVmaAllocCI(p_Preferences, l_Reqs.memoryTypeBits & l_ForcedMask);
+            l_Aci.flags |= VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT;
+            VULKAN_TRY(allocateWithFallback(p_Preferences, l_Aci, l_Reqs.memoryTypeBits, [&](const VmaAllocationCreateInfo& p_Aci) { return p_AllocateDedicated(i, p_Aci, l_Allocations[i]); }));
+            tagAllocation(l_Allocations[i], p_Preferences);
+            recordDedicated(l_Allocations[i]);
+        }
+
+        TRANS_VECTOR(l_Pages, VmaAllocation);
+        for (const auto& [l_Key, l_Indices] : l_Buckets)
+        {
+            const auto& [l_TypeBits, l_Size, l_Alignment] = l_Key;
+            const VkMemoryRequirements l_Reqs{l_Size, l_Alignment, l_TypeBits & l_ForcedMask};
+            l_Pages.assign(l_Indices.size(), VK_NULL_HANDLE);
+            const VmaAllocationCreateInfo l_Aci = toVmaAllocCI(p_Preferences, l_Reqs.memoryTypeBits);
+            VULKAN_TRY(allocateWithFallback(p_Preferences, l_Aci, l_TypeBits, [&](const VmaAllocationCreateInfo& p_Aci) { return vmaAllocateMemoryPages(m_Allocator, &l_Reqs, &p_Aci, l_Pages.size(), l_Pages.data(), nullptr); }));
+
+            for (size_t i = 0; i < l_Indices.size(); i++)
+            {
+                l_Allocations[l_Indices[i]] = l_Pages[i];
+                tagAllocation(l_Pages[i], p_Preferences);
+            }
+        }
+    }
+    catch (...)
+    {
+        for (const VmaAllocation l_Allocation : l_Allocations)
+        {
+            if (l_Allocation != VK_NULL_HANDLE)
+            {
+                deallocate(l_Allocation);
+            }
+        }
+        throw;
+    }
+
+    LOG_DEBUG("Allocated ", p_Requirements.size(), " resource(s) in ", l_Buckets.size(), " batch(es)");
+    return l_Allocations;
+}
+
+VulkanMemoryAllocator::DedicatedStats VulkanMemoryAllocator::getDedicatedStats(const uint32_t p_Heap) const
+{
+    std::scoped_lock l_Lock(*m_DedicatedMutex);
+    return p_Heap < m_DedicatedStats.size() ? m_DedicatedStats[p_Heap] : DedicatedStats{};
+}
+
+VulkanMemoryAllocator::DedicatedRequirements VulkanMemoryAllocator::getBufferRequirements(const VkBuffer p_Buffer) const
+{
+    const VulkanDevice& l_Device = VulkanContext::getDevice(m_Device);
+
+    VkBufferMemoryRequirementsInfo2 l_Info{};
+    l_Info.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_REQUIREMENTS_INFO_2;
+    l_Info.buffer = p_Buffer;
+    VkMemoryDedicatedRequirements l_Dedicated{};
+    l_Dedicated.sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_REQUIREMENTS;
+    VkMemoryRequirements2 l_Requirements{};
+    l_Requirements.sType = VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2;
+    l_Requirements.pNext = &l_Dedicated;
+    l_Device.getTable().vkGetBufferMemoryRequirements2(*l_Device, &l_Info, &l_Requirements);
+
+    return {l_Requirements.memoryRequirements, l_Dedicated.requiresDedicatedAllocation == VK_TRUE, l_Dedicated.prefersDedicatedAllocation == VK_TRUE};
+}
+
+VulkanMemoryAllocator::DedicatedRequirements VulkanMemoryAllocator::getImageRequirements(const VkImage p_Image) const
+{
+    const VulkanDevice& l_Device = VulkanContext::getDevice(m_Device);
+
+    VkImageMemoryRequirementsInfo2 l_Info{};
+    l_Info.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_REQUIREMENTS_INFO_2;
+    l_Info.image = p_Image;
+    VkMemoryDedicatedRequirements l_Dedicated{};
+    l_Dedicated.sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_REQUIREMENTS;
+    VkMemoryRequirements2 l_Requirements{};
+    l_Requirements.sType = VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2;
+    l_Requirements.pNext = &l_Dedicated;
+    l_Device.getTable().vkGetImageMemoryRequirements2(*l_Device, &l_Info, &l_Requirements);
+
+    return {l_Requirements.memoryRequirements, l_Dedicated.requiresDedicatedAllocation == VK_TRUE, l_Dedicated.prefersDedicatedAllocation == VK_TRUE};
+}
+
+bool VulkanMemoryAllocator::wantsDedicated(const DedicatedRequirements& p_Requirements, const MemoryPreferences& p_Preferences) const
+{
+    if (p_Requirements.requiresDedicated)
+    {
+        return true;
+    }
+    // Custom pools own their block layout, only a hard driver requirement gets a dedicated allocation. It is still
+    // made from the pool so it keeps the pool's memory type and export pNext
+    if (p_Preferences.pool != UINT32_MAX)
+    {
+        return false;
+    }
+    return p_Requirements.prefersDedicated || (m_DedicatedThreshold != 0 && p_Requirements.requirements.size >= m_DedicatedThreshold);
+}
+
+void VulkanMemoryAllocator::recordDedicated(const VmaAllocation p_Allocation) const
+{
+    // VMA decides on its own whether the driver's preference is honored, so ask it what it actually did
+    VmaAllocationInfo2 l_Info2{};
+    vmaGetAllocationInfo2(m_Allocator, p_Allocation, &l_Info2);
+    if (l_Info2.dedicatedMemory == VK_FALSE)
+    {
+        return;
+    }
+
+    std::scoped_lock l_Lock(*m_DedicatedMutex);
+    if (!m_DedicatedAllocations.insert(p_Allocation).second)
+    {
+        return;
+    }
+    const VmaAllocationInfo& l_Info = l_Info2.allocationInfo;
+    DedicatedStats& l_Stats = m_DedicatedStats[m_MemoryStructure.getTypeData(l_Info.memoryType).heapIndex];
+    l_Stats.bytes += l_Info.size;
+    l_Stats.allocationCount++;
+}
+
+void VulkanMemoryAllocator::checkBudgets() const
+{
+    if (m_BudgetSignal.isEmpty())
+    {
+        return;
+    }
+
+    // Events are emitted once the lock is released, listeners are free to allocate or free memory
+    std::vector<BudgetEvent> l_Events;
+    {
+        std::scoped_lock l_Lock(*m_BudgetMutex);
+        if (m_BudgetThresholds.empty())
+        {
+            return;
+        }
+
+        const std::vector<MemoryStructure::HeapBudget> l_Budgets = m_MemoryStructure.getHeapBudgets();
+        for (uint32_t i = 0; i < l_Budgets.size(); i++)
+        {
+            const float l_Ratio = l_Budgets[i].getUsageRatio();
+            const uint32_t l_Level = static_cast<uint32_t>(std::ranges::upper_bound(m_BudgetThresholds, l_Ratio) - m_BudgetThresholds.begin());
+            const uint32_t l_PrevLevel = m_HeapThresholdLevels[i];
+            if (l_Level == l_PrevLevel)
+            {
+                continue;
+            }
+
+            m_HeapThresholdLevels[i] = l_Level;
+            const bool l_Rising = l_Level > l_PrevLevel;
+            const float l_Threshold = l_Rising ? m_BudgetThresholds[l_Level - 1] : m_BudgetThresholds[l_Level];
+            LOG_DEBUG("Memory heap ", i, " usage ", l_Rising ? "rose above " : "fell below ", l_Threshold * 100.0f, "% of budget (", compactBytes(l_Budgets[i].usage), " / ", compactBytes(l_Budgets[i].budget), ")");
+            l_Events.push_back({i, l_Threshold, l_Rising, l_Budgets[i]});
+        }
+    }
+
+    for (const BudgetEvent& l_Event : l_Events)
+    {
+        m_BudgetSignal.emit(l_Event);
+    }
+}
+
+VmaPool VulkanMemoryAllocator::getPool(const uint32_t p_Id) const
+{
+    if (p_Id < m_Pools.size())
+    {
+        return m_Pools[p_Id].pool;
+    }
     LOG_WARN("Tried to get memory pool with ID ", p_Id, " but it doesn't exist");
     return VK_NULL_HANDLE;
 }
+
+void VulkanMemoryAllocator::trackFrameResource(const uint32_t p_Pool, const ResourceID p_Resource)
+{
+    if (p_Pool < m_Pools.size() && m_Pools[p_Pool].frameSlot != UINT32_MAX)
+    {
+        std::scoped_lock l_Lock(*m_FrameMutex);
+        m_FrameResources[m_Pools[p_Pool].frameSlot].push_back(p_Resource);
+    }
+}
+
+void VulkanMemoryAllocator::tagAllocation(const VmaAllocation p_Allocation, const MemoryPreferences& p_Preferences) const
+{
+    AllocationTag l_Tag{std::string(p_Preferences.name), std::string(p_Preferences.category.empty() ? "untagged" : p_Preferences.category)};
+
+    // The VMA name shows up in the detailed map, the user data slot is already taken by the owning resource ID
+    const std::string l_VmaName = l_Tag.category + "/" + l_Tag.name;
+    vmaSetAllocationName(m_Allocator, p_Allocation, l_VmaName.c_str());
+    std::scoped_lock l_Lock(*m_TagMutex);
+    m_AllocationTags[p_Allocation] = std::move(l_Tag);
+}
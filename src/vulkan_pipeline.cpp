@@ -1,6 +1,7 @@
 #include "vulkan_pipeline.hpp"
 
 #include <array>
+#include <utility>
 
 #include "vulkan_context.hpp"
 #include "vulkan_device.hpp"
@@ -81,6 +82,49 @@ void VulkanPipelineBuilder::addVertexBinding(const VulkanBinding& p_Binding, boo
     m_VertexInputState.pVertexAttributeDescriptions = m_VertexInputAttributes.data();
 }
 
+VulkanPipelineBuilder::VulkanPipelineBuilder(const VulkanPipelineBuilder& p_Other)
+    : m_VertexInputState(p_Other.m_VertexInputState), m_InputAssemblyState(p_Other.m_InputAssemblyState), m_TessellationState(p_Other.m_TessellationState),
+      m_ViewportState(p_Other.m_ViewportState), m_RasterizationState(p_Other.m_RasterizationState), m_MultisampleState(p_Other.m_MultisampleState),
+      m_DepthStencilState(p_Other.m_DepthStencilState), m_ColorBlendState(p_Other.m_ColorBlendState), m_DynamicState(p_Other.m_DynamicState),
+      m_TesellationStateEnabled(p_Other.m_TesellationStateEnabled), m_ShaderStages(p_Other.m_ShaderStages), m_VertexInputBindings(p_Other.m_VertexInputBindings),
+      m_VertexInputAttributes(p_Other.m_VertexInputAttributes), m_CurrentVertexAttrLocation(p_Other.m_CurrentVertexAttrLocation), m_Viewports(p_Other.m_Viewports),
+      m_Scissors(p_Other.m_Scissors), m_Attachments(p_Other.m_Attachments), m_DynamicStates(p_Other.m_DynamicStates), m_Device(p_Other.m_Device)
+{
+    // States set from user structs keep pointing at the user's data
+    if (p_Other.m_VertexInputState.pVertexBindingDescriptions == p_Other.m_VertexInputBindings.data())
+    {
+        m_VertexInputState.pVertexBindingDescriptions = m_VertexInputBindings.data();
+    }
+    if (p_Other.m_VertexInputState.pVertexAttributeDescriptions == p_Other.m_VertexInputAttributes.data())
+    {
+        m_VertexInputState.pVertexAttributeDescriptions = m_VertexInputAttributes.data();
+    }
+    if (p_Other.m_ViewportState.pViewports == p_Other.m_Viewports.data())
+    {
+        m_ViewportState.pViewports = m_Viewports.data();
+    }
+    if (p_Other.m_ViewportState.pScissors == p_Other.m_Scissors.data())
+    {
+        m_ViewportState.pScissors = m_Scissors.data();
+    }
+    if (p_Other.m_ColorBlendState.pAttachments == p_Other.m_Attachments.data())
+    {
+        m_ColorBlendState.pAttachments = m_Attachments.data();
+    }
+    if (p_Other.m_DynamicState.pDynamicStates == p_Other.m_DynamicStates.data())
+    {
+        m_DynamicState.pDynamicStates = m_DynamicStates.data();
+    }
+}
+
+VulkanPipelineBuilder& VulkanPipelineBuilder::operator=(const VulkanPipelineBuilder& p_Other)
+{
+    // Copy and swap, so new state only has to be handled in the copy constructor
+    VulkanPipelineBuilder l_Copy{p_Other};
+    std::swap(*this, l_Copy);
+    return *this;
+}
+
 void VulkanPipelineBuilder::setInputAssemblyState(const VkPrimitiveTopology p_Topology, const VkBool32 p_PrimitiveRestartEnable)
 {
     m_InputAssemblyState.topology = p_Topology;
@@ -154,9 +198,19 @@ void VulkanPipelineBuilder::setDynamicState(const std::span<VkDynamicState> p_Dy
     m_DynamicState.pDynamicStates = m_DynamicStates.data();
 }
 
-void VulkanPipelineBuilder::addShaderStage(const ResourceID p_Shader, const std::string_view p_Entrypoint)
+VkSpecializationInfo VulkanSpecialization::getInfo() const
 {
-    m_ShaderStages.emplace_back(p_Shader, p_Entrypoint);
+    VkSpecializationInfo l_Info{};
+    l_Info.mapEntryCount = static_cast<uint32_t>(entries.size());
+    l_Info.pMapEntries = entries.data();
+    l_Info.dataSize = data.size();
+    l_Info.pData = data.data();
+    return l_Info;
+}
+
+void VulkanPipelineBuilder::addShaderStage(const ResourceID p_Shader, const std::string_view p_Entrypoint, const VulkanSpecialization& p_Specialization)
+{
+    m_ShaderStages.emplace_back(p_Shader, p_Entrypoint, p_Specialization);
 }
 
 void VulkanPipelineBuilder::resetShaderStages()
@@ -234,7 +288,7 @@ void VulkanPipeline::free()
     }
 }
 
-void VulkanPipelineBuilder::createShaderStages(VkPipelineShaderStageCreateInfo p_Container[]) const
+void VulkanPipelineBuilder::createShaderStages(VkPipelineShaderStageCreateInfo p_Container[], VkSpecializationInfo p_Specializations[]) const
 {
     for (size_t i = 0; i < m_ShaderStages.size(); i++)
     {
@@ -244,6 +298,11 @@ void VulkanPipelineBuilder::createShaderStages(VkPipelineShaderStageCreateInfo p
         l_StageInfo.stage = l_Shader.m_Stage;
         l_StageInfo.module = l_Shader.m_VkHandle;
         l_StageInfo.pName = m_ShaderStages[i].entrypoint.c_str();
+        if (!m_ShaderStages[i].specialization.empty())
+        {
+            p_Specializations[i] = m_ShaderStages[i].specialization.getInfo();
+            l_StageInfo.pSpecializationInfo = &p_Specializations[i];
+        }
         p_Container[i] = l_StageInfo;
     }
 }
@@ -288,8 +347,8 @@ void VulkanPipelineLayout::free()
     }
 }
 
-VulkanPipelineLayout::VulkanPipelineLayout(const uint32_t p_Device, const VkPipelineLayout p_Handle)
-    : VulkanDeviceSubresource(p_Device), m_VkHandle(p_Handle) {}
+VulkanPipelineLayout::VulkanPipelineLayout(const uint32_t p_Device, const VkPipelineLayout p_Handle, const std::span<const ResourceID> p_DescriptorSetLayouts)
+    : VulkanDeviceSubresource(p_Device), m_VkHandle(p_Handle), m_DescriptorSetLayouts(p_DescriptorSetLayouts.begin(), p_DescriptorSetLayouts.end()) {}
 
 void VulkanComputePipeline::free()
 {
@@ -0,0 +1,237 @@
+#include "vulkan_requirements_cache.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <mutex>
+#include <vulkan/vk_enum_string_helper.h>
+
+#include "vulkan_context.hpp"
+#include "vulkan_device.hpp"
+#include "utils/allocators.hpp"
+#include "utils/logger.hpp"
+#include "utils/vulkan_base.hpp"
+
+static void hashCombine(size_t& p_Hash, const size_t p_Value)
+{
+    p_Hash ^= p_Value + 0x9e3779b97f4a7c15ULL + (p_Hash << 6) + (p_Hash >> 2);
+}
+
+bool VulkanMemoryRequirementsCache::ImageKey::operator==(const ImageKey& p_Other) const
+{
+    return type == p_Other.type && format == p_Other.format
+        && extent.width == p_Other.extent.width && extent.height == p_Other.extent.height && extent.depth == p_Other.extent.depth
+        && mipLevels == p_Other.mipLevels && arrayLayers == p_Other.arrayLayers && samples == p_Other.samples
+        && tiling == p_Other.tiling && usage == p_Other.usage && flags == p_Other.flags;
+}
+
+size_t VulkanMemoryRequirementsCache::KeyHash::operator()(const BufferKey& p_Key) const
+{
+    size_t l_Hash = std::hash<uint32_t>{}(p_Key.usage);
+    hashCombine(l_Hash, std::hash<uint32_t>{}(p_Key.flags));
+    hashCombine(l_Hash, std::hash<VkDeviceSize>{}(p_Key.sizeClass));
+    return l_Hash;
+}
+
+size_t VulkanMemoryRequirementsCache::KeyHash::operator()(const ImageKey& p_Key) const
+{
+    size_t l_Hash = std::hash<uint32_t>{}(p_Key.type);
+    hashCombine(l_Hash, std::hash<uint32_t>{}(p_Key.format));
+    hashCombine(l_Hash, std::hash<uint32_t>{}(p_Key.extent.width));
+    hashCombine(l_Hash, std::hash<uint32_t>{}(p_Key.extent.height));
+    hashCombine(l_Hash, std::hash<uint32_t>{}(p_Key.extent.depth));
+    hashCombine(l_Hash, std::hash<uint32_t>{}(p_Key.mipLevels));
+    hashCombine(l_Hash, std::hash<uint32_t>{}(p_Key.arrayLayers));
+    hashCombine(l_Hash, std::hash<uint32_t>{}(p_Key.samples));
+    hashCombine(l_Hash, std::hash<uint32_t>{}(p_Key.tiling));
+    hashCombine(l_Hash, std::hash<uint32_t>{}(p_Key.usage));
+    hashCombine(l_Hash, std::hash<uint32_t>{}(p_Key.flags));
+    return l_Hash;
+}
+
+size_t VulkanMemoryRequirementsCache::KeyHash::operator()(const MemoryTypeKey& p_Key) const
+{
+    size_t l_Hash = std::hash<uint32_t>{}(p_Key.memoryTypeBits);
+    hashCombine(l_Hash, std::hash<uint32_t>{}(p_Key.usage));
+    hashCombine(l_Hash, std::hash<uint32_t>{}(p_Key.vmaFlags));
+    hashCombine(l_Hash, std::hash<uint32_t>{}(p_Key.desiredProperties));
+    hashCombine(l_Hash, std::hash<uint32_t>{}(p_Key.preferredProperties));
+    hashCombine(l_Hash, std::hash<uint32_t>{}(p_Key.forceMemoryIndex));
+    return l_Hash;
+}
+
+VulkanMemoryRequirementsCache::VulkanMemoryRequirementsCache(const ResourceID p_Device)
+    : m_Device(p_Device)
+{
+}
+
+VkMemoryRequirements VulkanMemoryRequirementsCache::getBufferRequirements(const VulkanBuffer::Config& p_Config, const VkBufferCreateFlags p_Flags) const
+{
+    const BufferKey l_Key{p_Config.usage, p_Flags, std::bit_ceil(std::max<VkDeviceSize>(p_Config.size, 1))};
+
+    VkMemoryRequirements l_Requirements;
+    {
+        std::shared_lock l_Lock(m_Mutex);
+        const auto l_It = m_BufferRequirements.find(l_Key);
+        if (l_It != m_BufferRequirements.end())
+        {
+            l_Requirements = l_It->second;
+            l_Requirements.size = alignUp(p_Config.size, l_Requirements.alignment);
+            return l_Requirements;
+        }
+    }
+
+    VkBufferCreateInfo l_Info{};
+    l_Info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    l_Info.size = l_Key.sizeClass;
+    l_Info.usage = l_Key.usage;
+    l_Info.flags = l_Key.flags;
+    l_Info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    l_Requirements = queryBufferRequirements(l_Info);
+    {
+        std::unique_lock l_Lock(m_Mutex);
+        m_BufferRequirements.try_emplace(l_Key, l_Requirements);
+    }
+
+    l_Requirements.size = alignUp(p_Config.size, l_Requirements.alignment);
+    return l_Requirements;
+}
+
+VkMemoryRequirements VulkanMemoryRequirementsCache::getImageRequirements(const VulkanImage::Config& p_Config) const
+{
+    const ImageKey l_Key{p_Config.type, p_Config.format, p_Config.extent, p_Config.mipLevels, p_Config.arrayLayers, p_Config.samples, p_Config.tiling, p_Config.usage, p_Config.flags};
+    {
+        std::shared_lock l_Lock(m_Mutex);
+        const auto l_It = m_ImageRequirements.find(l_Key);
+        if (l_It != m_ImageRequirements.end())
+        {
+            return l_It->second;
+        }
+    }
+
+    VkImageCreateInfo l_Info{};
+    l_Info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    l_Info.imageType = p_Config.type;
+    l_Info.format = p_Config.format;
+    l_Info.extent = p_Config.extent;
+    l_Info.mipLevels = p_Config.mipLevels;
+    l_Info.arrayLayers = p_Config.arrayLayers;
+    l_Info.samples = p_Config.samples;
+    l_Info.tiling = p_Config.tiling;
+    l_Info.usage = p_Config.usage;
+    l_Info.flags = p_Config.flags;
+    l_Info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    l_Info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    const VkMemoryRequirements l_Requirements = queryImageRequirements(l_Info);
+
+    std::unique_lock l_Lock(m_Mutex);
+    m_ImageRequirements.try_emplace(l_Key, l_Requirements);
+    return l_Requirements;
+}
+
+uint32_t VulkanMemoryRequirementsCache::findMemoryType(const VkMemoryRequirements& p_Requirements, const VulkanMemoryAllocator::MemoryPreferences& p_Preferences) const
+{
+    const MemoryTypeKey l_Key{p_Requirements.memoryTypeBits, p_Preferences.usage, p_Preferences.vmaFlags, p_Preferences.desiredProperties, p_Preferences.preferredProperties, p_Preferences.forceMemoryIndex};
+    {
+        std::shared_lock l_Lock(m_Mutex);
+        const auto l_It = m_MemoryTypes.find(l_Key);
+        if (l_It != m_MemoryTypes.end())
+        {
+            return l_It->second;
+        }
+    }
+
+    const uint32_t l_Type = VulkanContext::getDevice(m_Device).getMemoryAllocator().findMemoryType(p_Requirements, p_Preferences);
+
+    std::unique_lock l_Lock(m_Mutex);
+    m_MemoryTypes.try_emplace(l_Key, l_Type);
+    return l_Type;
+}
+
+void VulkanMemoryRequirementsCache::clear()
+{
+    std::unique_lock l_Lock(m_Mutex);
+    m_BufferRequirements.clear();
+    m_ImageRequirements.clear();
+    m_MemoryTypes.clear();
+}
+
+size_t VulkanMemoryRequirementsCache::getEntryCount() const
+{
+    std::shared_lock l_Lock(m_Mutex);
+    return m_BufferRequirements.size() + m_ImageRequirements.size() + m_MemoryTypes.size();
+}
+
+VkMemoryRequirements VulkanMemoryRequirementsCache::queryBufferRequirements(const VkBufferCreateInfo& p_Info) const
+{
+    const VulkanDevice& l_Device = VulkanContext::getDevice(m_Device);
+    const VolkDeviceTable& l_Table = l_Device.getTable();
+
+    VkDeviceBufferMemoryRequirements l_Query{};
+    l_Query.sType = VK_STRUCTURE_TYPE_DEVICE_BUFFER_MEMORY_REQUIREMENTS;
+    l_Query.pCreateInfo = &p_Info;
+    VkMemoryRequirements2 l_Requirements{};
+    l_Requirements.sType = VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2;
+
+    switch (getQueryPath(l_Device))
+    {
+    case QueryPath::CORE:
+        l_Table.vkGetDeviceBufferMemoryRequirements(*l_Device, &l_Query, &l_Requirements);
+        return l_Requirements.memoryRequirements;
+    case QueryPath::EXTENSION:
+        l_Table.vkGetDeviceBufferMemoryRequirementsKHR(*l_Device, &l_Query, &l_Requirements);
+        return l_Requirements.memoryRequirements;
+    case QueryPath::PROBE:
+        break;
+    }
+
+    // Without maintenance4 a probe object is the only way, it is still paid once per key
+    VkBuffer l_Probe;
+    VULKAN_TRY(l_Table.vkCreateBuffer(*l_Device, &p_Info, nullptr, &l_Probe));
+    l_Table.vkGetBufferMemoryRequirements(*l_Device, l_Probe, &l_Requirements.memoryRequirements);
+    l_Table.vkDestroyBuffer(*l_Device, l_Probe, nullptr);
+    return l_Requirements.memoryRequirements;
+}
+
+VkMemoryRequirements VulkanMemoryRequirementsCache::queryImageRequirements(const VkImageCreateInfo& p_Info) const
+{
+    const VulkanDevice& l_Device = VulkanContext::getDevice(m_Device);
+    const VolkDeviceTable& l_Table = l_Device.getTable();
+
+    VkDeviceImageMemoryRequirements l_Query{};
+    l_Query.sType = VK_STRUCTURE_TYPE_DEVICE_IMAGE_MEMORY_REQUIREMENTS;
+    l_Query.pCreateInfo = &p_Info;
+    VkMemoryRequirements2 l_Requirements{};
+    l_Requirements.sType = VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2;
+
+    switch (getQueryPath(l_Device))
+    {
+    case QueryPath::CORE:
+        l_Table.vkGetDeviceImageMemoryRequirements(*l_Device, &l_Query, &l_Requirements);
+        return l_Requirements.memoryRequirements;
+    case QueryPath::EXTENSION:
+        l_Table.vkGetDeviceImageMemoryRequirementsKHR(*l_Device, &l_Query, &l_Requirements);
+        return l_Requirements.memoryRequirements;
+    case QueryPath::PROBE:
+        break;
+    }
+
+    VkImage l_Probe;
+    VULKAN_TRY(l_Table.vkCreateImage(*l_Device, &p_Info, nullptr, &l_Probe));
+    l_Table.vkGetImageMemoryRequirements(*l_Device, l_Probe, &l_Requirements.memoryRequirements);
+    l_Table.vkDestroyImage(*l_Device, l_Probe, nullptr);
+    return l_Requirements.memoryRequirements;
+}
+
+VulkanMemoryRequirementsCache::QueryPath VulkanMemoryRequirementsCache::getQueryPath(const VulkanDevice& p_Device)
+{
+    // Volk loads every entry point the driver exposes, a non-null pointer does not mean the device enabled it
+    if (std::min(VulkanContext::getApiVersion(), p_Device.getGPU().getProperties().apiVersion) >= VK_API_VERSION_1_3)
+    {
+        return QueryPath::CORE;
+    }
+    if (p_Device.isExtensionEnabled(VK_KHR_MAINTENANCE_4_EXTENSION_NAME))
+    {
+        return QueryPath::EXTENSION;
+    }
+    return QueryPath::PROBE;
+}
@@ -1,5 +1,9 @@
 #include "vulkan_shader.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
 #include <filesystem>
 #include <fstream>
 #include <stdexcept>
@@ -7,8 +11,10 @@
 
 #include "vulkan_context.hpp"
 #include "vulkan_device.hpp"
+#include "vulkan_shader_session_pool.hpp"
 #include "utils/call_on_destroy.hpp"
 #include "utils/logger.hpp"
+#include "utils/shader_reflection.hpp"
 
 void printBlob(slang::IBlob* p_Blob)
 {
@@ -19,6 +25,49 @@ void printBlob(slang::IBlob* p_Blob)
     }
 }
 
+static double getElapsedMilliseconds(const std::chrono::steady_clock::time_point p_Start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - p_Start).count();
+}
+
+// Hands module IR owned by the shader cache to Slang without copying it
+class ModuleIRBlob final : public ISlangBlob
+{
+public:
+    explicit ModuleIRBlob(std::shared_ptr<const std::vector<uint8_t>> p_Data) : m_Data(std::move(p_Data)) {}
+
+    SLANG_NO_THROW SlangResult SLANG_MCALL queryInterface(const SlangUUID& p_Guid, void** p_Interface) override
+    {
+        if (p_Guid == ISlangBlob::getTypeGuid() || p_Guid == ISlangUnknown::getTypeGuid())
+        {
+            addRef();
+            *p_Interface = static_cast<ISlangBlob*>(this);
+            return SLANG_OK;
+        }
+        *p_Interface = nullptr;
+        return SLANG_E_NO_INTERFACE;
+    }
+
+    SLANG_NO_THROW uint32_t SLANG_MCALL addRef() override { return ++m_RefCount; }
+
+    SLANG_NO_THROW uint32_t SLANG_MCALL release() override
+    {
+        const uint32_t l_Count = --m_RefCount;
+        if (l_Count == 0)
+        {
+            delete this;
+        }
+        return l_Count;
+    }
+
+    SLANG_NO_THROW const void* SLANG_MCALL getBufferPointer() override { return m_Data->data(); }
+    SLANG_NO_THROW size_t SLANG_MCALL getBufferSize() override { return m_Data->size(); }
+
+private:
+    std::shared_ptr<const std::vector<uint8_t>> m_Data;
+    std::atomic<uint32_t> m_RefCount = 1;
+};
+
 void VulkanShader::reset(VulkanShader& p_Shader)
 {
     p_Shader.~VulkanShader();
@@ -31,11 +80,58 @@ void VulkanShader::reinit(VulkanShader& p_Shader, const ThreadID p_CompilationTh
     new(&p_Shader) VulkanShader{p_CompilationThread, p_Optimize, p_Macros};
 }
 
+void VulkanShader::enableDiskCache(const std::string_view p_Directory, const uint64_t p_MaxBytes)
+{
+    s_DiskCache = std::make_unique<VulkanShaderCache>(p_Directory, p_MaxBytes);
+    LOG_DEBUG("Enabled shader disk cache at ", p_Directory, " with a limit of ", p_MaxBytes, " bytes");
+}
+
+void VulkanShader::disableDiskCache()
+{
+    s_DiskCache.reset();
+}
+
+VulkanShader::ProfileReport VulkanShader::getProfileReport()
+{
+    std::scoped_lock l_Lock(s_ProfileMutex);
+    return s_ProfileReport;
+}
+
+void VulkanShader::resetProfileReport()
+{
+    std::scoped_lock l_Lock(s_ProfileMutex);
+    s_ProfileReport = {};
+}
+
+void VulkanShader::logProfileReport(const uint32_t p_TopModules)
+{
+    const ProfileReport l_Report = getProfileReport();
+    LOG_INFO("Shader profile: ", l_Report.shaders, " shader(s), ", l_Report.cacheHits, " cache hit(s), ", l_Report.cacheMisses, " cache miss(es), ", l_Report.spirvBytes, " bytes of SPIR-V");
+    LOG_INFO("  Sessions: ", l_Report.sessions, " in ", l_Report.sessionMilliseconds, "ms");
+    LOG_INFO("  Module loads: ", l_Report.moduleMilliseconds, "ms, linking: ", l_Report.linkMilliseconds, "ms, code generation: ", l_Report.codegenMilliseconds, "ms");
+
+    std::vector<std::pair<std::string_view, ProfileReport::ModuleTotals>> l_Modules{l_Report.modules.begin(), l_Report.modules.end()};
+    std::ranges::sort(l_Modules, [](const auto& p_A, const auto& p_B) { return p_A.second.milliseconds > p_B.second.milliseconds; });
+    for (size_t i = 0; i < std::min<size_t>(p_TopModules, l_Modules.size()); i++)
+    {
+        const auto& [l_Name, l_Totals] = l_Modules[i];
+        LOG_INFO("  ", l_Name, ": ", l_Totals.milliseconds, "ms over ", l_Totals.loads, " load(s), ", l_Totals.cachedLoads, " from cached IR");
+    }
+}
+
+VulkanShader::VulkanShader() = default;
+
 VulkanShader::VulkanShader(const ThreadID p_CompilationThread, const bool p_Optimize, const std::span<const MacroDef> p_Macros)
     : m_CompilationThread(p_CompilationThread), m_Optimize(p_Optimize), m_Macros(p_Macros.begin(), p_Macros.end()) {}
 
 VulkanShader::~VulkanShader()
 {
+    for (slang::IBlob* l_Blob : m_CodeBlobs)
+    {
+        l_Blob->release();
+    }
+    m_CodeBlobs.clear();
+
     if (m_SlangProgram)
     {
         m_SlangProgram->release();
@@ -46,18 +142,37 @@ VulkanShader::~VulkanShader()
     {
         m_SlangSession->release();
         m_SlangSession = nullptr;
+        VulkanShaderSessionPool::releaseSession(m_GlobalSession);
+        m_GlobalSession = nullptr;
     }
 }
 
 VulkanShader::VulkanShader(VulkanShader&& p_Other) noexcept
 {
+    m_GlobalSession = p_Other.m_GlobalSession;
+    p_Other.m_GlobalSession = nullptr;
     m_SlangSession = p_Other.m_SlangSession;
     p_Other.m_SlangSession = nullptr;
     m_SlangProgram = p_Other.m_SlangProgram;
     p_Other.m_SlangProgram = nullptr;
     m_SlangComponents = std::move(p_Other.m_SlangComponents);
     m_Result = p_Other.m_Result;
+    m_CompilationThread = p_Other.m_CompilationThread;
+    m_Optimize = p_Other.m_Optimize;
     m_Macros = std::move(p_Other.m_Macros);
+    m_SearchPaths = std::move(p_Other.m_SearchPaths);
+    m_PendingModules = std::move(p_Other.m_PendingModules);
+    m_SourceHash = p_Other.m_SourceHash;
+    // Moving the vectors keeps their storage, so the views and the name index stay valid
+    m_EntryPoints = std::move(p_Other.m_EntryPoints);
+    m_CodeBlobs = std::move(p_Other.m_CodeBlobs);
+    m_CachedEntryPoints = std::move(p_Other.m_CachedEntryPoints);
+    m_StageIndex = p_Other.m_StageIndex;
+    m_NameIndex = std::move(p_Other.m_NameIndex);
+    m_FromCache = p_Other.m_FromCache;
+    m_LoadedModules = std::move(p_Other.m_LoadedModules);
+    m_Reflection = std::move(p_Other.m_Reflection);
+    m_Stats = std::move(p_Other.m_Stats);
 }
 
 void VulkanShader::loadModule(const std::string_view p_Filename, const std::string_view p_ModuleName)
@@ -82,26 +197,71 @@ void VulkanShader::loadModule(const std::string_view p_Filename, const std::stri
     l_Stream << l_File.rdbuf();
     l_File.close();
 
-    loadModuleString(l_Stream.str(), p_ModuleName);
+    loadModuleSource(l_Stream.str(), p_ModuleName, std::filesystem::path{p_Filename}.parent_path());
 }
 
 void VulkanShader::loadModuleString(const std::string_view p_Source, const std::string_view p_ModuleName)
 {
-    if (!m_SlangSession)
+    loadModuleSource(p_Source, p_ModuleName, {});
+}
+
+void VulkanShader::loadModuleSource(const std::string_view p_Source, const std::string_view p_ModuleName, const std::filesystem::path& p_BaseDir)
+{
+    if (m_Result.status == Result::FAILED)
     {
-        buildSession();
+        return;
     }
 
-    slang::IBlob* l_DiagnosticsBlob = nullptr;
-    slang::IModule* l_Module = m_SlangSession->loadModuleFromSourceString(p_ModuleName.data(), p_ModuleName.data(), p_Source.data(), &l_DiagnosticsBlob);
-    printBlob(l_DiagnosticsBlob);
+    // With the disk cache the session is only created once linking misses the cache
+    if (s_DiskCache)
+    {
+        m_SourceHash = VulkanShaderCache::hash(p_ModuleName, m_SourceHash);
+        m_SourceHash = VulkanShaderCache::hashModuleSource(p_Source, p_BaseDir, m_SearchPaths, m_SourceHash);
+        m_PendingModules.push_back({std::string{p_Source}, std::string{p_ModuleName}, p_BaseDir});
+        return;
+    }
+
+    addModuleToSession(p_Source, p_ModuleName, p_BaseDir);
+}
+
+bool VulkanShader::addModuleToSession(const std::string_view p_Source, const std::string_view p_ModuleName, const std::filesystem::path& p_BaseDir)
+{
+    if (!m_SlangSession && !buildSession())
+    {
+        return false;
+    }
+
+    // With the disk cache every module comes from its serialized IR when possible, so only linking and codegen are left
+    slang::IModule* l_Module = nullptr;
+    uint64_t l_ModuleKey = 0;
+    if (s_DiskCache)
+    {
+        preloadImports(p_Source, p_BaseDir);
+        l_ModuleKey = hashSessionOptions(VulkanShaderCache::hashModuleSource(p_Source, p_BaseDir, m_SearchPaths, VulkanShaderCache::hash(p_ModuleName)));
+        l_Module = loadCachedModule(l_ModuleKey, std::string{p_ModuleName}, std::string{p_ModuleName});
+    }
 
     if (!l_Module)
     {
-        m_Result.error = "Failed to load shader module: " + std::string(p_ModuleName);
-        m_Result.status = Result::FAILED;
-        return;
+        slang::IBlob* l_DiagnosticsBlob = nullptr;
+        const auto l_Start = std::chrono::steady_clock::now();
+        l_Module = m_SlangSession->loadModuleFromSourceString(p_ModuleName.data(), p_ModuleName.data(), p_Source.data(), &l_DiagnosticsBlob);
+        recordModuleLoad(p_ModuleName, getElapsedMilliseconds(l_Start), false);
+        printBlob(l_DiagnosticsBlob);
+
+        if (!l_Module)
+        {
+            m_Result.error = "Failed to load shader module: " + std::string(p_ModuleName);
+            m_Result.status = Result::FAILED;
+            return false;
+        }
+
+        if (s_DiskCache)
+        {
+            storeModuleIR(l_Module, l_ModuleKey);
+        }
     }
+    m_LoadedModules.insert(std::string{p_ModuleName});
 
     m_SlangComponents.push_back(l_Module);
 
@@ -112,10 +272,78 @@ void VulkanShader::loadModuleString(const std::string_view p_Source, const std::
         {
             m_Result.error = "Failed to get entry point by index: " + std::to_string(i);
             m_Result.status = Result::FAILED;
-            return;
+            return false;
         }
         m_SlangComponents.push_back(l_EntryPoint);
     }
+    return true;
+}
+
+void VulkanShader::preloadImports(const std::string_view p_Source, const std::filesystem::path& p_BaseDir)
+{
+    for (const VulkanShaderCache::ImportedModule& l_Import : VulkanShaderCache::collectImports(p_Source, p_BaseDir, m_SearchPaths))
+    {
+        if (!m_LoadedModules.insert(l_Import.name).second)
+        {
+            continue;
+        }
+
+        const uint64_t l_Key = hashSessionOptions(VulkanShaderCache::hash(l_Import.name, l_Import.sourceHash));
+        if (loadCachedModule(l_Key, l_Import.name, l_Import.path.string()))
+        {
+            continue;
+        }
+
+        // Loading it here instead of through the import statement gives us the module to serialize. On failure the
+        // import reports the error when the importing module is parsed
+        slang::IBlob* l_DiagnosticsBlob = nullptr;
+        const auto l_Start = std::chrono::steady_clock::now();
+        slang::IModule* l_Module = m_SlangSession->loadModule(l_Import.name.c_str(), &l_DiagnosticsBlob);
+        recordModuleLoad(l_Import.name, getElapsedMilliseconds(l_Start), false);
+        printBlob(l_DiagnosticsBlob);
+        if (l_Module)
+        {
+            storeModuleIR(l_Module, l_Key);
+        }
+    }
+}
+
+slang::IModule* VulkanShader::loadCachedModule(const uint64_t p_Key, const std::string& p_ModuleName, const std::string& p_Path)
+{
+    const std::shared_ptr<const std::vector<uint8_t>> l_Data = s_DiskCache->loadModule(p_Key);
+    if (!l_Data)
+    {
+        return nullptr;
+    }
+
+    ModuleIRBlob* l_Blob = new ModuleIRBlob{l_Data};
+    slang::IBlob* l_DiagnosticsBlob = nullptr;
+    const auto l_Start = std::chrono::steady_clock::now();
+    slang::IModule* l_Module = m_SlangSession->loadModuleFromIRBlob(p_ModuleName.c_str(), p_Path.c_str(), l_Blob, &l_DiagnosticsBlob);
+    const double l_Milliseconds = getElapsedMilliseconds(l_Start);
+    l_Blob->release();
+    printBlob(l_DiagnosticsBlob);
+
+    if (!l_Module)
+    {
+        LOG_WARN("Failed to deserialize cached module ", p_ModuleName, ", parsing it from source");
+        return nullptr;
+    }
+    recordModuleLoad(p_ModuleName, l_Milliseconds, true);
+    LOG_DEBUG("Loaded module ", p_ModuleName, " from its cached IR");
+    return l_Module;
+}
+
+void VulkanShader::storeModuleIR(slang::IModule* p_Module, const uint64_t p_Key)
+{
+    slang::IBlob* l_Blob = nullptr;
+    if (SLANG_FAILED(p_Module->serialize(&l_Blob)) || !l_Blob)
+    {
+        LOG_WARN("Failed to serialize module ", p_Module->getName());
+        return;
+    }
+    s_DiskCache->storeModule(p_Key, {static_cast<const uint8_t*>(l_Blob->getBufferPointer()), l_Blob->getBufferSize()});
+    l_Blob->release();
 }
 
 void VulkanShader::linkAndFinalize()
@@ -125,67 +353,139 @@ void VulkanShader::linkAndFinalize()
         return;
     }
 
+    if (!s_DiskCache)
+    {
+        recordCacheResult(Stats::CACHE_DISABLED);
+        if (buildProgram())
+        {
+            extractEntryPoints();
+        }
+        return;
+    }
+
+    const uint64_t l_Key = computeCacheKey();
+    if (s_DiskCache->load(l_Key, m_CachedEntryPoints))
+    {
+        LOG_DEBUG("Loaded ", m_CachedEntryPoints.size(), " entry points from shader cache");
+        for (const VulkanShaderCache::EntryPoint& l_EntryPoint : m_CachedEntryPoints)
+        {
+            m_EntryPoints.push_back({l_EntryPoint.name, l_EntryPoint.stage, l_EntryPoint.spirv});
+            m_Stats.spirvBytes += l_EntryPoint.spirv.size() * sizeof(uint32_t);
+        }
+        recordCacheResult(Stats::CACHE_HIT);
+        buildEntryPointIndex();
+        m_FromCache = true;
+        m_Result.status = Result::COMPILED;
+        return;
+    }
+
+    recordCacheResult(Stats::CACHE_MISS);
+
+    if (buildProgram() && extractEntryPoints())
+    {
+        s_DiskCache->store(l_Key, m_EntryPoints);
+    }
+}
+
+bool VulkanShader::buildProgram()
+{
+    for (const PendingModule& l_Module : m_PendingModules)
+    {
+        if (!addModuleToSession(l_Module.source, l_Module.name, l_Module.baseDir))
+        {
+            m_SlangComponents.clear();
+            return false;
+        }
+    }
+
     slang::IBlob* l_DiagnosticsBlob = nullptr;
-    if (SLANG_FAILED(m_SlangSession->createCompositeComponentType(m_SlangComponents.data(), m_SlangComponents.size(), &m_SlangProgram, &l_DiagnosticsBlob)))
+    const auto l_Start = std::chrono::steady_clock::now();
+    const SlangResult l_LinkResult = m_SlangSession->createCompositeComponentType(m_SlangComponents.data(), m_SlangComponents.size(), &m_SlangProgram, &l_DiagnosticsBlob);
+    recordLink(getElapsedMilliseconds(l_Start));
+    if (SLANG_FAILED(l_LinkResult))
     {
         printBlob(l_DiagnosticsBlob);
+        m_SlangComponents.clear();
         m_Result.error = "Failed to link shader modules";
         m_Result.status = Result::FAILED;
+        return false;
     }
 
     m_SlangComponents.clear();
+    m_PendingModules.clear();
     m_Result.status = Result::COMPILED;
+    return true;
 }
 
-std::vector<uint32_t> VulkanShader::getSPIRVForStage(const VkShaderStageFlagBits p_Stage)
+bool VulkanShader::extractEntryPoints()
 {
-    if (m_Result.status != Result::COMPILED)
-    {
-        m_Result.error = "Shader compilation not finished";
-        m_Result.status = Result::FAILED;
-        return {};
-    }
-
-    uint32_t l_EntryPointIndex = UINT32_MAX;
     slang::IBlob* l_DiagnosticsBlob = nullptr;
     slang::ProgramLayout* l_Layout = m_SlangProgram->getLayout(0, &l_DiagnosticsBlob);
     printBlob(l_DiagnosticsBlob);
 
-    const SlangStage l_SlangStage = getSlangStageFromVkStage(p_Stage);
+    // The blobs stay alive with the shader so every lookup afterwards is just a view into them
+    m_EntryPoints.reserve(l_Layout->getEntryPointCount());
+    m_CodeBlobs.reserve(l_Layout->getEntryPointCount());
     for (uint32_t i = 0; i < l_Layout->getEntryPointCount(); i++)
     {
         slang::EntryPointLayout* l_EntryPoint = l_Layout->getEntryPointByIndex(i);
-        if (l_EntryPoint->getStage() == l_SlangStage)
+
+        slang::IBlob* l_EntryPointBlob = nullptr;
+        const auto l_Start = std::chrono::steady_clock::now();
+        const SlangResult l_CodeResult = m_SlangProgram->getEntryPointCode(i, 0, &l_EntryPointBlob, &l_DiagnosticsBlob);
+        const double l_Milliseconds = getElapsedMilliseconds(l_Start);
+        if (SLANG_FAILED(l_CodeResult))
         {
-            l_EntryPointIndex = i;
-            break;
+            printBlob(l_DiagnosticsBlob);
+            m_Result.error = "Failed to get SPIR-V for shader entry point: " + std::string(l_EntryPoint->getName());
+            m_Result.status = Result::FAILED;
+            return false;
         }
-    }
-    if (l_EntryPointIndex == UINT32_MAX)
-    {
-        m_Result.error = "Failed to find entry point for shader stage: " + std::to_string(p_Stage);
-        m_Result.status = Result::FAILED;
-        return {};
+        m_CodeBlobs.push_back(l_EntryPointBlob);
+
+        const std::span<const uint32_t> l_Code{static_cast<const uint32_t*>(l_EntryPointBlob->getBufferPointer()), l_EntryPointBlob->getBufferSize() / sizeof(uint32_t)};
+        m_EntryPoints.push_back({l_EntryPoint->getName(), getVkStageFromSlangStage(l_EntryPoint->getStage()), l_Code});
+        recordEntryPoint(m_EntryPoints.back().name, m_EntryPoints.back().stage, l_Milliseconds, l_EntryPointBlob->getBufferSize());
     }
 
-    slang::IBlob* l_EntryPointBlob = nullptr;
-    if (SLANG_FAILED(m_SlangProgram->getEntryPointCode(l_EntryPointIndex, 0, &l_EntryPointBlob, &l_DiagnosticsBlob)))
+    buildEntryPointIndex();
+    return true;
+}
+
+void VulkanShader::buildEntryPointIndex()
+{
+    m_StageIndex.fill(UINT32_MAX);
+    m_NameIndex.clear();
+    for (uint32_t i = 0; i < m_EntryPoints.size(); i++)
     {
-        printBlob(l_DiagnosticsBlob);
-        m_Result.error = "Failed to get SPIR-V for shader stage: " + std::to_string(p_Stage);
-        m_Result.status = Result::FAILED;
-        return {};
+        // The first entry point of a stage wins, same as the old linear search
+        uint32_t& l_StageSlot = m_StageIndex[std::countr_zero(static_cast<uint32_t>(m_EntryPoints[i].stage))];
+        if (l_StageSlot == UINT32_MAX)
+        {
+            l_StageSlot = i;
+        }
+        m_NameIndex.try_emplace(m_EntryPoints[i].name, i);
     }
+}
 
-    std::vector<uint32_t> l_SPIRV;
-    l_SPIRV.resize(l_EntryPointBlob->getBufferSize() / sizeof(uint32_t));
-    memcpy(l_SPIRV.data(), l_EntryPointBlob->getBufferPointer(), l_EntryPointBlob->getBufferSize());
-    l_EntryPointBlob->release();
+uint64_t VulkanShader::computeCacheKey() const
+{
+    return hashSessionOptions(m_SourceHash);
+}
 
-    return l_SPIRV;
+uint64_t VulkanShader::hashSessionOptions(const uint64_t p_Seed) const
+{
+    uint64_t l_Key = p_Seed;
+    for (const MacroDef& l_Macro : m_Macros)
+    {
+        l_Key = VulkanShaderCache::hash(l_Macro.name + "=" + l_Macro.value + ";", l_Key);
+    }
+    l_Key = VulkanShaderCache::hash(&m_Optimize, sizeof(m_Optimize), l_Key);
+    l_Key = VulkanShaderCache::hash(std::string_view{SPIRV_PROFILE}, l_Key);
+    return VulkanShaderCache::hash(std::string_view{spGetBuildTagString()}, l_Key);
 }
 
-std::vector<uint32_t> VulkanShader::getSPIRVFromName(const std::string_view p_Name)
+std::span<const uint32_t> VulkanShader::getSPIRVForStage(const VkShaderStageFlagBits p_Stage)
 {
     if (m_Result.status != Result::COMPILED)
     {
@@ -194,36 +494,35 @@ std::vector<uint32_t> VulkanShader::getSPIRVFromName(const std::string_view p_Na
         return {};
     }
 
-    uint32_t l_EntryPointIndex = 0;
-    slang::IBlob* l_DiagnosticsBlob = nullptr;
-    slang::ProgramLayout* l_Layout = m_SlangProgram->getLayout(0, &l_DiagnosticsBlob);
-    printBlob(l_DiagnosticsBlob);
+    const uint32_t l_Index = m_StageIndex[std::countr_zero(static_cast<uint32_t>(p_Stage))];
+    if (l_Index == UINT32_MAX)
+    {
+        m_Result.error = "Failed to find entry point for shader stage: " + std::to_string(p_Stage);
+        m_Result.status = Result::FAILED;
+        return {};
+    }
+    return m_EntryPoints[l_Index].spirv;
+}
 
-    for (uint32_t i = 0; i < l_Layout->getEntryPointCount(); i++)
+std::span<const uint32_t> VulkanShader::getSPIRVFromName(const std::string_view p_Name)
+{
+    if (m_Result.status != Result::COMPILED)
     {
-        slang::EntryPointLayout* l_EntryPoint = l_Layout->getEntryPointByIndex(i);
-        if (l_EntryPoint->getName() == p_Name)
-        {
-            l_EntryPointIndex = i;
-            break;
-        }
+        m_Result.error = "Shader compilation not finished";
+        m_Result.status = Result::FAILED;
+        return {};
     }
 
-    slang::IBlob* l_EntryPointBlob = nullptr;
-    if (SLANG_FAILED(m_SlangProgram->getEntryPointCode(l_EntryPointIndex, 0, &l_EntryPointBlob, &l_DiagnosticsBlob)))
+    if (m_EntryPoints.empty())
     {
-        printBlob(l_DiagnosticsBlob);
         m_Result.error = "Failed to get SPIR-V for shader entry point: " + std::string(p_Name);
         m_Result.status = Result::FAILED;
         return {};
     }
 
-    std::vector<uint32_t> l_SPIRV;
-    l_SPIRV.resize(l_EntryPointBlob->getBufferSize() / sizeof(uint32_t));
-    memcpy(l_SPIRV.data(), l_EntryPointBlob->getBufferPointer(), l_EntryPointBlob->getBufferSize());
-    l_EntryPointBlob->release();
-
-    return l_SPIRV;
+    // An unknown name resolves to the first entry point
+    const auto l_It = m_NameIndex.find(p_Name);
+    return m_EntryPoints[l_It != m_NameIndex.end() ? l_It->second : 0].spirv;
 }
 
 VkShaderModule VulkanShaderModule::operator*() const
@@ -231,16 +530,58 @@ VkShaderModule VulkanShaderModule::operator*() const
     return m_VkHandle;
 }
 
-slang::ProgramLayout* VulkanShader::getLayout() const
+slang::ProgramLayout* VulkanShader::getLayout()
 {
     if (m_Result.status != Result::COMPILED)
     {
         throw std::runtime_error("Could not obtain shader layout, compilation not finished");
     }
 
+    if (!m_SlangProgram)
+    {
+        LOG_DEBUG("Building Slang program for reflection of cached shader");
+        if (!buildProgram())
+        {
+            throw std::runtime_error("Could not obtain shader layout, failed to build cached shader: " + m_Result.error);
+        }
+    }
+
     return m_SlangProgram->getLayout(0, nullptr);
 }
 
+const ShaderReflectionData& VulkanShader::getReflection()
+{
+    if (m_Reflection)
+    {
+        return *m_Reflection;
+    }
+
+    if (m_Result.status != Result::COMPILED)
+    {
+        throw std::runtime_error("Could not obtain shader reflection, compilation not finished");
+    }
+
+    m_Reflection = std::make_unique<ShaderReflectionData>();
+    if (s_DiskCache)
+    {
+        std::vector<uint8_t> l_Data;
+        if (s_DiskCache->loadReflection(computeCacheKey(), l_Data) && m_Reflection->deserialize(l_Data))
+        {
+            LOG_DEBUG("Loaded shader reflection from cache");
+            return *m_Reflection;
+        }
+    }
+
+    *m_Reflection = ShaderReflectionData{getLayout()};
+    if (s_DiskCache)
+    {
+        std::string l_Data;
+        m_Reflection->serialize(l_Data);
+        s_DiskCache->storeReflection(computeCacheKey(), {reinterpret_cast<const uint8_t*>(l_Data.data()), l_Data.size()});
+    }
+    return *m_Reflection;
+}
+
 SlangStage VulkanShader::getSlangStageFromVkStage(const VkShaderStageFlagBits p_Stage)
 {
     switch (p_Stage)
@@ -287,23 +628,23 @@ VkShaderStageFlagBits VulkanShader::getVkStageFromSlangStage(const SlangStage p_
 
 bool VulkanShader::buildSession()
 {
-    if (!s_SlangSessions.contains(m_CompilationThread))
+    const auto l_Start = std::chrono::steady_clock::now();
+
+    // Leases stay with the thread ID, so every shader compiled on this thread reuses the same global session
+    slang::IGlobalSession* l_GlobalSession = VulkanShaderSessionPool::acquire(m_CompilationThread);
+    if (!l_GlobalSession)
     {
-        slang::IGlobalSession* l_SlangGlobalSession = nullptr;
-        if (SLANG_FAILED(slang::createGlobalSession(&l_SlangGlobalSession)))
-        {
-            m_Result.error = "Failed to create Slang global session";
-            m_Result.status = Result::FAILED;
-            return false;
-        }
-        s_SlangSessions[m_CompilationThread] = l_SlangGlobalSession;
+        m_Result.error = "Failed to create Slang global session";
+        m_Result.status = Result::FAILED;
+        return false;
     }
+    std::unique_lock l_GlobalSessionLock = VulkanShaderSessionPool::lockGlobalSession();
 
     slang::SessionDesc l_SessionDesc = {};
 
     slang::TargetDesc l_TargetDesc = {};
     l_TargetDesc.format = SLANG_SPIRV;
-    l_TargetDesc.profile = s_SlangSessions[m_CompilationThread]->findProfile("spirv_1_5");
+    l_TargetDesc.profile = l_GlobalSession->findProfile(SPIRV_PROFILE);
 
     l_SessionDesc.targetCount = 1;
     l_SessionDesc.targets = &l_TargetDesc;
@@ -339,15 +680,76 @@ bool VulkanShader::buildSession()
     l_SessionDesc.preprocessorMacroCount = static_cast<uint32_t>(l_Macros.size());
     l_SessionDesc.preprocessorMacros = l_Macros.data();
 
-    if (SLANG_FAILED(s_SlangSessions[m_CompilationThread]->createSession(l_SessionDesc, &m_SlangSession)))
+    if (SLANG_FAILED(l_GlobalSession->createSession(l_SessionDesc, &m_SlangSession)))
     {
         m_Result.error = "Failed to create Slang session";
         m_Result.status = Result::FAILED;
         return false;
     }
+    // Keeps the global session out of the pool for as long as this ISession is alive, even after the lease is released
+    VulkanShaderSessionPool::retainSession(l_GlobalSession);
+    m_GlobalSession = l_GlobalSession;
+    l_GlobalSessionLock = {};
+    recordSession(getElapsedMilliseconds(l_Start));
     return true;
 }
 
+void VulkanShader::recordSession(const double p_Milliseconds)
+{
+    m_Stats.sessionMilliseconds += p_Milliseconds;
+
+    std::scoped_lock l_Lock(s_ProfileMutex);
+    s_ProfileReport.sessions++;
+    s_ProfileReport.sessionMilliseconds += p_Milliseconds;
+}
+
+void VulkanShader::recordModuleLoad(const std::string_view p_ModuleName, const double p_Milliseconds, const bool p_FromCache)
+{
+    m_Stats.modules.push_back({std::string{p_ModuleName}, p_Milliseconds, p_FromCache});
+
+    std::scoped_lock l_Lock(s_ProfileMutex);
+    s_ProfileReport.moduleMilliseconds += p_Milliseconds;
+    ProfileReport::ModuleTotals& l_Totals = s_ProfileReport.modules[std::string{p_ModuleName}];
+    l_Totals.loads++;
+    l_Totals.cachedLoads += p_FromCache ? 1 : 0;
+    l_Totals.milliseconds += p_Milliseconds;
+}
+
+void VulkanShader::recordLink(const double p_Milliseconds)
+{
+    m_Stats.linkMilliseconds += p_Milliseconds;
+
+    std::scoped_lock l_Lock(s_ProfileMutex);
+    s_ProfileReport.linkMilliseconds += p_Milliseconds;
+}
+
+void VulkanShader::recordEntryPoint(const std::string_view p_Name, const VkShaderStageFlagBits p_Stage, const double p_Milliseconds, const size_t p_SPIRVBytes)
+{
+    m_Stats.entryPoints.push_back({std::string{p_Name}, p_Stage, p_Milliseconds, p_SPIRVBytes});
+    m_Stats.spirvBytes += p_SPIRVBytes;
+
+    std::scoped_lock l_Lock(s_ProfileMutex);
+    s_ProfileReport.codegenMilliseconds += p_Milliseconds;
+    s_ProfileReport.spirvBytes += p_SPIRVBytes;
+}
+
+void VulkanShader::recordCacheResult(const Stats::CacheResult p_Result)
+{
+    m_Stats.cache = p_Result;
+
+    std::scoped_lock l_Lock(s_ProfileMutex);
+    s_ProfileReport.shaders++;
+    if (p_Result == Stats::CACHE_HIT)
+    {
+        s_ProfileReport.cacheHits++;
+        s_ProfileReport.spirvBytes += m_Stats.spirvBytes;
+    }
+    else if (p_Result == Stats::CACHE_MISS)
+    {
+        s_ProfileReport.cacheMisses++;
+    }
+}
+
 void VulkanShaderModule::free()
 {
     if (m_VkHandle != VK_NULL_HANDLE)
@@ -0,0 +1,598 @@
+#include "vulkan_shader_cache.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <sstream>
+
+#include "utils/logger.hpp"
+#include "utils/mapped_file.hpp"
+
+static constexpr std::string_view ENTRY_EXTENSION = ".spvc";
+static constexpr std::string_view MODULE_EXTENSION = ".slang-module";
+static constexpr std::string_view REFLECTION_EXTENSION = ".refl";
+
+static constexpr std::chrono::minutes STALE_TEMP_AGE{10};
+
+static std::string toHex(const uint64_t p_Value)
+{
+    static constexpr char l_Digits[] = "0123456789abcdef";
+    std::string l_Result(16, '0');
+    for (size_t i = 0; i < 16; i++)
+    {
+        l_Result[15 - i] = l_Digits[(p_Value >> (i * 4)) & 0xF];
+    }
+    return l_Result;
+}
+
+static std::string_view trim(std::string_view p_String)
+{
+    while (!p_String.empty() && std::isspace(static_cast<unsigned char>(p_String.front())))
+    {
+        p_String.remove_prefix(1);
+    }
+    while (!p_String.empty() && std::isspace(static_cast<unsigned char>(p_String.back())))
+    {
+        p_String.remove_suffix(1);
+    }
+    return p_String;
+}
+
+struct Dependency
+{
+    // Relative paths the dependency could resolve to
+    std::vector<std::string> candidates;
+    // Set for imports by module name, empty for includes and imports by path
+    std::string module;
+};
+
+static std::vector<Dependency> findDependencies(const std::string_view p_Source)
+{
+    std::vector<Dependency> l_Dependencies;
+
+    size_t l_LineStart = 0;
+    while (l_LineStart < p_Source.size())
+    {
+        size_t l_LineEnd = p_Source.find('\n', l_LineStart);
+        if (l_LineEnd == std::string_view::npos)
+        {
+            l_LineEnd = p_Source.size();
+        }
+        const std::string_view l_Line = trim(p_Source.substr(l_LineStart, l_LineEnd - l_LineStart));
+        l_LineStart = l_LineEnd + 1;
+
+        std::string_view l_Target;
+        if (l_Line.starts_with("#include"))
+        {
+            l_Target = trim(l_Line.substr(8));
+        }
+        else if (l_Line.starts_with("import ") || l_Line.starts_with("__include "))
+        {
+            l_Target = trim(l_Line.substr(l_Line.find(' ')));
+            l_Target = trim(l_Target.substr(0, l_Target.find(';')));
+        }
+        else
+        {
+            continue;
+        }
+
+        if (l_Target.empty())
+        {
+            continue;
+        }
+
+        if (l_Target.front() == '"' || l_Target.front() == '<')
+        {
+            const char l_Close = l_Target.front() == '"' ? '"' : '>';
+            const size_t l_End = l_Target.find(l_Close, 1);
+            if (l_End != std::string_view::npos)
+            {
+                l_Dependencies.push_back({{std::string{l_Target.substr(1, l_End - 1)}}, {}});
+            }
+            continue;
+        }
+
+        // Module names map dots to directories, and Slang also accepts dashes in place of underscores
+        std::string l_Module{l_Target};
+        std::ranges::replace(l_Module, '.', '/');
+        std::string l_Dashed = l_Module;
+        std::ranges::replace(l_Dashed, '_', '-');
+        l_Dependencies.push_back({{l_Module + ".slang", l_Dashed + ".slang"}, std::string{l_Target}});
+    }
+    return l_Dependencies;
+}
+
+static std::filesystem::path resolveDependency(const std::vector<std::string>& p_Candidates, const std::filesystem::path& p_BaseDir, const std::unordered_set<std::string>& p_SearchPaths)
+{
+    std::error_code l_Error;
+    for (const std::string& l_Candidate : p_Candidates)
+    {
+        if (std::filesystem::is_regular_file(p_BaseDir / l_Candidate, l_Error))
+        {
+            return p_BaseDir / l_Candidate;
+        }
+        for (const std::string& l_SearchPath : p_SearchPaths)
+        {
+            if (std::filesystem::is_regular_file(std::filesystem::path{l_SearchPath} / l_Candidate, l_Error))
+            {
+                return std::filesystem::path{l_SearchPath} / l_Candidate;
+            }
+        }
+    }
+    return {};
+}
+
+static std::string readFile(const std::filesystem::path& p_Path)
+{
+    std::ifstream l_File(p_Path, std::ios::binary);
+    std::stringstream l_Stream;
+    l_Stream << l_File.rdbuf();
+    return l_Stream.str();
+}
+
+static bool isCacheFile(const std::filesystem::path& p_Path)
+{
+    return p_Path.extension() == ENTRY_EXTENSION || p_Path.extension() == MODULE_EXTENSION || p_Path.extension() == REFLECTION_EXTENSION;
+}
+
+VulkanShaderCache::VulkanShaderCache(const std::string_view p_Directory, const uint64_t p_MaxBytes)
+    : m_Directory(p_Directory), m_MaxBytes(p_MaxBytes)
+{
+    std::error_code l_Error;
+    std::filesystem::create_directories(m_Directory, l_Error);
+    if (l_Error)
+    {
+        LOG_WARN("Failed to create shader cache directory ", m_Directory.string(), ": ", l_Error.message());
+    }
+}
+
+bool VulkanShaderCache::load(const uint64_t p_Key, std::vector<EntryPoint>& p_EntryPoints) const
+{
+    const std::filesystem::path l_Path = getEntryPath(p_Key, ENTRY_EXTENSION);
+    std::error_code l_Error;
+    if (!std::filesystem::is_regular_file(l_Path, l_Error))
+    {
+        return false;
+    }
+
+    // Counts come straight from the file, they are checked against the bytes left before anything is sized after them
+    bool l_Corrupt = false;
+    {
+        const MappedFile l_File{l_Path.string()};
+        if (!l_File.isOpen())
+        {
+            return false;
+        }
+
+        const uint8_t* l_Data = l_File.getData();
+        const size_t l_Size = l_File.getSize();
+        size_t l_Offset = 0;
+        const auto l_Read = [&](void* p_Dst, const size_t p_Bytes)
+        {
+            if (l_Offset + p_Bytes > l_Size)
+            {
+                return false;
+            }
+            memcpy(p_Dst, l_Data + l_Offset, p_Bytes);
+            l_Offset += p_Bytes;
+            return true;
+        };
+
+        uint32_t l_Magic = 0;
+        uint32_t l_Version = 0;
+        uint64_t l_Key = 0;
+        uint32_t l_Count = 0;
+        if (!l_Read(&l_Magic, sizeof(l_Magic)) || !l_Read(&l_Version, sizeof(l_Version)) || !l_Read(&l_Key, sizeof(l_Key)) || !l_Read(&l_Count, sizeof(l_Count))
+            || l_Magic != FILE_MAGIC || l_Version != FILE_VERSION || l_Key != p_Key)
+        {
+            LOG_WARN("Ignoring invalid shader cache entry ", l_Path.string());
+            return false;
+        }
+
+        constexpr size_t l_EntryHeaderSize = 3 * sizeof(uint32_t);
+        std::vector<EntryPoint> l_EntryPoints;
+        if (l_Count > (l_Size - l_Offset) / l_EntryHeaderSize)
+        {
+            l_Corrupt = true;
+        }
+        else
+        {
+            l_EntryPoints.resize(l_Count);
+        }
+
+        for (EntryPoint& l_EntryPoint : l_EntryPoints)
+        {
+            uint32_t l_Stage = 0;
+            uint32_t l_NameLength = 0;
+            uint32_t l_WordCount = 0;
+            if (!l_Read(&l_Stage, sizeof(l_Stage)) || !l_Read(&l_NameLength, sizeof(l_NameLength)) || !l_Read(&l_WordCount, sizeof(l_WordCount))
+                || l_NameLength > l_Size - l_Offset || l_WordCount > (l_Size - l_Offset - l_NameLength) / sizeof(uint32_t))
+            {
+                l_Corrupt = true;
+                break;
+            }
+            l_EntryPoint.stage = static_cast<VkShaderStageFlagBits>(l_Stage);
+            l_EntryPoint.name.resize(l_NameLength);
+            l_EntryPoint.spirv.resize(l_WordCount);
+            l_Read(l_EntryPoint.name.data(), l_NameLength);
+            l_Read(l_EntryPoint.spirv.data(), l_WordCount * sizeof(uint32_t));
+        }
+
+        if (!l_Corrupt)
+        {
+            p_EntryPoints = std::move(l_EntryPoints);
+        }
+    }
+
+    if (l_Corrupt)
+    {
+        // A miss would only rewrite it under the same name, so drop it now instead of rejecting it on every run
+        LOG_WARN("Removing corrupt shader cache entry ", l_Path.string());
+        std::filesystem::remove(l_Path, l_Error);
+        return false;
+    }
+
+    // The modification time doubles as the last use for eviction
+    std::filesystem::last_write_time(l_Path, std::filesystem::file_time_type::clock::now(), l_Error);
+    return true;
+}
+
+void VulkanShaderCache::store(const uint64_t p_Key, const std::span<const EntryPointView> p_EntryPoints)
+{
+    std::string l_Data;
+    const auto l_Write = [&l_Data](const void* p_Src, const size_t p_Bytes)
+    {
+        l_Data.append(static_cast<const char*>(p_Src), p_Bytes);
+    };
+
+    const uint32_t l_Count = static_cast<uint32_t>(p_EntryPoints.size());
+    l_Write(&FILE_MAGIC, sizeof(FILE_MAGIC));
+    l_Write(&FILE_VERSION, sizeof(FILE_VERSION));
+    l_Write(&p_Key, sizeof(p_Key));
+    l_Write(&l_Count, sizeof(l_Count));
+    for (const EntryPointView& l_EntryPoint : p_EntryPoints)
+    {
+        const uint32_t l_Stage = l_EntryPoint.stage;
+        const uint32_t l_NameLength = static_cast<uint32_t>(l_EntryPoint.name.size());
+        const uint32_t l_WordCount = static_cast<uint32_t>(l_EntryPoint.spirv.size());
+        l_Write(&l_Stage, sizeof(l_Stage));
+        l_Write(&l_NameLength, sizeof(l_NameLength));
+        l_Write(&l_WordCount, sizeof(l_WordCount));
+        l_Write(l_EntryPoint.name.data(), l_NameLength);
+        l_Write(l_EntryPoint.spirv.data(), l_WordCount * sizeof(uint32_t));
+    }
+
+    const std::filesystem::path l_Path = getEntryPath(p_Key, ENTRY_EXTENSION);
+    if (writeEntry(l_Path, l_Data))
+    {
+        LOG_DEBUG("Stored ", p_EntryPoints.size(), " entry points in shader cache entry ", l_Path.filename().string());
+        evict();
+    }
+}
+
+std::shared_ptr<const std::vector<uint8_t>> VulkanShaderCache::loadModule(const uint64_t p_Key)
+{
+    {
+        std::scoped_lock l_Lock(m_ModuleMutex);
+        const auto l_It = m_Modules.find(p_Key);
+        if (l_It != m_Modules.end())
+        {
+            return l_It->second;
+        }
+    }
+
+    std::shared_ptr<std::vector<uint8_t>> l_Module = std::make_shared<std::vector<uint8_t>>();
+    if (!readBlob(getEntryPath(p_Key, MODULE_EXTENSION), MODULE_MAGIC, p_Key, *l_Module))
+    {
+        return nullptr;
+    }
+
+    std::scoped_lock l_Lock(m_ModuleMutex);
+    return m_Modules.try_emplace(p_Key, std::move(l_Module)).first->second;
+}
+
+void VulkanShaderCache::storeModule(const uint64_t p_Key, const std::span<const uint8_t> p_Data)
+{
+    {
+        std::scoped_lock l_Lock(m_ModuleMutex);
+        // Replaces any entry that failed to deserialize
+        m_Modules.insert_or_assign(p_Key, std::make_shared<std::vector<uint8_t>>(p_Data.begin(), p_Data.end()));
+    }
+
+    const std::filesystem::path l_Path = getEntryPath(p_Key, MODULE_EXTENSION);
+    if (writeBlob(l_Path, MODULE_MAGIC, p_Key, p_Data))
+    {
+        LOG_DEBUG("Stored ", p_Data.size(), " bytes of module IR in shader cache entry ", l_Path.filename().string());
+        evict();
+    }
+}
+
+bool VulkanShaderCache::loadReflection(const uint64_t p_Key, std::vector<uint8_t>& p_Data) const
+{
+    return readBlob(getEntryPath(p_Key, REFLECTION_EXTENSION), REFLECTION_MAGIC, p_Key, p_Data);
+}
+
+void VulkanShaderCache::storeReflection(const uint64_t p_Key, const std::span<const uint8_t> p_Data)
+{
+    const std::filesystem::path l_Path = getEntryPath(p_Key, REFLECTION_EXTENSION);
+    if (writeBlob(l_Path, REFLECTION_MAGIC, p_Key, p_Data))
+    {
+        LOG_DEBUG("Stored reflection in shader cache entry ", l_Path.filename().string());
+        evict();
+    }
+}
+
+bool VulkanShaderCache::readBlob(const std::filesystem::path& p_Path, const uint32_t p_Magic, const uint64_t p_Key, std::vector<uint8_t>& p_Data)
+{
+    std::error_code l_Error;
+    if (!std::filesystem::is_regular_file(p_Path, l_Error))
+    {
+        return false;
+    }
+
+    {
+        const MappedFile l_File{p_Path.string()};
+        if (!l_File.isOpen())
+        {
+            return false;
+        }
+
+        uint32_t l_Magic = 0;
+        uint32_t l_Version = 0;
+        uint64_t l_Key = 0;
+        constexpr size_t l_HeaderSize = sizeof(l_Magic) + sizeof(l_Version) + sizeof(l_Key);
+        if (l_File.getSize() < l_HeaderSize)
+        {
+            LOG_WARN("Ignoring truncated shader cache entry ", p_Path.string());
+            return false;
+        }
+        memcpy(&l_Magic, l_File.getData(), sizeof(l_Magic));
+        memcpy(&l_Version, l_File.getData() + sizeof(l_Magic), sizeof(l_Version));
+        memcpy(&l_Key, l_File.getData() + sizeof(l_Magic) + sizeof(l_Version), sizeof(l_Key));
+        if (l_Magic != p_Magic || l_Version != FILE_VERSION || l_Key != p_Key)
+        {
+            LOG_WARN("Ignoring invalid shader cache entry ", p_Path.string());
+            return false;
+        }
+        p_Data.assign(l_File.getData() + l_HeaderSize, l_File.getData() + l_File.getSize());
+    }
+
+    // The modification time doubles as the last use for eviction
+    std::filesystem::last_write_time(p_Path, std::filesystem::file_time_type::clock::now(), l_Error);
+    return true;
+}
+
+bool VulkanShaderCache::writeBlob(const std::filesystem::path& p_Path, const uint32_t p_Magic, const uint64_t p_Key, const std::span<const uint8_t> p_Data)
+{
+    std::string l_Data;
+    l_Data.reserve(sizeof(p_Magic) + sizeof(FILE_VERSION) + sizeof(p_Key) + p_Data.size());
+    l_Data.append(reinterpret_cast<const char*>(&p_Magic), sizeof(p_Magic));
+    l_Data.append(reinterpret_cast<const char*>(&FILE_VERSION), sizeof(FILE_VERSION));
+    l_Data.append(reinterpret_cast<const char*>(&p_Key), sizeof(p_Key));
+    l_Data.append(reinterpret_cast<const char*>(p_Data.data()), p_Data.size());
+    return writeEntry(p_Path, l_Data);
+}
+
+bool VulkanShaderCache::writeEntry(const std::filesystem::path& p_Path, const std::string_view p_Data)
+{
+    // Each writer gets its own temporary file, the rename makes the entry visible to readers all at once
+    thread_local std::mt19937_64 l_Random{std::random_device{}()};
+    std::filesystem::path l_TempPath = p_Path;
+    l_TempPath += "." + toHex(l_Random()) + ".tmp";
+
+    std::error_code l_Error;
+    {
+        std::ofstream l_File(l_TempPath, std::ios::binary | std::ios::trunc);
+        if (!l_File.is_open() || !l_File.write(p_Data.data(), static_cast<std::streamsize>(p_Data.size())))
+        {
+            LOG_WARN("Failed to write shader cache entry ", l_TempPath.string());
+            l_File.close();
+            std::filesystem::remove(l_TempPath, l_Error);
+            return false;
+        }
+    }
+
+    std::filesystem::rename(l_TempPath, p_Path, l_Error);
+    if (l_Error)
+    {
+        // Another process holds the entry open. It has the same contents, so this one can be dropped
+        LOG_DEBUG("Shader cache entry ", p_Path.filename().string(), " is in use, discarding new copy");
+        std::filesystem::remove(l_TempPath, l_Error);
+        return false;
+    }
+    return true;
+}
+
+void VulkanShaderCache::evict()
+{
+    std::scoped_lock l_Lock(m_EvictionMutex);
+
+    struct CachedFile
+    {
+        std::filesystem::path path;
+        uint64_t size;
+        std::filesystem::file_time_type lastUse;
+    };
+
+    std::vector<CachedFile> l_Files;
+    uint64_t l_TotalSize = 0;
+    std::error_code l_Error;
+    const std::filesystem::file_time_type l_StaleTime = std::filesystem::file_time_type::clock::now() - STALE_TEMP_AGE;
+    for (const std::filesystem::directory_entry& l_Entry : std::filesystem::directory_iterator(m_Directory, l_Error))
+    {
+        // Temporary files of writers that crashed before the rename. Recent ones may still be written by another process
+        if (l_Entry.path().extension() == ".tmp" && l_Entry.is_regular_file(l_Error) && l_Entry.last_write_time(l_Error) < l_StaleTime)
+        {
+            std::filesystem::remove(l_Entry.path(), l_Error);
+            continue;
+        }
+
+        if (!isCacheFile(l_Entry.path()) || !l_Entry.is_regular_file(l_Error))
+        {
+            continue;
+        }
+        const uint64_t l_Size = l_Entry.file_size(l_Error);
+        if (l_Error)
+        {
+            continue;
+        }
+        l_Files.push_back({l_Entry.path(), l_Size, l_Entry.last_write_time(l_Error)});
+        l_TotalSize += l_Size;
+    }
+
+    if (l_TotalSize <= m_MaxBytes)
+    {
+        return;
+    }
+
+    std::ranges::sort(l_Files, {}, &CachedFile::lastUse);
+    uint32_t l_Removed = 0;
+    for (const CachedFile& l_File : l_Files)
+    {
+        if (l_TotalSize <= m_MaxBytes)
+        {
+            break;
+        }
+        // Another process may have evicted it first, the space is gone either way
+        std::filesystem::remove(l_File.path, l_Error);
+        l_TotalSize -= l_File.size;
+        l_Removed++;
+    }
+    LOG_DEBUG("Evicted ", l_Removed, " shader cache entries");
+}
+
+void VulkanShaderCache::clear()
+{
+    {
+        std::scoped_lock l_Lock(m_ModuleMutex);
+        m_Modules.clear();
+    }
+
+    std::scoped_lock l_Lock(m_EvictionMutex);
+
+    std::error_code l_Error;
+    for (const std::filesystem::directory_entry& l_Entry : std::filesystem::directory_iterator(m_Directory, l_Error))
+    {
+        if (isCacheFile(l_Entry.path()))
+        {
+            std::filesystem::remove(l_Entry.path(), l_Error);
+        }
+    }
+}
+
+uint64_t VulkanShaderCache::hash(const std::string_view p_Data, const uint64_t p_Seed)
+{
+    return hash(p_Data.data(), p_Data.size(), p_Seed);
+}
+
+uint64_t VulkanShaderCache::hash(const void* p_Data, const size_t p_Size, const uint64_t p_Seed)
+{
+    const uint8_t* l_Bytes = static_cast<const uint8_t*>(p_Data);
+    uint64_t l_Hash = p_Seed;
+    for (size_t i = 0; i < p_Size; i++)
+    {
+        l_Hash ^= l_Bytes[i];
+        l_Hash *= 0x100000001b3ULL;
+    }
+    return l_Hash;
+}
+
+uint64_t VulkanShaderCache::hashModuleSource(const std::string_view p_Source, const std::filesystem::path& p_BaseDir, const std::unordered_set<std::string>& p_SearchPaths, const uint64_t p_Seed)
+{
+    std::unordered_set<std::string> l_Visited;
+    return hashDependencies(p_Source, p_BaseDir, p_SearchPaths, l_Visited, hash(p_Source, p_Seed));
+}
+
+std::vector<std::filesystem::path> VulkanShaderCache::collectDependencies(const std::string_view p_Source, const std::filesystem::path& p_BaseDir, const std::unordered_set<std::string>& p_SearchPaths)
+{
+    std::unordered_set<std::string> l_Visited;
+    std::vector<std::filesystem::path> l_Files;
+    collectDependencies(p_Source, p_BaseDir, p_SearchPaths, l_Visited, l_Files);
+    return l_Files;
+}
+
+std::vector<VulkanShaderCache::ImportedModule> VulkanShaderCache::collectImports(const std::string_view p_Source, const std::filesystem::path& p_BaseDir, const std::unordered_set<std::string>& p_SearchPaths)
+{
+    std::unordered_set<std::string> l_Visited;
+    std::vector<ImportedModule> l_Modules;
+    collectImports(p_Source, p_BaseDir, p_SearchPaths, l_Visited, l_Modules);
+    return l_Modules;
+}
+
+std::filesystem::path VulkanShaderCache::getEntryPath(const uint64_t p_Key, const std::string_view p_Extension) const
+{
+    std::filesystem::path l_Path = m_Directory / toHex(p_Key);
+    l_Path += p_Extension;
+    return l_Path;
+}
+
+uint64_t VulkanShaderCache::hashDependencies(const std::string_view p_Source, const std::filesystem::path& p_BaseDir, const std::unordered_set<std::string>& p_SearchPaths, std::unordered_set<std::string>& p_Visited, uint64_t p_Hash)
+{
+    std::error_code l_Error;
+    for (const Dependency& l_Dependency : findDependencies(p_Source))
+    {
+        const std::filesystem::path l_Resolved = resolveDependency(l_Dependency.candidates, p_BaseDir, p_SearchPaths);
+        if (l_Resolved.empty())
+        {
+            p_Hash = hash(l_Dependency.candidates.front(), p_Hash);
+            continue;
+        }
+
+        if (!p_Visited.insert(std::filesystem::weakly_canonical(l_Resolved, l_Error).string()).second)
+        {
+            continue;
+        }
+
+        const std::string l_Source = readFile(l_Resolved);
+        p_Hash = hash(l_Source, p_Hash);
+        p_Hash = hashDependencies(l_Source, l_Resolved.parent_path(), p_SearchPaths, p_Visited, p_Hash);
+    }
+    return p_Hash;
+}
+
+void VulkanShaderCache::collectDependencies(const std::string_view p_Source, const std::filesystem::path& p_BaseDir, const std::unordered_set<std::string>& p_SearchPaths, std::unordered_set<std::string>& p_Visited, std::vector<std::filesystem::path>& p_Files)
+{
+    std::error_code l_Error;
+    for (const Dependency& l_Dependency : findDependencies(p_Source))
+    {
+        const std::filesystem::path l_Resolved = resolveDependency(l_Dependency.candidates, p_BaseDir, p_SearchPaths);
+        if (l_Resolved.empty())
+        {
+            continue;
+        }
+
+        const std::filesystem::path l_Canonical = std::filesystem::weakly_canonical(l_Resolved, l_Error);
+        if (!p_Visited.insert(l_Canonical.string()).second)
+        {
+            continue;
+        }
+        p_Files.push_back(l_Canonical);
+        collectDependencies(readFile(l_Resolved), l_Resolved.parent_path(), p_SearchPaths, p_Visited, p_Files);
+    }
+}
+
+void VulkanShaderCache::collectImports(const std::string_view p_Source, const std::filesystem::path& p_BaseDir, const std::unordered_set<std::string>& p_SearchPaths, std::unordered_set<std::string>& p_Visited, std::vector<ImportedModule>& p_Modules)
+{
+    std::error_code l_Error;
+    for (const Dependency& l_Dependency : findDependencies(p_Source))
+    {
+        if (l_Dependency.module.empty())
+        {
+            continue;
+        }
+
+        const std::filesystem::path l_Resolved = resolveDependency(l_Dependency.candidates, p_BaseDir, p_SearchPaths);
+        if (l_Resolved.empty() || !p_Visited.insert(std::filesystem::weakly_canonical(l_Resolved, l_Error).string()).second)
+        {
+            continue;
+        }
+
+        // Imports go first so each module can be deserialized once everything it references is loaded
+        const std::string l_Source = readFile(l_Resolved);
+        collectImports(l_Source, l_Resolved.parent_path(), p_SearchPaths, p_Visited, p_Modules);
+        p_Modules.push_back({l_Dependency.module, l_Resolved, hashModuleSource(l_Source, l_Resolved.parent_path(), p_SearchPaths)});
+    }
+}
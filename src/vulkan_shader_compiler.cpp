@@ -0,0 +1,184 @@
+#include "vulkan_shader_compiler.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+#include "vulkan_shader_session_pool.hpp"
+#include "utils/logger.hpp"
+
+VulkanShaderCompiler::VulkanShaderCompiler(const ThreadID p_FirstWorkerThread, uint32_t p_WorkerCount)
+    : m_FirstWorkerThread(p_FirstWorkerThread)
+{
+    if (p_WorkerCount == 0)
+    {
+        p_WorkerCount = std::max(1U, std::thread::hardware_concurrency());
+    }
+
+    m_Workers.reserve(p_WorkerCount);
+    for (uint32_t i = 0; i < p_WorkerCount; i++)
+    {
+        m_Workers.emplace_back(&VulkanShaderCompiler::workerLoop, this, p_FirstWorkerThread + i);
+    }
+    LOG_DEBUG("Created shader compiler with ", p_WorkerCount, " worker(s) using thread IDs ", p_FirstWorkerThread, " to ", p_FirstWorkerThread + p_WorkerCount - 1);
+}
+
+VulkanShaderCompiler::~VulkanShaderCompiler()
+{
+    {
+        std::scoped_lock l_Lock(m_Mutex);
+        m_Stop = true;
+    }
+    m_JobAvailable.notify_all();
+
+    for (std::thread& l_Worker : m_Workers)
+    {
+        l_Worker.join();
+    }
+
+    // Every shader built by the workers is gone by now, so their global sessions can go back to the pool
+    for (uint32_t i = 0; i < getWorkerCount(); i++)
+    {
+        VulkanShaderSessionPool::release(m_FirstWorkerThread + i);
+    }
+}
+
+std::future<VulkanShaderCompiler::Output> VulkanShaderCompiler::submit(Request p_Request)
+{
+    std::future<Output> l_Future;
+    {
+        std::scoped_lock l_Lock(m_Mutex);
+        Job& l_Job = m_Jobs.emplace_back(std::move(p_Request));
+        l_Future = l_Job.promise.get_future();
+        m_Pending++;
+    }
+    m_JobAvailable.notify_one();
+    return l_Future;
+}
+
+std::vector<std::future<VulkanShaderCompiler::Output>> VulkanShaderCompiler::submit(const std::span<const Request> p_Requests)
+{
+    std::vector<std::future<Output>> l_Futures;
+    l_Futures.reserve(p_Requests.size());
+    {
+        std::scoped_lock l_Lock(m_Mutex);
+        for (const Request& l_Request : p_Requests)
+        {
+            Job& l_Job = m_Jobs.emplace_back(l_Request);
+            l_Futures.push_back(l_Job.promise.get_future());
+        }
+        m_Pending += p_Requests.size();
+    }
+    m_JobAvailable.notify_all();
+    LOG_DEBUG("Submitted ", p_Requests.size(), " shader(s) for compilation");
+    return l_Futures;
+}
+
+void VulkanShaderCompiler::consume(const std::span<std::future<Output>> p_Futures, const std::function<void(size_t, Output&&)>& p_Callback)
+{
+    std::vector<bool> l_Consumed(p_Futures.size(), false);
+    size_t l_Remaining = p_Futures.size();
+    while (l_Remaining > 0)
+    {
+        bool l_Progress = false;
+        for (size_t i = 0; i < p_Futures.size(); i++)
+        {
+            if (l_Consumed[i] || p_Futures[i].wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+            {
+                continue;
+            }
+            l_Consumed[i] = true;
+            l_Remaining--;
+            l_Progress = true;
+            p_Callback(i, p_Futures[i].get());
+        }
+
+        if (!l_Progress)
+        {
+            // Woken by any finished job, the timeout only covers futures fulfilled right before the wait started
+            std::unique_lock l_Lock(m_Mutex);
+            m_JobFinished.wait_for(l_Lock, std::chrono::milliseconds(5));
+        }
+    }
+}
+
+void VulkanShaderCompiler::waitIdle()
+{
+    std::unique_lock l_Lock(m_Mutex);
+    m_JobFinished.wait(l_Lock, [this] { return m_Pending == 0; });
+}
+
+size_t VulkanShaderCompiler::getPendingCount() const
+{
+    std::scoped_lock l_Lock(m_Mutex);
+    return m_Pending;
+}
+
+void VulkanShaderCompiler::workerLoop(const ThreadID p_ThreadID)
+{
+    while (true)
+    {
+        Job l_Job;
+        {
+            std::unique_lock l_Lock(m_Mutex);
+            m_JobAvailable.wait(l_Lock, [this] { return m_Stop || !m_Jobs.empty(); });
+            if (m_Jobs.empty())
+            {
+                return;
+            }
+            l_Job = std::move(m_Jobs.front());
+            m_Jobs.pop_front();
+        }
+
+        try
+        {
+            l_Job.promise.set_value(compile(l_Job.request, p_ThreadID));
+        }
+        catch (...)
+        {
+            l_Job.promise.set_exception(std::current_exception());
+        }
+
+        {
+            std::scoped_lock l_Lock(m_Mutex);
+            m_Pending--;
+        }
+        m_JobFinished.notify_all();
+    }
+}
+
+VulkanShaderCompiler::Output VulkanShaderCompiler::compile(const Request& p_Request, const ThreadID p_ThreadID)
+{
+    Output l_Output;
+
+    VulkanShader l_Shader{p_ThreadID, p_Request.optimize, p_Request.macros};
+    for (const std::string& l_Path : p_Request.searchPaths)
+    {
+        l_Shader.addSearchPath(l_Path);
+    }
+    l_Shader.loadModule(p_Request.filename, p_Request.moduleName);
+    l_Shader.linkAndFinalize();
+
+    for (const VkShaderStageFlagBits l_Stage : p_Request.stages)
+    {
+        if (l_Shader.getStatus().status != VulkanShader::Result::COMPILED)
+        {
+            break;
+        }
+        const std::span<const uint32_t> l_Code = l_Shader.getSPIRVForStage(l_Stage);
+        l_Output.stages.push_back({l_Stage, {l_Code.begin(), l_Code.end()}});
+    }
+
+    if (p_Request.reflect && l_Shader.getStatus().status == VulkanShader::Result::COMPILED)
+    {
+        l_Output.reflection = l_Shader.getReflection();
+    }
+
+    l_Output.result = l_Shader.getStatus();
+    l_Output.stats = l_Shader.getStats();
+    if (l_Output.result.status == VulkanShader::Result::FAILED)
+    {
+        LOG_ERR("Failed to compile shader ", p_Request.filename, " -> ", l_Output.result.error);
+        l_Output.stages.clear();
+    }
+    return l_Output;
+}
@@ -0,0 +1,441 @@
+#include "vulkan_shader_reload.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <ranges>
+#include <sstream>
+#include <stdexcept>
+#include <vulkan/vk_enum_string_helper.h>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#include "vulkan_context.hpp"
+#include "vulkan_device.hpp"
+#include "vulkan_shader_cache.hpp"
+#include "vulkan_shader_session_pool.hpp"
+#include "utils/logger.hpp"
+
+VulkanShaderHotReloader::VulkanShaderHotReloader(const ResourceID p_Device, const ThreadID p_CompilationThread, const uint32_t p_FramesInFlight)
+    : m_Device(p_Device), m_CompilationThread(p_CompilationThread), m_FramesInFlight(p_FramesInFlight)
+{
+#ifdef __linux__
+    m_INotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_INotify < 0)
+    {
+        throw std::runtime_error("Failed to initialize inotify for shader hot reload");
+    }
+#endif
+    m_Thread = std::thread(&VulkanShaderHotReloader::watcherLoop, this);
+    LOG_DEBUG("Started shader hot reload on compilation thread ", p_CompilationThread);
+}
+
+VulkanShaderHotReloader::~VulkanShaderHotReloader()
+{
+    m_Stop = true;
+    if (m_Thread.joinable())
+    {
+        m_Thread.join();
+    }
+    VulkanShaderSessionPool::release(m_CompilationThread);
+#ifdef __linux__
+    if (m_INotify >= 0)
+    {
+        close(m_INotify);
+    }
+#endif
+    flushRetired();
+}
+
+void VulkanShaderHotReloader::watchShaderModules(const Source& p_Source, const std::span<const ResourceID> p_Modules)
+{
+    const VulkanDevice& l_Device = VulkanContext::getDevice(m_Device);
+
+    WatchedShader l_Shader{p_Source, {}, {}};
+    for (const ResourceID l_Module : p_Modules)
+    {
+        l_Shader.modules.push_back({l_Module, l_Device.getShaderModule(l_Module).getStage()});
+    }
+
+    uint32_t l_Index;
+    {
+        std::scoped_lock l_Lock(m_Mutex);
+        l_Index = static_cast<uint32_t>(m_Shaders.size());
+        m_Shaders.push_back(std::move(l_Shader));
+        for (const std::string& l_Path : p_Source.searchPaths)
+        {
+            watchDirectory(l_Path);
+        }
+    }
+    updateDependencies(l_Index);
+    LOG_DEBUG("Watching shader ", p_Source.filename, " for ", p_Modules.size(), " module(s)");
+}
+
+void VulkanShaderHotReloader::watchPipeline(const ResourceID p_Pipeline, const VulkanPipelineBuilder& p_Builder)
+{
+    std::scoped_lock l_Lock(m_Mutex);
+    m_Pipelines.push_back({p_Pipeline, p_Builder});
+}
+
+void VulkanShaderHotReloader::watchComputePipeline(const ResourceID p_Pipeline, const ResourceID p_Shader, const std::string_view p_Entrypoint, const VulkanSpecialization& p_Specialization)
+{
+    std::scoped_lock l_Lock(m_Mutex);
+    m_Pipelines.push_back({p_Pipeline, std::nullopt, p_Shader, std::string{p_Entrypoint}, p_Specialization});
+}
+
+uint32_t VulkanShaderHotReloader::applyPendingReloads()
+{
+    VulkanDevice& l_Device = VulkanContext::getDevice(m_Device);
+    m_Frame++;
+
+    // Anything retired at least a full set of frames in flight ago can no longer be referenced by the GPU
+    const auto l_Expired = std::ranges::partition(m_Retired, [this](const RetiredHandle& p_Handle) { return p_Handle.frame + m_FramesInFlight > m_Frame; });
+    for (const RetiredHandle& l_Handle : l_Expired)
+    {
+        destroyHandle(l_Handle);
+    }
+    m_Retired.erase(l_Expired.begin(), l_Expired.end());
+
+    std::scoped_lock l_Lock(m_Mutex);
+    if (m_Ready.empty())
+    {
+        return 0;
+    }
+
+    // Every new module and pipeline is built before anything is swapped, so a failure leaves the previous shaders
+    // fully in place instead of a mix of new modules and pipelines still built from the old ones
+    std::vector<std::pair<VulkanShaderModule*, VkShaderModule>> l_NewModules;
+    std::vector<std::pair<VulkanPipeline*, VkPipeline>> l_NewPipelines;
+    std::unordered_set<ResourceID> l_SwappedModules;
+    bool l_Failed = false;
+    for (const CompiledShader& l_Compiled : m_Ready)
+    {
+        for (const WatchedModule& l_Watched : m_Shaders[l_Compiled.shader].modules)
+        {
+            VulkanShaderModule* l_Module = l_Device.getSubresource<VulkanShaderModule>(l_Watched.module);
+            const auto l_Code = std::ranges::find(l_Compiled.stages, l_Watched.stage, &std::pair<VkShaderStageFlagBits, std::vector<uint32_t>>::first);
+            if (!l_Module || l_Code == l_Compiled.stages.end())
+            {
+                continue;
+            }
+
+            VkShaderModuleCreateInfo l_CreateInfo{};
+            l_CreateInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+            l_CreateInfo.codeSize = l_Code->second.size() * sizeof(uint32_t);
+            l_CreateInfo.pCode = l_Code->second.data();
+
+            VkShaderModule l_NewModule;
+            const VkResult l_Result = l_Device.getTable().vkCreateShaderModule(*l_Device, &l_CreateInfo, nullptr, &l_NewModule);
+            if (l_Result != VK_SUCCESS)
+            {
+                LOG_ERR("Failed to recreate shader module (ID:", l_Watched.module, ") for hot reload: ", string_VkResult(l_Result));
+                l_Failed = true;
+                continue;
+            }
+
+            l_NewModules.emplace_back(l_Module, l_NewModule);
+            l_SwappedModules.insert(l_Watched.module);
+        }
+    }
+
+    // Pipelines read the module handles from the device, so the new modules are put in place while the pipelines
+    // are built and taken back out afterwards
+    const auto l_ExchangeModules = [&l_NewModules]
+    {
+        for (auto& [l_Module, l_Handle] : l_NewModules)
+        {
+            std::swap(l_Module->m_VkHandle, l_Handle);
+        }
+    };
+
+    if (!l_Failed)
+    {
+        l_ExchangeModules();
+        for (const WatchedPipeline& l_Watched : m_Pipelines)
+        {
+            const bool l_Affected = l_Watched.builder
+                ? std::ranges::any_of(l_Watched.builder->m_ShaderStages, [&](const VulkanPipelineBuilder::ShaderData& p_Stage) { return l_SwappedModules.contains(p_Stage.shader); })
+                : l_SwappedModules.contains(l_Watched.computeShader);
+            VulkanPipeline* l_Pipeline = l_Device.getSubresource<VulkanPipeline>(l_Watched.pipeline);
+            if (!l_Affected || !l_Pipeline)
+            {
+                continue;
+            }
+
+            try
+            {
+                const VkPipeline l_NewPipeline = l_Watched.builder
+                    ? l_Device.buildGraphicsPipeline(*l_Watched.builder, l_Pipeline->m_Layout, l_Pipeline->m_RenderPass, l_Pipeline->m_Subpass)
+                    : l_Device.buildComputePipeline(l_Pipeline->m_Layout, l_Watched.computeShader, l_Watched.entrypoint, l_Watched.specialization);
+                l_NewPipelines.emplace_back(l_Pipeline, l_NewPipeline);
+            }
+            catch (const std::exception& l_Exception)
+            {
+                LOG_ERR("Failed to rebuild pipeline (ID:", l_Watched.pipeline, ") for hot reload: ", l_Exception.what());
+                l_Failed = true;
+            }
+        }
+        l_ExchangeModules();
+    }
+
+    const uint32_t l_Count = static_cast<uint32_t>(m_Ready.size());
+    m_Ready.clear();
+
+    if (l_Failed)
+    {
+        // Nothing new was ever used by the GPU, so it can go right away
+        for (const auto& [l_Module, l_Handle] : l_NewModules)
+        {
+            destroyHandle({m_Frame, l_Handle, VK_NULL_HANDLE});
+        }
+        for (const auto& [l_Pipeline, l_Handle] : l_NewPipelines)
+        {
+            destroyHandle({m_Frame, VK_NULL_HANDLE, l_Handle});
+        }
+        LOG_WARN("Hot reload of ", l_Count, " shader(s) failed, keeping the previous modules and pipelines");
+        return 0;
+    }
+
+    for (const auto& [l_Module, l_Handle] : l_NewModules)
+    {
+        m_Retired.push_back({m_Frame, l_Module->m_VkHandle, VK_NULL_HANDLE});
+        l_Module->m_VkHandle = l_Handle;
+    }
+    for (const auto& [l_Pipeline, l_Handle] : l_NewPipelines)
+    {
+        m_Retired.push_back({m_Frame, VK_NULL_HANDLE, l_Pipeline->m_VkHandle});
+        l_Pipeline->m_VkHandle = l_Handle;
+    }
+
+    LOG_DEBUG("Hot reloaded ", l_Count, " shader(s), swapped ", l_SwappedModules.size(), " module(s) and ", l_NewPipelines.size(), " pipeline(s)");
+    return l_Count;
+}
+
+void VulkanShaderHotReloader::flushRetired()
+{
+    for (const RetiredHandle& l_Handle : m_Retired)
+    {
+        destroyHandle(l_Handle);
+    }
+    m_Retired.clear();
+}
+
+size_t VulkanShaderHotReloader::getWatchedFileCount() const
+{
+    std::scoped_lock l_Lock(m_Mutex);
+    return m_Dependents.size();
+}
+
+void VulkanShaderHotReloader::watcherLoop()
+{
+    while (!m_Stop)
+    {
+        const std::vector<std::string> l_Changed = waitForChanges();
+        if (l_Changed.empty())
+        {
+            continue;
+        }
+
+        std::unordered_set<uint32_t> l_Affected;
+        {
+            std::scoped_lock l_Lock(m_Mutex);
+            for (const std::string& l_File : l_Changed)
+            {
+                if (const auto l_It = m_Dependents.find(l_File); l_It != m_Dependents.end())
+                {
+                    l_Affected.insert(l_It->second.begin(), l_It->second.end());
+                }
+            }
+        }
+
+        for (const uint32_t l_Shader : l_Affected)
+        {
+            recompile(l_Shader);
+        }
+    }
+}
+
+std::vector<std::string> VulkanShaderHotReloader::waitForChanges()
+{
+    std::vector<std::string> l_Changed;
+    std::error_code l_Error;
+#ifdef __linux__
+    pollfd l_Poll{m_INotify, POLLIN, 0};
+    if (poll(&l_Poll, 1, 100) <= 0)
+    {
+        return l_Changed;
+    }
+
+    // Editors tend to save in several steps, give them a moment so a save triggers one recompilation
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    alignas(inotify_event) char l_Buffer[4096];
+    ssize_t l_Length;
+    while ((l_Length = read(m_INotify, l_Buffer, sizeof(l_Buffer))) > 0)
+    {
+        for (ssize_t l_Offset = 0; l_Offset < l_Length;)
+        {
+            const inotify_event* l_Event = reinterpret_cast<const inotify_event*>(l_Buffer + l_Offset);
+            l_Offset += static_cast<ssize_t>(sizeof(inotify_event) + l_Event->len);
+            if (l_Event->len == 0)
+            {
+                continue;
+            }
+
+            std::scoped_lock l_Lock(m_Mutex);
+            if (const auto l_It = m_WatchDescriptors.find(l_Event->wd); l_It != m_WatchDescriptors.end())
+            {
+                l_Changed.push_back(std::filesystem::weakly_canonical(l_It->second / l_Event->name, l_Error).string());
+            }
+        }
+    }
+#else
+    std::this_thread::sleep_for(std::chrono::milliseconds(250));
+
+    std::scoped_lock l_Lock(m_Mutex);
+    for (const std::string& l_File : m_Dependents | std::views::keys)
+    {
+        const std::filesystem::file_time_type l_Time = std::filesystem::last_write_time(l_File, l_Error);
+        if (l_Error)
+        {
+            continue;
+        }
+        const auto [l_It, l_Inserted] = m_Timestamps.try_emplace(l_File, l_Time);
+        if (!l_Inserted && l_It->second != l_Time)
+        {
+            l_It->second = l_Time;
+            l_Changed.push_back(l_File);
+        }
+    }
+#endif
+    return l_Changed;
+}
+
+void VulkanShaderHotReloader::recompile(const uint32_t p_Shader)
+{
+    Source l_Source;
+    std::vector<VkShaderStageFlagBits> l_Stages;
+    {
+        std::scoped_lock l_Lock(m_Mutex);
+        l_Source = m_Shaders[p_Shader].source;
+        for (const WatchedModule& l_Module : m_Shaders[p_Shader].modules)
+        {
+            l_Stages.push_back(l_Module.stage);
+        }
+    }
+
+    LOG_DEBUG("Recompiling shader ", l_Source.filename, " for hot reload");
+    VulkanShader l_Shader{m_CompilationThread, l_Source.optimize, l_Source.macros};
+    for (const std::string& l_Path : l_Source.searchPaths)
+    {
+        l_Shader.addSearchPath(l_Path);
+    }
+    l_Shader.loadModule(l_Source.filename, l_Source.moduleName);
+    l_Shader.linkAndFinalize();
+
+    CompiledShader l_Compiled{p_Shader, {}};
+    for (const VkShaderStageFlagBits l_Stage : l_Stages)
+    {
+        if (l_Shader.getStatus().status != VulkanShader::Result::COMPILED)
+        {
+            break;
+        }
+        const std::span<const uint32_t> l_Code = l_Shader.getSPIRVForStage(l_Stage);
+        l_Compiled.stages.emplace_back(l_Stage, std::vector<uint32_t>{l_Code.begin(), l_Code.end()});
+    }
+
+    // Imports may have changed even if the edit broke the shader, so the graph is refreshed either way
+    updateDependencies(p_Shader);
+
+    if (l_Shader.getStatus().status != VulkanShader::Result::COMPILED)
+    {
+        LOG_ERR("Hot reload of ", l_Source.filename, " failed, keeping the previous version -> ", l_Shader.getStatus().error);
+        return;
+    }
+
+    std::scoped_lock l_Lock(m_Mutex);
+    std::erase_if(m_Ready, [p_Shader](const CompiledShader& p_Pending) { return p_Pending.shader == p_Shader; });
+    m_Ready.push_back(std::move(l_Compiled));
+}
+
+void VulkanShaderHotReloader::updateDependencies(const uint32_t p_Shader)
+{
+    Source l_Source;
+    {
+        std::scoped_lock l_Lock(m_Mutex);
+        l_Source = m_Shaders[p_Shader].source;
+    }
+
+    std::error_code l_Error;
+    const std::filesystem::path l_Root = std::filesystem::weakly_canonical(l_Source.filename, l_Error);
+    std::ifstream l_File(l_Root, std::ios::binary);
+    std::stringstream l_Stream;
+    l_Stream << l_File.rdbuf();
+
+    const std::unordered_set<std::string> l_SearchPaths{l_Source.searchPaths.begin(), l_Source.searchPaths.end()};
+    std::vector<std::string> l_Files{l_Root.string()};
+    for (const std::filesystem::path& l_Dependency : VulkanShaderCache::collectDependencies(l_Stream.str(), l_Root.parent_path(), l_SearchPaths))
+    {
+        l_Files.push_back(l_Dependency.string());
+    }
+
+    std::scoped_lock l_Lock(m_Mutex);
+    WatchedShader& l_Shader = m_Shaders[p_Shader];
+    for (const std::string& l_Old : l_Shader.files)
+    {
+        if (const auto l_It = m_Dependents.find(l_Old); l_It != m_Dependents.end())
+        {
+            l_It->second.erase(p_Shader);
+            if (l_It->second.empty())
+            {
+                m_Dependents.erase(l_It);
+            }
+        }
+    }
+    for (const std::string& l_New : l_Files)
+    {
+        m_Dependents[l_New].insert(p_Shader);
+        watchDirectory(std::filesystem::path{l_New}.parent_path());
+    }
+    l_Shader.files = std::move(l_Files);
+}
+
+void VulkanShaderHotReloader::watchDirectory(const std::filesystem::path& p_Directory)
+{
+    std::error_code l_Error;
+    const std::filesystem::path l_Directory = std::filesystem::weakly_canonical(p_Directory, l_Error);
+    if (!m_WatchedDirectories.insert(l_Directory.string()).second)
+    {
+        return;
+    }
+
+#ifdef __linux__
+    // Watching the directory instead of the file also catches editors that save by renaming a new file over the old one
+    const int l_Descriptor = inotify_add_watch(m_INotify, l_Directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+    if (l_Descriptor < 0)
+    {
+        LOG_WARN("Failed to watch shader directory ", l_Directory.string());
+        m_WatchedDirectories.erase(l_Directory.string());
+        return;
+    }
+    m_WatchDescriptors[l_Descriptor] = l_Directory;
+#endif
+    LOG_DEBUG("Watching shader directory ", l_Directory.string());
+}
+
+void VulkanShaderHotReloader::destroyHandle(const RetiredHandle& p_Handle) const
+{
+    const VulkanDevice& l_Device = VulkanContext::getDevice(m_Device);
+    if (p_Handle.module != VK_NULL_HANDLE)
+    {
+        l_Device.getTable().vkDestroyShaderModule(*l_Device, p_Handle.module, nullptr);
+    }
+    if (p_Handle.pipeline != VK_NULL_HANDLE)
+    {
+        l_Device.getTable().vkDestroyPipeline(*l_Device, p_Handle.pipeline, nullptr);
+    }
+}
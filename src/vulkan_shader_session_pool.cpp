@@ -0,0 +1,234 @@
+#include "vulkan_shader_session_pool.hpp"
+
+#include <algorithm>
+#include <ranges>
+#include <stdexcept>
+#include <slang/slang.h>
+
+#include "utils/logger.hpp"
+
+void VulkanShaderSessionPool::prewarm(const uint32_t p_Count, const Mode p_Mode)
+{
+    std::scoped_lock l_Lock(s_Mutex);
+    const bool l_HasSessions = !s_Idle.empty() || !s_Pending.empty() || !s_Leased.empty() || s_Shared.valid();
+    if (l_HasSessions && p_Mode != s_Mode)
+    {
+        throw std::runtime_error("Cannot change the Slang session pool mode while it holds sessions");
+    }
+    s_Mode = p_Mode;
+
+    if (p_Mode == Mode::SHARED)
+    {
+        if (!s_Shared.valid())
+        {
+            s_Shared = std::async(std::launch::async, &VulkanShaderSessionPool::createGlobalSession).share();
+        }
+        LOG_DEBUG("Prewarming shared Slang global session");
+        return;
+    }
+
+    for (uint32_t i = 0; i < p_Count; i++)
+    {
+        s_Pending.push_back(std::async(std::launch::async, &VulkanShaderSessionPool::createGlobalSession));
+    }
+    LOG_DEBUG("Prewarming ", p_Count, " Slang global session(s)");
+}
+
+slang::IGlobalSession* VulkanShaderSessionPool::acquire(const ThreadID p_Thread)
+{
+    std::unique_lock l_Lock(s_Mutex);
+    if (const auto l_It = s_Leased.find(p_Thread); l_It != s_Leased.end())
+    {
+        return l_It->second;
+    }
+
+    slang::IGlobalSession* l_Session = nullptr;
+    if (s_Mode == Mode::SHARED)
+    {
+        if (!s_Shared.valid())
+        {
+            s_Shared = std::async(std::launch::deferred, &VulkanShaderSessionPool::createGlobalSession).share();
+        }
+        const std::shared_future<slang::IGlobalSession*> l_Shared = s_Shared;
+        l_Lock.unlock();
+        l_Session = l_Shared.get();
+    }
+    else if (!s_Idle.empty())
+    {
+        l_Session = s_Idle.back();
+        s_Idle.pop_back();
+        l_Lock.unlock();
+    }
+    else if (!s_Pending.empty())
+    {
+        std::future<slang::IGlobalSession*> l_Pending = std::move(s_Pending.back());
+        s_Pending.pop_back();
+        l_Lock.unlock();
+        l_Session = l_Pending.get();
+    }
+    else
+    {
+        l_Lock.unlock();
+        LOG_DEBUG("Slang session pool is empty, creating a global session for thread ", p_Thread, " inline");
+        l_Session = createGlobalSession();
+    }
+
+    if (!l_Session)
+    {
+        return nullptr;
+    }
+
+    l_Lock.lock();
+    s_Leased[p_Thread] = l_Session;
+    return l_Session;
+}
+
+void VulkanShaderSessionPool::release(const ThreadID p_Thread)
+{
+    std::scoped_lock l_Lock(s_Mutex);
+    const auto l_It = s_Leased.find(p_Thread);
+    if (l_It == s_Leased.end())
+    {
+        return;
+    }
+
+    slang::IGlobalSession* l_Session = l_It->second;
+    s_Leased.erase(l_It);
+    recycle(l_Session);
+}
+
+void VulkanShaderSessionPool::retainSession(slang::IGlobalSession* p_Session)
+{
+    std::scoped_lock l_Lock(s_Mutex);
+    s_SessionRefs[p_Session]++;
+}
+
+void VulkanShaderSessionPool::releaseSession(slang::IGlobalSession* p_Session)
+{
+    std::scoped_lock l_Lock(s_Mutex);
+    const auto l_It = s_SessionRefs.find(p_Session);
+    if (l_It == s_SessionRefs.end())
+    {
+        LOG_WARN("Released an ISession of a Slang global session that has none alive");
+        return;
+    }
+
+    if (--l_It->second == 0)
+    {
+        s_SessionRefs.erase(l_It);
+        recycle(p_Session);
+    }
+}
+
+void VulkanShaderSessionPool::shutdown()
+{
+    std::scoped_lock l_Lock(s_Mutex);
+    for (std::future<slang::IGlobalSession*>& l_Pending : s_Pending)
+    {
+        s_Idle.push_back(l_Pending.get());
+    }
+
+    // Sessions that are still leased or referenced by an ISession can't be found through the idle list
+    std::vector<slang::IGlobalSession*> l_Sessions = std::move(s_Idle);
+    for (slang::IGlobalSession* l_Session : s_Leased | std::views::values)
+    {
+        l_Sessions.push_back(l_Session);
+    }
+    for (slang::IGlobalSession* l_Session : s_SessionRefs | std::views::keys)
+    {
+        l_Sessions.push_back(l_Session);
+    }
+    if (s_Shared.valid())
+    {
+        l_Sessions.push_back(s_Shared.get());
+    }
+    std::ranges::sort(l_Sessions);
+    const auto l_Duplicates = std::ranges::unique(l_Sessions);
+    l_Sessions.erase(l_Duplicates.begin(), l_Duplicates.end());
+
+    size_t l_Count = 0;
+    for (slang::IGlobalSession* l_Session : l_Sessions)
+    {
+        if (!l_Session || std::ranges::find(s_Retired, l_Session) != s_Retired.end())
+        {
+            continue;
+        }
+        if (isInUse(l_Session))
+        {
+            s_Retired.push_back(l_Session);
+            continue;
+        }
+        l_Session->release();
+        l_Count++;
+    }
+    s_Idle.clear();
+    s_Pending.clear();
+    s_Shared = {};
+    LOG_DEBUG("Destroyed ", l_Count, " Slang global session(s)");
+    if (!s_Retired.empty())
+    {
+        LOG_WARN("Shutting down the Slang session pool with ", s_Retired.size(), " session(s) still in use, they will be destroyed once released");
+    }
+}
+
+std::unique_lock<std::mutex> VulkanShaderSessionPool::lockGlobalSession()
+{
+    if (getMode() == Mode::SHARED)
+    {
+        return std::unique_lock{s_SharedMutex};
+    }
+    return {};
+}
+
+VulkanShaderSessionPool::Mode VulkanShaderSessionPool::getMode()
+{
+    std::scoped_lock l_Lock(s_Mutex);
+    return s_Mode;
+}
+
+size_t VulkanShaderSessionPool::getIdleCount()
+{
+    std::scoped_lock l_Lock(s_Mutex);
+    return s_Idle.size() + s_Pending.size();
+}
+
+size_t VulkanShaderSessionPool::getLeasedCount()
+{
+    std::scoped_lock l_Lock(s_Mutex);
+    return s_Leased.size();
+}
+
+void VulkanShaderSessionPool::recycle(slang::IGlobalSession* p_Session)
+{
+    if (isInUse(p_Session))
+    {
+        return;
+    }
+
+    if (const auto l_It = std::ranges::find(s_Retired, p_Session); l_It != s_Retired.end())
+    {
+        s_Retired.erase(l_It);
+        p_Session->release();
+        LOG_DEBUG("Destroyed a Slang global session that outlived the pool shutdown");
+    }
+    else if (s_Mode == Mode::PER_THREAD)
+    {
+        s_Idle.push_back(p_Session);
+    }
+}
+
+bool VulkanShaderSessionPool::isInUse(slang::IGlobalSession* p_Session)
+{
+    return s_SessionRefs.contains(p_Session) || std::ranges::any_of(s_Leased | std::views::values, [p_Session](const slang::IGlobalSession* p_Leased) { return p_Leased == p_Session; });
+}
+
+slang::IGlobalSession* VulkanShaderSessionPool::createGlobalSession()
+{
+    slang::IGlobalSession* l_Session = nullptr;
+    if (SLANG_FAILED(slang::createGlobalSession(&l_Session)))
+    {
+        LOG_ERR("Failed to create Slang global session");
+        return nullptr;
+    }
+    return l_Session;
+}
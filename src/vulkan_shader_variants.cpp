@@ -0,0 +1,232 @@
+#include "vulkan_shader_variants.hpp"
+
+#include <algorithm>
+#include <ranges>
+#include <stdexcept>
+
+#include "vulkan_context.hpp"
+#include "vulkan_device.hpp"
+#include "vulkan_shader_cache.hpp"
+#include "utils/logger.hpp"
+
+ResourceID VulkanShaderVariantManager::Variant::getModule(const VkShaderStageFlagBits p_Stage) const
+{
+    for (const auto& [l_Stage, l_Module] : modules)
+    {
+        if (l_Stage == p_Stage)
+        {
+            return l_Module;
+        }
+    }
+    return UINT32_MAX;
+}
+
+VulkanShaderVariantManager::VulkanShaderVariantManager(const ResourceID p_Device, VulkanShaderCompiler& p_Compiler, VulkanShaderCompiler::Request p_Base)
+    : m_Device(p_Device), m_Compiler(p_Compiler), m_Base(std::move(p_Base))
+{
+}
+
+void VulkanShaderVariantManager::addDimension(const std::string_view p_Macro, const std::span<const std::string> p_Values)
+{
+    if (p_Values.empty())
+    {
+        throw std::runtime_error("Shader variant dimension " + std::string{p_Macro} + " has no values");
+    }
+    m_Dimensions.emplace_back(std::string{p_Macro}, std::vector<std::string>{p_Values.begin(), p_Values.end()});
+}
+
+void VulkanShaderVariantManager::precompileAll()
+{
+    std::vector<Entry*> l_Submitted;
+    std::vector<size_t> l_Counters(m_Dimensions.size(), 0);
+    std::vector<VulkanShader::MacroDef> l_Macros(m_Dimensions.size());
+
+    bool l_Done = false;
+    while (!l_Done)
+    {
+        for (size_t i = 0; i < m_Dimensions.size(); i++)
+        {
+            l_Macros[i] = {m_Dimensions[i].first, m_Dimensions[i].second[l_Counters[i]]};
+        }
+
+        Entry& l_Entry = findOrSubmit(l_Macros);
+        if (l_Entry.pending.valid())
+        {
+            l_Submitted.push_back(&l_Entry);
+        }
+
+        // Advance the counters like an odometer, finishing once the last dimension wraps around
+        l_Done = true;
+        for (size_t i = 0; i < m_Dimensions.size(); i++)
+        {
+            if (++l_Counters[i] < m_Dimensions[i].second.size())
+            {
+                l_Done = false;
+                break;
+            }
+            l_Counters[i] = 0;
+        }
+    }
+
+    std::vector<std::future<VulkanShaderCompiler::Output>> l_Futures;
+    l_Futures.reserve(l_Submitted.size());
+    for (Entry* l_Entry : l_Submitted)
+    {
+        l_Futures.push_back(std::move(l_Entry->pending));
+    }
+    m_Compiler.consume(l_Futures, [this, &l_Submitted](const size_t p_Index, VulkanShaderCompiler::Output&& p_Output)
+    {
+        finalize(*l_Submitted[p_Index], std::move(p_Output));
+    });
+    LOG_DEBUG("Precompiled ", l_Submitted.size(), " shader variant(s) of ", m_Base.filename);
+}
+
+void VulkanShaderVariantManager::prefetch(const std::span<const VulkanShader::MacroDef> p_Macros)
+{
+    (void)findOrSubmit(p_Macros);
+}
+
+const VulkanShaderVariantManager::Variant& VulkanShaderVariantManager::getVariant(const std::span<const VulkanShader::MacroDef> p_Macros)
+{
+    Entry& l_Entry = findOrSubmit(p_Macros);
+    if (l_Entry.pending.valid())
+    {
+        finalize(l_Entry, l_Entry.pending.get());
+    }
+    return l_Entry.variant;
+}
+
+void VulkanShaderVariantManager::addStages(VulkanPipelineBuilder& p_Builder, const std::span<const VulkanShader::MacroDef> p_Macros, const VulkanSpecialization& p_Specialization, const std::string_view p_Entrypoint)
+{
+    const Variant& l_Variant = getVariant(p_Macros);
+    if (!l_Variant.compiled)
+    {
+        throw std::runtime_error("Shader variant of " + m_Base.filename + " failed to compile: " + l_Variant.error);
+    }
+
+    for (const ResourceID l_Module : l_Variant.modules | std::views::values)
+    {
+        p_Builder.addShaderStage(l_Module, p_Entrypoint, p_Specialization);
+    }
+}
+
+void VulkanShaderVariantManager::free()
+{
+    VulkanDevice& l_Device = VulkanContext::getDevice(m_Device);
+    for (Entry& l_Entry : m_Variants | std::views::values)
+    {
+        if (l_Entry.pending.valid())
+        {
+            l_Entry.pending.wait();
+        }
+        for (const ResourceID l_Module : l_Entry.variant.modules | std::views::values)
+        {
+            l_Device.freeShaderModule(l_Module);
+        }
+    }
+    m_Variants.clear();
+}
+
+size_t VulkanShaderVariantManager::getCompiledCount() const
+{
+    return std::ranges::count_if(m_Variants | std::views::values, [](const Entry& p_Entry) { return p_Entry.variant.compiled; });
+}
+
+size_t VulkanShaderVariantManager::getPermutationCount() const
+{
+    size_t l_Count = 1;
+    for (const std::vector<std::string>& l_Values : m_Dimensions | std::views::values)
+    {
+        l_Count *= l_Values.size();
+    }
+    return l_Count;
+}
+
+std::vector<VulkanShader::MacroDef> VulkanShaderVariantManager::normalize(const std::span<const VulkanShader::MacroDef> p_Macros) const
+{
+    std::vector<VulkanShader::MacroDef> l_Macros = m_Base.macros;
+    for (const VulkanShader::MacroDef& l_Macro : p_Macros)
+    {
+        const auto l_Existing = std::ranges::find(l_Macros, l_Macro.name, &VulkanShader::MacroDef::name);
+        if (l_Existing != l_Macros.end())
+        {
+            l_Existing->value = l_Macro.value;
+        }
+        else
+        {
+            l_Macros.push_back(l_Macro);
+        }
+    }
+    std::ranges::sort(l_Macros, {}, &VulkanShader::MacroDef::name);
+    return l_Macros;
+}
+
+uint64_t VulkanShaderVariantManager::hashMacros(const std::span<const VulkanShader::MacroDef> p_Macros)
+{
+    uint64_t l_Hash = VulkanShaderCache::HASH_SEED;
+    for (const VulkanShader::MacroDef& l_Macro : p_Macros)
+    {
+        // The separators keep {"AB", "C"} and {"A", "BC"} apart
+        l_Hash = VulkanShaderCache::hash(l_Macro.name, l_Hash);
+        l_Hash = VulkanShaderCache::hash(std::string_view{"=", 1}, l_Hash);
+        l_Hash = VulkanShaderCache::hash(l_Macro.value, l_Hash);
+        l_Hash = VulkanShaderCache::hash(std::string_view{";", 1}, l_Hash);
+    }
+    return l_Hash;
+}
+
+VulkanShaderVariantManager::Entry& VulkanShaderVariantManager::findOrSubmit(const std::span<const VulkanShader::MacroDef> p_Macros)
+{
+    std::vector<VulkanShader::MacroDef> l_Macros = normalize(p_Macros);
+    const uint64_t l_Key = hashMacros(l_Macros);
+
+    const auto l_It = m_Variants.find(l_Key);
+    if (l_It != m_Variants.end())
+    {
+        const bool l_Same = std::ranges::equal(l_It->second.macros, l_Macros, [](const VulkanShader::MacroDef& p_A, const VulkanShader::MacroDef& p_B)
+        {
+            return p_A.name == p_B.name && p_A.value == p_B.value;
+        });
+        if (!l_Same)
+        {
+            throw std::runtime_error("Shader variant key collision in " + m_Base.filename);
+        }
+
+        // Failed variants are retried, the source may have been fixed since
+        Entry& l_Existing = l_It->second;
+        if (!l_Existing.variant.compiled && !l_Existing.pending.valid())
+        {
+            VulkanShaderCompiler::Request l_Request = m_Base;
+            l_Request.macros = l_Existing.macros;
+            l_Existing.pending = m_Compiler.submit(std::move(l_Request));
+        }
+        return l_Existing;
+    }
+
+    VulkanShaderCompiler::Request l_Request = m_Base;
+    l_Request.macros = l_Macros;
+
+    Entry& l_Entry = m_Variants[l_Key];
+    l_Entry.macros = std::move(l_Macros);
+    l_Entry.pending = m_Compiler.submit(std::move(l_Request));
+    return l_Entry;
+}
+
+void VulkanShaderVariantManager::finalize(Entry& p_Entry, VulkanShaderCompiler::Output&& p_Output) const
+{
+    if (p_Output.result.status == VulkanShader::Result::FAILED)
+    {
+        LOG_ERR("Shader variant of ", m_Base.filename, " failed to compile: ", p_Output.result.error);
+        p_Entry.variant.error = std::move(p_Output.result.error);
+        return;
+    }
+
+    VulkanDevice& l_Device = VulkanContext::getDevice(m_Device);
+    for (const VulkanShaderCompiler::StageCode& l_Stage : p_Output.stages)
+    {
+        p_Entry.variant.modules.emplace_back(l_Stage.stage, l_Device.createShaderModule(l_Stage.spirv, l_Stage.stage));
+    }
+    p_Entry.variant.reflection = std::move(p_Output.reflection);
+    p_Entry.variant.compiled = true;
+    p_Entry.variant.error.clear();
+}
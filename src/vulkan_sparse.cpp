@@ -0,0 +1,571 @@
+#include "vulkan_sparse.hpp"
+
+#include <algorithm>
+#include <ranges>
+#include <stdexcept>
+#include <vulkan/vk_enum_string_helper.h>
+
+#include "vulkan_context.hpp"
+#include "vulkan_device.hpp"
+#include "utils/logger.hpp"
+#include "utils/vulkan_base.hpp"
+
+VulkanSparseResidencyManager::VulkanSparseResidencyManager(const ResourceID p_Device, const QueueSelection& p_SparseQueue)
+    : m_Device(p_Device), m_Queue(p_SparseQueue)
+{
+    VulkanDevice& l_Device = VulkanContext::getDevice(m_Device);
+    const QueueFamily l_Family = l_Device.getGPU().getQueueFamilies().getQueueFamily(m_Queue.familyIndex);
+    if ((l_Family.properties.queueFlags & VK_QUEUE_SPARSE_BINDING_BIT) == 0)
+    {
+        throw std::runtime_error("Queue family " + std::to_string(m_Queue.familyIndex) + " does not support sparse binding");
+    }
+
+    m_Fence = l_Device.createFence(true);
+}
+
+VulkanSparseResidencyManager::~VulkanSparseResidencyManager()
+{
+    waitIdle();
+
+    VulkanDevice& l_Device = VulkanContext::getDevice(m_Device);
+    const VulkanMemoryAllocator& l_Allocator = l_Device.getMemoryAllocator();
+    m_RetiredPages.insert(m_RetiredPages.end(), m_UnboundPages.begin(), m_UnboundPages.end());
+    for (const BufferTable& l_Table : m_Buffers | std::views::values)
+    {
+        m_RetiredPages.insert(m_RetiredPages.end(), l_Table.pages.begin(), l_Table.pages.end());
+    }
+    for (const ImageTable& l_Table : m_Images | std::views::values)
+    {
+        for (const AspectTable& l_Aspect : l_Table.aspects)
+        {
+            m_RetiredPages.insert(m_RetiredPages.end(), l_Aspect.tiles.begin(), l_Aspect.tiles.end());
+        }
+        m_RetiredPages.insert(m_RetiredPages.end(), l_Table.mipTail.begin(), l_Table.mipTail.end());
+    }
+    std::erase(m_RetiredPages, VK_NULL_HANDLE);
+    vmaFreeMemoryPages(*l_Allocator, m_RetiredPages.size(), m_RetiredPages.data());
+
+    l_Device.freeFence(m_Fence);
+}
+
+void VulkanSparseResidencyManager::registerBuffer(const ResourceID p_Buffer)
+{
+    const VulkanBuffer& l_Buffer = VulkanContext::getDevice(m_Device).getBuffer(p_Buffer);
+    if (l_Buffer.isMemoryBound())
+    {
+        throw std::runtime_error("Buffer (ID:" + std::to_string(p_Buffer) + ") has memory bound and cannot be managed as a sparse resource");
+    }
+
+    BufferTable& l_Table = m_Buffers[p_Buffer];
+    l_Table.requirements = l_Buffer.getMemoryRequirements();
+    l_Table.pages.assign((l_Table.requirements.size + l_Table.requirements.alignment - 1) / l_Table.requirements.alignment, VK_NULL_HANDLE);
+    LOG_DEBUG("Registered sparse buffer (ID:", p_Buffer, ") with ", l_Table.pages.size(), " page(s) of ", VulkanMemoryAllocator::compactBytes(l_Table.requirements.alignment));
+}
+
+void VulkanSparseResidencyManager::registerImage(const ResourceID p_Image)
+{
+    const VulkanDevice& l_Device = VulkanContext::getDevice(m_Device);
+    const VulkanImage& l_Image = l_Device.getImage(p_Image);
+    if (l_Image.isMemoryBound())
+    {
+        throw std::runtime_error("Image (ID:" + std::to_string(p_Image) + ") has memory bound and cannot be managed as a sparse resource");
+    }
+
+    uint32_t l_RequirementCount = 0;
+    l_Device.getTable().vkGetImageSparseMemoryRequirements(*l_Device, *l_Image, &l_RequirementCount, nullptr);
+    TRANS_VECTOR(l_Requirements, VkSparseImageMemoryRequirements);
+    l_Requirements.resize(l_RequirementCount);
+    l_Device.getTable().vkGetImageSparseMemoryRequirements(*l_Device, *l_Image, &l_RequirementCount, l_Requirements.data());
+
+    const auto l_IsMetadata = [](const VkSparseImageMemoryRequirements& p_Reqs) { return (p_Reqs.formatProperties.aspectMask & VK_IMAGE_ASPECT_METADATA_BIT) != 0; };
+    if (std::ranges::all_of(l_Requirements, l_IsMetadata))
+    {
+        throw std::runtime_error("Image (ID:" + std::to_string(p_Image) + ") was not created with sparse residency");
+    }
+
+    ImageTable& l_Table = m_Images[p_Image];
+    l_Table.requirements = l_Image.getMemoryRequirements();
+    l_Table.extent = l_Image.getSize();
+    l_Table.arrayLayers = l_Image.getArrayLayers();
+
+    size_t l_TileCount = 0;
+    for (const VkSparseImageMemoryRequirements& l_Reqs : l_Requirements)
+    {
+        if (l_IsMetadata(l_Reqs))
+        {
+            continue;
+        }
+
+        AspectTable& l_Aspect = l_Table.aspects.emplace_back();
+        l_Aspect.sparseRequirements = l_Reqs;
+        const uint32_t l_TiledLevels = std::min(l_Reqs.imageMipTailFirstLod, l_Image.getMipLevels());
+        for (uint32_t i = 0; i < l_TiledLevels; i++)
+        {
+            const VkExtent3D l_Tiles = getLevelTiles(l_Table, l_Aspect, i);
+            l_Aspect.levelOffsets.push_back(l_Aspect.tilesPerLayer);
+            l_Aspect.tilesPerLayer += l_Tiles.width * l_Tiles.height * l_Tiles.depth;
+        }
+        l_Aspect.tiles.assign(static_cast<size_t>(l_Aspect.tilesPerLayer) * l_Table.arrayLayers, VK_NULL_HANDLE);
+        l_TileCount += l_Aspect.tiles.size();
+    }
+
+    // The mip tail cannot be bound per tile, so it stays resident for the lifetime of the image
+    for (const VkSparseImageMemoryRequirements& l_Reqs : l_Requirements)
+    {
+        if (l_IsMetadata(l_Reqs))
+        {
+            bindImageMipTail(p_Image, l_Table, l_Reqs, VK_SPARSE_MEMORY_BIND_METADATA_BIT);
+        }
+        else if (l_Reqs.imageMipTailFirstLod < l_Image.getMipLevels())
+        {
+            bindImageMipTail(p_Image, l_Table, l_Reqs, 0);
+        }
+    }
+
+    const VkExtent3D l_Granularity = l_Table.aspects.front().sparseRequirements.formatProperties.imageGranularity;
+    LOG_DEBUG("Registered sparse image (ID:", p_Image, ") with ", l_TileCount, " tile(s) over ", l_Table.aspects.size(), " aspect(s), first tile size ", l_Granularity.width, "x", l_Granularity.height, "x", l_Granularity.depth);
+}
+
+void VulkanSparseResidencyManager::release(const ResourceID p_Resource)
+{
+    if (const auto l_It = m_Buffers.find(p_Resource); l_It != m_Buffers.end())
+    {
+        for (const VmaAllocation l_Page : l_It->second.pages)
+        {
+            if (l_Page != VK_NULL_HANDLE)
+            {
+                retirePage(l_Page, l_It->second.requirements.alignment);
+            }
+        }
+        m_Buffers.erase(l_It);
+    }
+    else if (const auto l_ImageIt = m_Images.find(p_Resource); l_ImageIt != m_Images.end())
+    {
+        for (const AspectTable& l_Aspect : l_ImageIt->second.aspects)
+        {
+            for (const VmaAllocation l_Page : l_Aspect.tiles)
+            {
+                if (l_Page != VK_NULL_HANDLE)
+                {
+                    retirePage(l_Page, l_ImageIt->second.requirements.alignment);
+                }
+            }
+        }
+        for (const VmaAllocation l_Page : l_ImageIt->second.mipTail)
+        {
+            retirePage(l_Page, VulkanContext::getDevice(m_Device).getMemoryAllocator().getAllocationInfo(l_Page).size);
+        }
+        m_Images.erase(l_ImageIt);
+    }
+    else
+    {
+        LOG_WARN("Tried to release resource (ID:", p_Resource, ") that is not managed by the sparse residency manager");
+        return;
+    }
+
+    m_PendingBufferBinds.erase(p_Resource);
+    m_PendingOpaqueBinds.erase(p_Resource);
+    m_PendingImageBinds.erase(p_Resource);
+}
+
+VkDeviceSize VulkanSparseResidencyManager::getBufferPageSize(const ResourceID p_Buffer) const
+{
+    return getBufferTable(p_Buffer).requirements.alignment;
+}
+
+void VulkanSparseResidencyManager::makeBufferResident(const ResourceID p_Buffer, const VkDeviceSize p_Offset, const VkDeviceSize p_Size)
+{
+    BufferTable& l_Table = const_cast<BufferTable&>(getBufferTable(p_Buffer));
+    const VkDeviceSize l_PageSize = l_Table.requirements.alignment;
+    const size_t l_First = p_Offset / l_PageSize;
+    const size_t l_Last = std::min((p_Offset + p_Size + l_PageSize - 1) / l_PageSize, l_Table.pages.size());
+
+    TRANS_VECTOR(l_Missing, size_t);
+    for (size_t i = l_First; i < l_Last; i++)
+    {
+        if (l_Table.pages[i] == VK_NULL_HANDLE)
+        {
+            l_Missing.push_back(i);
+        }
+    }
+    if (l_Missing.empty())
+    {
+        return;
+    }
+
+    const std::vector<VmaAllocation> l_Pages = allocatePages(l_Table.requirements, l_PageSize, l_Missing.size());
+    const VulkanMemoryAllocator& l_Allocator = VulkanContext::getDevice(m_Device).getMemoryAllocator();
+    std::vector<VkSparseMemoryBind>& l_Binds = m_PendingBufferBinds[p_Buffer];
+    for (size_t i = 0; i < l_Missing.size(); i++)
+    {
+        const VkDeviceSize l_ResourceOffset = l_Missing[i] * l_PageSize;
+        const VmaAllocationInfo l_Info = l_Allocator.getAllocationInfo(l_Pages[i]);
+        l_Binds.push_back({l_ResourceOffset, std::min(l_PageSize, l_Table.requirements.size - l_ResourceOffset), l_Info.deviceMemory, l_Info.offset, 0});
+        l_Table.pages[l_Missing[i]] = l_Pages[i];
+    }
+}
+
+void VulkanSparseResidencyManager::evictBuffer(const ResourceID p_Buffer, const VkDeviceSize p_Offset, const VkDeviceSize p_Size)
+{
+    BufferTable& l_Table = const_cast<BufferTable&>(getBufferTable(p_Buffer));
+    const VkDeviceSize l_PageSize = l_Table.requirements.alignment;
+
+    // Only pages fully inside the range are evicted, partially covered ones may still hold live data
+    const size_t l_First = (p_Offset + l_PageSize - 1) / l_PageSize;
+    const size_t l_Last = std::min((p_Offset + p_Size) / l_PageSize + ((p_Offset + p_Size) >= l_Table.requirements.size ? 1 : 0), l_Table.pages.size());
+
+    std::vector<VkSparseMemoryBind>& l_Binds = m_PendingBufferBinds[p_Buffer];
+    for (size_t i = l_First; i < l_Last; i++)
+    {
+        if (l_Table.pages[i] == VK_NULL_HANDLE)
+        {
+            continue;
+        }
+        const VkDeviceSize l_ResourceOffset = i * l_PageSize;
+        l_Binds.push_back({l_ResourceOffset, std::min(l_PageSize, l_Table.requirements.size - l_ResourceOffset), VK_NULL_HANDLE, 0, 0});
+        retirePage(l_Table.pages[i], l_PageSize);
+        l_Table.pages[i] = VK_NULL_HANDLE;
+    }
+}
+
+bool VulkanSparseResidencyManager::isBufferResident(const ResourceID p_Buffer, const VkDeviceSize p_Offset, const VkDeviceSize p_Size) const
+{
+    const BufferTable& l_Table = getBufferTable(p_Buffer);
+    const VkDeviceSize l_PageSize = l_Table.requirements.alignment;
+    const size_t l_Last = std::min((p_Offset + p_Size + l_PageSize - 1) / l_PageSize, l_Table.pages.size());
+    for (size_t i = p_Offset / l_PageSize; i < l_Last; i++)
+    {
+        if (l_Table.pages[i] == VK_NULL_HANDLE)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+VkExtent3D VulkanSparseResidencyManager::getImageTileExtent(const ResourceID p_Image) const
+{
+    return getImageTable(p_Image).aspects.front().sparseRequirements.formatProperties.imageGranularity;
+}
+
+uint32_t VulkanSparseResidencyManager::getImageMipTailFirstLevel(const ResourceID p_Image) const
+{
+    const std::vector<AspectTable>& l_Aspects = getImageTable(p_Image).aspects;
+    return std::ranges::min(l_Aspects | std::views::transform([](const AspectTable& p_Aspect) { return p_Aspect.sparseRequirements.imageMipTailFirstLod; }));
+}
+
+void VulkanSparseResidencyManager::makeImageResident(const ResourceID p_Image, const uint32_t p_MipLevel, const uint32_t p_ArrayLayer, const VkOffset3D p_Offset, const VkExtent3D p_Extent)
+{
+    ImageTable& l_Table = const_cast<ImageTable&>(getImageTable(p_Image));
+    for (AspectTable& l_Aspect : l_Table.aspects)
+    {
+        makeAspectResident(p_Image, l_Table, l_Aspect, p_MipLevel, p_ArrayLayer, p_Offset, p_Extent);
+    }
+}
+
+void VulkanSparseResidencyManager::evictImage(const ResourceID p_Image, const uint32_t p_MipLevel, const uint32_t p_ArrayLayer, const VkOffset3D p_Offset, const VkExtent3D p_Extent)
+{
+    ImageTable& l_Table = const_cast<ImageTable&>(getImageTable(p_Image));
+    for (AspectTable& l_Aspect : l_Table.aspects)
+    {
+        evictAspect(p_Image, l_Table, l_Aspect, p_MipLevel, p_ArrayLayer, p_Offset, p_Extent);
+    }
+}
+
+bool VulkanSparseResidencyManager::isImageResident(const ResourceID p_Image, const uint32_t p_MipLevel, const uint32_t p_ArrayLayer, const VkOffset3D p_Offset, const VkExtent3D p_Extent) const
+{
+    const ImageTable& l_Table = getImageTable(p_Image);
+    return std::ranges::all_of(l_Table.aspects, [&](const AspectTable& p_Aspect) { return isAspectResident(l_Table, p_Aspect, p_MipLevel, p_ArrayLayer, p_Offset, p_Extent); });
+}
+
+void VulkanSparseResidencyManager::makeAspectResident(const ResourceID p_Image, const ImageTable& p_Table, AspectTable& p_Aspect, const uint32_t p_MipLevel, const uint32_t p_ArrayLayer, const VkOffset3D p_Offset, const VkExtent3D p_Extent)
+{
+    if (p_MipLevel >= p_Aspect.levelOffsets.size())
+    {
+        return;
+    }
+
+    const VkExtent3D l_Granularity = p_Aspect.sparseRequirements.formatProperties.imageGranularity;
+    const VkExtent3D l_LevelTiles = getLevelTiles(p_Table, p_Aspect, p_MipLevel);
+    const VkExtent3D l_LevelExtent = {std::max(1U, p_Table.extent.width >> p_MipLevel), std::max(1U, p_Table.extent.height >> p_MipLevel), std::max(1U, p_Table.extent.depth >> p_MipLevel)};
+    const TileRange l_Range = getTileRange(p_Table, p_Aspect, p_MipLevel, p_Offset, p_Extent);
+    const size_t l_Base = static_cast<size_t>(p_ArrayLayer) * p_Aspect.tilesPerLayer + p_Aspect.levelOffsets[p_MipLevel];
+
+    TRANS_VECTOR(l_Missing, size_t);
+    for (uint32_t z = l_Range.begin[2]; z < l_Range.end[2]; z++)
+    {
+        for (uint32_t y = l_Range.begin[1]; y < l_Range.end[1]; y++)
+        {
+            for (uint32_t x = l_Range.begin[0]; x < l_Range.end[0]; x++)
+            {
+                const size_t l_Index = l_Base + (static_cast<size_t>(z) * l_LevelTiles.height + y) * l_LevelTiles.width + x;
+                if (p_Aspect.tiles[l_Index] == VK_NULL_HANDLE)
+                {
+                    l_Missing.push_back(l_Index);
+                }
+            }
+        }
+    }
+    if (l_Missing.empty())
+    {
+        return;
+    }
+
+    const std::vector<VmaAllocation> l_Pages = allocatePages(p_Table.requirements, p_Table.requirements.alignment, l_Missing.size());
+    const VulkanMemoryAllocator& l_Allocator = VulkanContext::getDevice(m_Device).getMemoryAllocator();
+    std::vector<VkSparseImageMemoryBind>& l_Binds = m_PendingImageBinds[p_Image];
+    for (size_t i = 0; i < l_Missing.size(); i++)
+    {
+        const size_t l_Local = l_Missing[i] - l_Base;
+        const uint32_t l_X = static_cast<uint32_t>(l_Local % l_LevelTiles.width);
+        const uint32_t l_Y = static_cast<uint32_t>(l_Local / l_LevelTiles.width % l_LevelTiles.height);
+        const uint32_t l_Z = static_cast<uint32_t>(l_Local / (static_cast<size_t>(l_LevelTiles.width) * l_LevelTiles.height));
+        const VkOffset3D l_TileOffset = {static_cast<int32_t>(l_X * l_Granularity.width), static_cast<int32_t>(l_Y * l_Granularity.height), static_cast<int32_t>(l_Z * l_Granularity.depth)};
+        const VkExtent3D l_TileExtent = {std::min(l_Granularity.width, l_LevelExtent.width - l_TileOffset.x), std::min(l_Granularity.height, l_LevelExtent.height - l_TileOffset.y), std::min(l_Granularity.depth, l_LevelExtent.depth - l_TileOffset.z)};
+
+        const VmaAllocationInfo l_Info = l_Allocator.getAllocationInfo(l_Pages[i]);
+        l_Binds.push_back({{p_Aspect.sparseRequirements.formatProperties.aspectMask, p_MipLevel, p_ArrayLayer}, l_TileOffset, l_TileExtent, l_Info.deviceMemory, l_Info.offset, 0});
+        p_Aspect.tiles[l_Missing[i]] = l_Pages[i];
+    }
+}
+
+void VulkanSparseResidencyManager::evictAspect(const ResourceID p_Image, const ImageTable& p_Table, AspectTable& p_Aspect, const uint32_t p_MipLevel, const uint32_t p_ArrayLayer, const VkOffset3D p_Offset, const VkExtent3D p_Extent)
+{
+    if (p_MipLevel >= p_Aspect.levelOffsets.size())
+    {
+        return;
+    }
+
+    const VkExtent3D l_Granularity = p_Aspect.sparseRequirements.formatProperties.imageGranularity;
+    const VkExtent3D l_LevelTiles = getLevelTiles(p_Table, p_Aspect, p_MipLevel);
+    const VkExtent3D l_LevelExtent = {std::max(1U, p_Table.extent.width >> p_MipLevel), std::max(1U, p_Table.extent.height >> p_MipLevel), std::max(1U, p_Table.extent.depth >> p_MipLevel)};
+    const TileRange l_Range = getTileRange(p_Table, p_Aspect, p_MipLevel, p_Offset, p_Extent);
+    const size_t l_Base = static_cast<size_t>(p_ArrayLayer) * p_Aspect.tilesPerLayer + p_Aspect.levelOffsets[p_MipLevel];
+
+    std::vector<VkSparseImageMemoryBind>& l_Binds = m_PendingImageBinds[p_Image];
+    for (uint32_t z = l_Range.begin[2]; z < l_Range.end[2]; z++)
+    {
+        for (uint32_t y = l_Range.begin[1]; y < l_Range.end[1]; y++)
+        {
+            for (uint32_t x = l_Range.begin[0]; x < l_Range.end[0]; x++)
+            {
+                const size_t l_Index = l_Base + (static_cast<size_t>(z) * l_LevelTiles.height + y) * l_LevelTiles.width + x;
+                if (p_Aspect.tiles[l_Index] == VK_NULL_HANDLE)
+                {
+                    continue;
+                }
+
+                const VkOffset3D l_TileOffset = {static_cast<int32_t>(x * l_Granularity.width), static_cast<int32_t>(y * l_Granularity.height), static_cast<int32_t>(z * l_Granularity.depth)};
+                const VkExtent3D l_TileExtent = {std::min(l_Granularity.width, l_LevelExtent.width - l_TileOffset.x), std::min(l_Granularity.height, l_LevelExtent.height - l_TileOffset.y), std::min(l_Granularity.depth, l_LevelExtent.depth - l_TileOffset.z)};
+                l_Binds.push_back({{p_Aspect.sparseRequirements.formatProperties.aspectMask, p_MipLevel, p_ArrayLayer}, l_TileOffset, l_TileExtent, VK_NULL_HANDLE, 0, 0});
+                retirePage(p_Aspect.tiles[l_Index], p_Table.requirements.alignment);
+                p_Aspect.tiles[l_Index] = VK_NULL_HANDLE;
+            }
+        }
+    }
+}
+
+bool VulkanSparseResidencyManager::isAspectResident(const ImageTable& p_Table, const AspectTable& p_Aspect, const uint32_t p_MipLevel, const uint32_t p_ArrayLayer, const VkOffset3D p_Offset, const VkExtent3D p_Extent)
+{
+    if (p_MipLevel >= p_Aspect.levelOffsets.size())
+    {
+        return true;
+    }
+
+    const VkExtent3D l_LevelTiles = getLevelTiles(p_Table, p_Aspect, p_MipLevel);
+    const TileRange l_Range = getTileRange(p_Table, p_Aspect, p_MipLevel, p_Offset, p_Extent);
+    const size_t l_Base = static_cast<size_t>(p_ArrayLayer) * p_Aspect.tilesPerLayer + p_Aspect.levelOffsets[p_MipLevel];
+    for (uint32_t z = l_Range.begin[2]; z < l_Range.end[2]; z++)
+    {
+        for (uint32_t y = l_Range.begin[1]; y < l_Range.end[1]; y++)
+        {
+            for (uint32_t x = l_Range.begin[0]; x < l_Range.end[0]; x++)
+            {
+                if (p_Aspect.tiles[l_Base + (static_cast<size_t>(z) * l_LevelTiles.height + y) * l_LevelTiles.width + x] == VK_NULL_HANDLE)
+                {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+void VulkanSparseResidencyManager::commit(const std::span<const ResourceID> p_WaitSemaphores, const std::span<const ResourceID> p_SignalSemaphores)
+{
+    VulkanDevice& l_Device = VulkanContext::getDevice(m_Device);
+
+    TRANS_VECTOR(l_BufferInfos, VkSparseBufferMemoryBindInfo);
+    TRANS_VECTOR(l_OpaqueInfos, VkSparseImageOpaqueMemoryBindInfo);
+    TRANS_VECTOR(l_ImageInfos, VkSparseImageMemoryBindInfo);
+    for (const auto& [l_Buffer, l_Binds] : m_PendingBufferBinds)
+    {
+        if (!l_Binds.empty())
+        {
+            l_BufferInfos.push_back({*l_Device.getBuffer(l_Buffer), static_cast<uint32_t>(l_Binds.size()), l_Binds.data()});
+        }
+    }
+    for (const auto& [l_Image, l_Binds] : m_PendingOpaqueBinds)
+    {
+        if (!l_Binds.empty())
+        {
+            l_OpaqueInfos.push_back({*l_Device.getImage(l_Image), static_cast<uint32_t>(l_Binds.size()), l_Binds.data()});
+        }
+    }
+    for (const auto& [l_Image, l_Binds] : m_PendingImageBinds)
+    {
+        if (!l_Binds.empty())
+        {
+            l_ImageInfos.push_back({*l_Device.getImage(l_Image), static_cast<uint32_t>(l_Binds.size()), l_Binds.data()});
+        }
+    }
+
+    TRANS_VECTOR(l_WaitSemaphores, VkSemaphore);
+    TRANS_VECTOR(l_SignalSemaphores, VkSemaphore);
+    for (const ResourceID l_Semaphore : p_WaitSemaphores)
+    {
+        l_WaitSemaphores.push_back(*l_Device.getSemaphore(l_Semaphore));
+    }
+    for (const ResourceID l_Semaphore : p_SignalSemaphores)
+    {
+        l_SignalSemaphores.push_back(*l_Device.getSemaphore(l_Semaphore));
+    }
+
+    VkBindSparseInfo l_BindInfo{};
+    l_BindInfo.sType = VK_STRUCTURE_TYPE_BIND_SPARSE_INFO;
+    l_BindInfo.waitSemaphoreCount = static_cast<uint32_t>(l_WaitSemaphores.size());
+    l_BindInfo.pWaitSemaphores = l_WaitSemaphores.data();
+    l_BindInfo.bufferBindCount = static_cast<uint32_t>(l_BufferInfos.size());
+    l_BindInfo.pBufferBinds = l_BufferInfos.data();
+    l_BindInfo.imageOpaqueBindCount = static_cast<uint32_t>(l_OpaqueInfos.size());
+    l_BindInfo.pImageOpaqueBinds = l_OpaqueInfos.data();
+    l_BindInfo.imageBindCount = static_cast<uint32_t>(l_ImageInfos.size());
+    l_BindInfo.pImageBinds = l_ImageInfos.data();
+    l_BindInfo.signalSemaphoreCount = static_cast<uint32_t>(l_SignalSemaphores.size());
+    l_BindInfo.pSignalSemaphores = l_SignalSemaphores.data();
+
+    // The previous bind must have completed before the pages it unbound can be released
+    waitIdle();
+
+    VulkanFence& l_Fence = l_Device.getFence(m_Fence);
+    l_Fence.reset();
+    if (const VkResult l_Result = l_Device.getTable().vkQueueBindSparse(*l_Device.getQueue(m_Queue), 1, &l_BindInfo, *l_Fence); l_Result != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to submit sparse binds: " + std::string(string_VkResult(l_Result)));
+    }
+    m_BindPending = true;
+
+    LOG_DEBUG("Committed sparse binds for ", l_BufferInfos.size(), " buffer(s) and ", l_ImageInfos.size() + l_OpaqueInfos.size(), " image(s), ", VulkanMemoryAllocator::compactBytes(m_ResidentBytes), " resident");
+
+    m_RetiredPages = std::move(m_UnboundPages);
+    m_UnboundPages.clear();
+    m_PendingBufferBinds.clear();
+    m_PendingOpaqueBinds.clear();
+    m_PendingImageBinds.clear();
+}
+
+void VulkanSparseResidencyManager::waitIdle()
+{
+    VulkanDevice& l_Device = VulkanContext::getDevice(m_Device);
+    if (m_BindPending)
+    {
+        l_Device.getFence(m_Fence).wait();
+        m_BindPending = false;
+    }
+
+    if (!m_RetiredPages.empty())
+    {
+        vmaFreeMemoryPages(*l_Device.getMemoryAllocator(), m_RetiredPages.size(), m_RetiredPages.data());
+        m_RetiredPages.clear();
+    }
+}
+
+bool VulkanSparseResidencyManager::hasPendingBinds() const
+{
+    return !m_PendingBufferBinds.empty() || !m_PendingOpaqueBinds.empty() || !m_PendingImageBinds.empty();
+}
+
+std::vector<VmaAllocation> VulkanSparseResidencyManager::allocatePages(const VkMemoryRequirements& p_Requirements, const VkDeviceSize p_PageSize, const size_t p_Count)
+{
+    const VkMemoryRequirements l_PageRequirements{p_PageSize, p_Requirements.alignment, p_Requirements.memoryTypeBits};
+
+    VmaAllocationCreateInfo l_Aci{};
+    l_Aci.usage = VMA_MEMORY_USAGE_UNKNOWN;
+    l_Aci.preferredFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+
+    std::vector<VmaAllocation> l_Pages(p_Count);
+    const VkResult l_Result = vmaAllocateMemoryPages(*VulkanContext::getDevice(m_Device).getMemoryAllocator(), &l_PageRequirements, &l_Aci, p_Count, l_Pages.data(), nullptr);
+    if (l_Result != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to allocate " + std::to_string(p_Count) + " sparse page(s): " + string_VkResult(l_Result));
+    }
+
+    m_ResidentBytes += p_PageSize * p_Count;
+    return l_Pages;
+}
+
+void VulkanSparseResidencyManager::retirePage(const VmaAllocation p_Page, const VkDeviceSize p_Size)
+{
+    m_UnboundPages.push_back(p_Page);
+    m_ResidentBytes -= p_Size;
+}
+
+void VulkanSparseResidencyManager::bindImageMipTail(const ResourceID p_Image, ImageTable& p_Table, const VkSparseImageMemoryRequirements& p_Requirements, const VkSparseMemoryBindFlags p_Flags)
+{
+    const bool l_Single = (p_Requirements.formatProperties.flags & VK_SPARSE_IMAGE_FORMAT_SINGLE_MIPTAIL_BIT) != 0;
+    const uint32_t l_TailCount = l_Single ? 1 : p_Table.arrayLayers;
+
+    const std::vector<VmaAllocation> l_Pages = allocatePages(p_Table.requirements, p_Requirements.imageMipTailSize, l_TailCount);
+    const VulkanMemoryAllocator& l_Allocator = VulkanContext::getDevice(m_Device).getMemoryAllocator();
+    std::vector<VkSparseMemoryBind>& l_Binds = m_PendingOpaqueBinds[p_Image];
+    for (uint32_t i = 0; i < l_TailCount; i++)
+    {
+        const VmaAllocationInfo l_Info = l_Allocator.getAllocationInfo(l_Pages[i]);
+        l_Binds.push_back({p_Requirements.imageMipTailOffset + i * p_Requirements.imageMipTailStride, p_Requirements.imageMipTailSize, l_Info.deviceMemory, l_Info.offset, p_Flags});
+        p_Table.mipTail.push_back(l_Pages[i]);
+    }
+}
+
+const VulkanSparseResidencyManager::BufferTable& VulkanSparseResidencyManager::getBufferTable(const ResourceID p_Buffer) const
+{
+    const auto l_It = m_Buffers.find(p_Buffer);
+    if (l_It == m_Buffers.end())
+    {
+        throw std::runtime_error("Buffer (ID:" + std::to_string(p_Buffer) + ") is not registered as a sparse resource");
+    }
+    return l_It->second;
+}
+
+const VulkanSparseResidencyManager::ImageTable& VulkanSparseResidencyManager::getImageTable(const ResourceID p_Image) const
+{
+    const auto l_It = m_Images.find(p_Image);
+    if (l_It == m_Images.end())
+    {
+        throw std::runtime_error("Image (ID:" + std::to_string(p_Image) + ") is not registered as a sparse resource");
+    }
+    return l_It->second;
+}
+
+VulkanSparseResidencyManager::TileRange VulkanSparseResidencyManager::getTileRange(const ImageTable& p_Table, const AspectTable& p_Aspect, const uint32_t p_MipLevel, const VkOffset3D p_Offset, const VkExtent3D p_Extent)
+{
+    const VkExtent3D l_Granularity = p_Aspect.sparseRequirements.formatProperties.imageGranularity;
+    const VkExtent3D l_Tiles = getLevelTiles(p_Table, p_Aspect, p_MipLevel);
+
+    TileRange l_Range{};
+    l_Range.begin[0] = static_cast<uint32_t>(p_Offset.x) / l_Granularity.width;
+    l_Range.begin[1] = static_cast<uint32_t>(p_Offset.y) / l_Granularity.height;
+    l_Range.begin[2] = static_cast<uint32_t>(p_Offset.z) / l_Granularity.depth;
+    l_Range.end[0] = std::min((p_Offset.x + p_Extent.width + l_Granularity.width - 1) / l_Granularity.width, l_Tiles.width);
+    l_Range.end[1] = std::min((p_Offset.y + p_Extent.height + l_Granularity.height - 1) / l_Granularity.height, l_Tiles.height);
+    l_Range.end[2] = std::min((p_Offset.z + p_Extent.depth + l_Granularity.depth - 1) / l_Granularity.depth, l_Tiles.depth);
+    return l_Range;
+}
+
+VkExtent3D VulkanSparseResidencyManager::getLevelTiles(const ImageTable& p_Table, const AspectTable& p_Aspect, const uint32_t p_MipLevel)
+{
+    const VkExtent3D l_Granularity = p_Aspect.sparseRequirements.formatProperties.imageGranularity;
+    const uint32_t l_Width = std::max(1U, p_Table.extent.width >> p_MipLevel);
+    const uint32_t l_Height = std::max(1U, p_Table.extent.height >> p_MipLevel);
+    const uint32_t l_Depth = std::max(1U, p_Table.extent.depth >> p_MipLevel);
+    return {(l_Width + l_Granularity.width - 1) / l_Granularity.width, (l_Height + l_Granularity.height - 1) / l_Granularity.height, (l_Depth + l_Granularity.depth - 1) / l_Granularity.depth};
+}
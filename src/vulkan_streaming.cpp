@@ -0,0 +1,414 @@
+#include "vulkan_streaming.hpp"
+
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+#include <thread>
+#include <vulkan/vk_enum_string_helper.h>
+
+#include "vulkan_context.hpp"
+#include "vulkan_device.hpp"
+#include "utils/logger.hpp"
+#include "utils/vulkan_base.hpp"
+
+VulkanStreamingLoader::VulkanStreamingLoader(const ResourceID p_Device, const QueueSelection& p_Queue, const ThreadID p_ThreadID, const VkDeviceSize p_ChunkSize, const uint32_t p_ChunkCount)
+    : m_Device(p_Device), m_Queue(p_Queue), m_ThreadID(p_ThreadID), m_ChunkSize(alignUp(p_ChunkSize, PIECE_ALIGNMENT))
+{
+    if (p_ChunkCount == 0 || m_ChunkSize == 0)
+    {
+        throw std::invalid_argument("Streaming loader requires at least one chunk of non-zero size");
+    }
+
+    VulkanDevice& l_Device = VulkanContext::getDevice(m_Device);
+
+    constexpr VulkanMemoryAllocator::MemoryPreferences PREFS{
+        .usage = VMA_MEMORY_USAGE_AUTO,
+        .vmaFlags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT,
+        .preferredProperties = VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+    };
+
+    const VkDeviceSize l_StagingSize = m_ChunkSize * p_ChunkCount;
+    m_StagingBuffer = l_Device.createAndAllocateBuffer(PREFS, {l_StagingSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, m_Queue.familyIndex});
+    m_StagingData = static_cast<uint8_t*>(l_Device.getBuffer(m_StagingBuffer).map(l_StagingSize, 0));
+
+    m_Slots.resize(p_ChunkCount);
+    for (Slot& l_Slot : m_Slots)
+    {
+        l_Slot.fence = l_Device.createFence(false);
+    }
+
+    LOG_DEBUG("Created streaming loader with ", p_ChunkCount, " chunk(s) of ", VulkanMemoryAllocator::compactBytes(m_ChunkSize));
+}
+
+VulkanStreamingLoader::~VulkanStreamingLoader()
+{
+    close();
+
+    VulkanDevice& l_Device = VulkanContext::getDevice(m_Device);
+    for (const Slot& l_Slot : m_Slots)
+    {
+        if (l_Slot.commandBuffer != UINT32_MAX)
+        {
+            l_Device.freeCommandBuffer(l_Slot.commandBuffer, m_ThreadID);
+        }
+        l_Device.freeFence(l_Slot.fence);
+    }
+
+    if (m_StagingBuffer != UINT32_MAX)
+    {
+        l_Device.getBuffer(m_StagingBuffer).unmap();
+        l_Device.freeBuffer(m_StagingBuffer);
+    }
+}
+
+bool VulkanStreamingLoader::open(const std::string_view p_Filename)
+{
+    close();
+
+    m_File.open(std::string(p_Filename), std::ios::binary | std::ios::ate);
+    if (!m_File.is_open())
+    {
+        LOG_ERR("Failed to open file for streaming: ", p_Filename);
+        return false;
+    }
+
+    m_FileSize = static_cast<VkDeviceSize>(m_File.tellg());
+    m_File.seekg(0);
+    LOG_DEBUG("Opened ", p_Filename, " for streaming (", VulkanMemoryAllocator::compactBytes(m_FileSize), ")");
+    return true;
+}
+
+void VulkanStreamingLoader::close()
+{
+    if (m_File.is_open())
+    {
+        m_File.close();
+    }
+    m_FileSize = 0;
+}
+
+void VulkanStreamingLoader::streamToBuffer(const ResourceID p_Buffer, const VkDeviceSize p_DstOffset)
+{
+    const std::array<BufferRange, 1> l_Range = {{{.buffer = p_Buffer, .fileOffset = 0, .size = m_FileSize, .dstOffset = p_DstOffset}}};
+    streamRanges(l_Range);
+}
+
+void VulkanStreamingLoader::streamRanges(const std::span<const BufferRange> p_Ranges)
+{
+    m_Pieces.clear();
+    m_Batches.clear();
+
+    for (const BufferRange& l_Range : p_Ranges)
+    {
+        if (l_Range.fileOffset + l_Range.size > m_FileSize)
+        {
+            throw std::out_of_range("Streaming range [" + std::to_string(l_Range.fileOffset) + ", " + std::to_string(l_Range.fileOffset + l_Range.size) + ") exceeds file size " + std::to_string(m_FileSize));
+        }
+
+        VkDeviceSize l_Offset = 0;
+        while (l_Offset < l_Range.size)
+        {
+            const VkDeviceSize l_Size = std::min(m_ChunkSize, l_Range.size - l_Offset);
+            addPiece({.target = l_Range.buffer, .isImage = false, .fileOffset = l_Range.fileOffset + l_Offset, .size = l_Size, .stagingOffset = 0, .dstOffset = l_Range.dstOffset + l_Offset, .region = {}});
+            l_Offset += l_Size;
+        }
+    }
+
+    run({}, VK_IMAGE_LAYOUT_UNDEFINED);
+}
+
+void VulkanStreamingLoader::streamImageRanges(const std::span<const ImageRange> p_Ranges, const VkImageLayout p_FinalLayout)
+{
+    m_Pieces.clear();
+    m_Batches.clear();
+
+    TRANS_VECTOR(l_Images, ResourceID);
+    for (const ImageRange& l_Range : p_Ranges)
+    {
+        if (l_Range.fileOffset + l_Range.size > m_FileSize)
+        {
+            throw std::out_of_range("Streaming range [" + std::to_string(l_Range.fileOffset) + ", " + std::to_string(l_Range.fileOffset + l_Range.size) + ") exceeds file size " + std::to_string(m_FileSize));
+        }
+        if (l_Range.size > m_ChunkSize)
+        {
+            throw std::runtime_error("Image (ID:" + std::to_string(l_Range.image) + ") region of size " + std::to_string(l_Range.size) + " does not fit in a streaming chunk of size " + std::to_string(m_ChunkSize));
+        }
+
+        addPiece({.target = l_Range.image, .isImage = true, .fileOffset = l_Range.fileOffset, .size = l_Range.size, .stagingOffset = 0, .dstOffset = 0, .region = l_Range.region});
+        if (std::ranges::find(l_Images, l_Range.image) == l_Images.end())
+        {
+            l_Images.push_back(l_Range.image);
+        }
+    }
+
+    run(l_Images, p_FinalLayout);
+}
+
+void VulkanStreamingLoader::addPiece(const Piece& p_Piece)
+{
+    VkDeviceSize l_Offset = 0;
+    if (!m_Batches.empty())
+    {
+        const Piece& l_Last = m_Pieces.back();
+        l_Offset = alignUp(l_Last.stagingOffset + l_Last.size, PIECE_ALIGNMENT);
+    }
+
+    if (m_Batches.empty() || l_Offset + p_Piece.size > m_ChunkSize)
+    {
+        m_Batches.push_back({m_Pieces.size(), 0});
+        l_Offset = 0;
+    }
+
+    m_Pieces.push_back(p_Piece);
+    m_Pieces.back().stagingOffset = l_Offset;
+    m_Batches.back().pieceCount++;
+}
+
+void VulkanStreamingLoader::run(const std::span<const ResourceID> p_Images, const VkImageLayout p_FinalLayout)
+{
+    if (m_Batches.empty())
+    {
+        return;
+    }
+    if (!m_File.is_open())
+    {
+        throw std::runtime_error("Tried to stream data without an open file");
+    }
+
+    for (Slot& l_Slot : m_Slots)
+    {
+        l_Slot.state = Slot::FREE;
+    }
+    m_FilledSlots.clear();
+    m_ReaderError = nullptr;
+    m_Abort = false;
+
+    LOG_DEBUG("Streaming ", m_Pieces.size(), " piece(s) in ", m_Batches.size(), " batch(es) through ", m_Slots.size(), " staging chunk(s)");
+
+    std::thread l_Reader(&VulkanStreamingLoader::readerLoop, this);
+    std::deque<uint32_t> l_InFlight;
+    size_t l_Submitted = 0;
+
+    try
+    {
+        while (l_Submitted < m_Batches.size())
+        {
+            uint32_t l_Slot = UINT32_MAX;
+            {
+                std::unique_lock l_Lock(m_Mutex);
+                if (l_InFlight.empty())
+                {
+                    m_SlotFilled.wait(l_Lock, [this] { return !m_FilledSlots.empty() || m_ReaderError; });
+                }
+                if (m_ReaderError)
+                {
+                    break;
+                }
+                if (!m_FilledSlots.empty())
+                {
+                    l_Slot = m_FilledSlots.front();
+                    m_FilledSlots.pop_front();
+                }
+            }
+
+            if (l_Slot != UINT32_MAX)
+            {
+                submitSlot(l_Slot, p_Images, p_FinalLayout);
+                l_InFlight.push_back(l_Slot);
+                l_Submitted++;
+            }
+            else
+            {
+                retireSlot(l_InFlight.front());
+                l_InFlight.pop_front();
+            }
+        }
+    }
+    catch (...)
+    {
+        {
+            std::scoped_lock l_Lock(m_Mutex);
+            m_Abort = true;
+        }
+        m_SlotFreed.notify_all();
+        l_Reader.join();
+        for (const uint32_t l_Slot : l_InFlight)
+        {
+            retireSlot(l_Slot);
+        }
+        throw;
+    }
+
+    l_Reader.join();
+    for (const uint32_t l_Slot : l_InFlight)
+    {
+        retireSlot(l_Slot);
+    }
+
+    if (m_ReaderError)
+    {
+        std::rethrow_exception(m_ReaderError);
+    }
+}
+
+void VulkanStreamingLoader::readerLoop()
+{
+    try
+    {
+        for (size_t i = 0; i < m_Batches.size(); i++)
+        {
+            uint32_t l_SlotIndex = UINT32_MAX;
+            {
+                std::unique_lock l_Lock(m_Mutex);
+                m_SlotFreed.wait(l_Lock, [this] { return m_Abort || std::ranges::any_of(m_Slots, [](const Slot& p_Slot) { return p_Slot.state == Slot::FREE; }); });
+                if (m_Abort)
+                {
+                    return;
+                }
+                for (uint32_t j = 0; j < m_Slots.size(); j++)
+                {
+                    if (m_Slots[j].state == Slot::FREE)
+                    {
+                        l_SlotIndex = j;
+                        break;
+                    }
+                }
+                m_Slots[l_SlotIndex].state = Slot::READING;
+            }
+
+            uint8_t* l_SlotData = m_StagingData + l_SlotIndex * m_ChunkSize;
+            const Batch& l_Batch = m_Batches[i];
+            for (size_t j = l_Batch.firstPiece; j < l_Batch.firstPiece + l_Batch.pieceCount; j++)
+            {
+                const Piece& l_Piece = m_Pieces[j];
+                m_File.seekg(static_cast<std::streamoff>(l_Piece.fileOffset));
+                m_File.read(reinterpret_cast<char*>(l_SlotData + l_Piece.stagingOffset), static_cast<std::streamsize>(l_Piece.size));
+                if (!m_File)
+                {
+                    m_File.clear();
+                    throw std::runtime_error("Failed to read " + std::to_string(l_Piece.size) + " bytes at offset " + std::to_string(l_Piece.fileOffset) + " from streamed file");
+                }
+            }
+
+            {
+                std::scoped_lock l_Lock(m_Mutex);
+                m_Slots[l_SlotIndex].state = Slot::FILLED;
+                m_Slots[l_SlotIndex].batch = i;
+                m_FilledSlots.push_back(l_SlotIndex);
+            }
+            m_SlotFilled.notify_one();
+        }
+    }
+    catch (...)
+    {
+        {
+            std::scoped_lock l_Lock(m_Mutex);
+            m_ReaderError = std::current_exception();
+        }
+        m_SlotFilled.notify_one();
+    }
+}
+
+void VulkanStreamingLoader::submitSlot(const uint32_t p_Slot, const std::span<const ResourceID> p_Images, const VkImageLayout p_FinalLayout)
+{
+    VulkanDevice& l_Device = VulkanContext::getDevice(m_Device);
+    Slot& l_Slot = m_Slots[p_Slot];
+    const Batch& l_Batch = m_Batches[l_Slot.batch];
+    const VkDeviceSize l_SlotBase = p_Slot * m_ChunkSize;
+
+    l_Device.getMemoryAllocator().flush(l_Device.getBuffer(m_StagingBuffer).getAllocation(), l_SlotBase, m_ChunkSize);
+
+    const QueueFamily l_Family = l_Device.getGPU().getQueueFamilies().getQueueFamily(m_Queue.familyIndex);
+    l_Slot.commandBuffer = l_Device.createCommandBuffer(l_Family, m_ThreadID, false);
+    VulkanCommandBuffer& l_CommandBuffer = l_Device.getCommandBuffer(l_Slot.commandBuffer, m_ThreadID);
+    l_CommandBuffer.beginRecording(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+
+    if (l_Slot.batch == 0 && !p_Images.empty())
+    {
+        VulkanMemoryBarrierBuilder l_BarrierBuilder{m_Device, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0};
+        for (const ResourceID l_Image : p_Images)
+        {
+            if (l_Device.getImage(l_Image).getLayout() != VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL)
+            {
+                l_BarrierBuilder.addImageMemoryBarrier(l_Image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+                l_Device.getImage(l_Image).setLayout(VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+            }
+        }
+        l_CommandBuffer.cmdPipelineBarrier(l_BarrierBuilder);
+    }
+
+    TRANS_VECTOR(l_BufferCopies, VkBufferCopy);
+    TRANS_VECTOR(l_ImageCopies, VkBufferImageCopy);
+    ResourceID l_CurrentTarget = UINT32_MAX;
+    const auto l_FlushCopies = [&]
+    {
+        if (!l_BufferCopies.empty())
+        {
+            l_CommandBuffer.cmdCopyBuffer(m_StagingBuffer, l_CurrentTarget, l_BufferCopies);
+            l_BufferCopies.clear();
+        }
+        if (!l_ImageCopies.empty())
+        {
+            l_CommandBuffer.cmdCopyBufferToImage(m_StagingBuffer, l_CurrentTarget, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, l_ImageCopies);
+            l_ImageCopies.clear();
+        }
+    };
+
+    for (size_t i = l_Batch.firstPiece; i < l_Batch.firstPiece + l_Batch.pieceCount; i++)
+    {
+        const Piece& l_Piece = m_Pieces[i];
+        if (l_Piece.target != l_CurrentTarget)
+        {
+            l_FlushCopies();
+            l_CurrentTarget = l_Piece.target;
+        }
+
+        if (l_Piece.isImage)
+        {
+            VkBufferImageCopy l_Region = l_Piece.region;
+            l_Region.bufferOffset = l_SlotBase + l_Piece.stagingOffset;
+            l_ImageCopies.push_back(l_Region);
+        }
+        else
+        {
+            l_BufferCopies.push_back({.srcOffset = l_SlotBase + l_Piece.stagingOffset, .dstOffset = l_Piece.dstOffset, .size = l_Piece.size});
+        }
+    }
+    l_FlushCopies();
+
+    if (l_Slot.batch == m_Batches.size() - 1 && !p_Images.empty() && p_FinalLayout != VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL)
+    {
+        VulkanMemoryBarrierBuilder l_BarrierBuilder{m_Device, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0};
+        for (const ResourceID l_Image : p_Images)
+        {
+            l_BarrierBuilder.addImageMemoryBarrier(l_Image, p_FinalLayout);
+            l_Device.getImage(l_Image).setLayout(p_FinalLayout);
+        }
+        l_CommandBuffer.cmdPipelineBarrier(l_BarrierBuilder);
+    }
+
+    l_CommandBuffer.endRecording();
+    l_CommandBuffer.submit(l_Device.getQueue(m_Queue), {}, {}, l_Slot.fence);
+
+    std::scoped_lock l_Lock(m_Mutex);
+    l_Slot.state = Slot::IN_FLIGHT;
+}
+
+void VulkanStreamingLoader::retireSlot(const uint32_t p_Slot)
+{
+    VulkanDevice& l_Device = VulkanContext::getDevice(m_Device);
+    Slot& l_Slot = m_Slots[p_Slot];
+
+    VulkanFence& l_Fence = l_Device.getFence(l_Slot.fence);
+    l_Fence.wait();
+    l_Fence.reset();
+
+    l_Device.freeCommandBuffer(l_Slot.commandBuffer, m_ThreadID);
+    l_Slot.commandBuffer = UINT32_MAX;
+
+    {
+        std::scoped_lock l_Lock(m_Mutex);
+        l_Slot.state = Slot::FREE;
+    }
+    m_SlotFreed.notify_one();
+}
@@ -0,0 +1,178 @@
+#include "vulkan_upload_batcher.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+
+#include "vulkan_command_buffer.hpp"
+#include "vulkan_context.hpp"
+#include "vulkan_device.hpp"
+#include "utils/logger.hpp"
+#include "utils/vulkan_base.hpp"
+
+VulkanUploadBatcher::VulkanUploadBatcher(const ResourceID p_Device, const QueueSelection& p_Queue, const VkDeviceSize p_Capacity)
+    : m_Device(p_Device), m_Queue(p_Queue)
+{
+    if (p_Capacity == 0)
+    {
+        throw std::invalid_argument("Upload batcher requires a non-zero staging capacity");
+    }
+    createStagingBuffer(p_Capacity);
+}
+
+VulkanUploadBatcher::~VulkanUploadBatcher()
+{
+    if (m_StagingBuffer != UINT32_MAX)
+    {
+        VulkanDevice& l_Device = VulkanContext::getDevice(m_Device);
+        l_Device.getBuffer(m_StagingBuffer).unmap();
+        l_Device.freeBuffer(m_StagingBuffer);
+    }
+}
+
+void VulkanUploadBatcher::write(const ResourceID p_Buffer, const VkDeviceSize p_DstOffset, const void* p_Data, const VkDeviceSize p_Size)
+{
+    if (p_Size == 0)
+    {
+        return;
+    }
+    memcpy(reserve(p_Buffer, p_DstOffset, p_Size), p_Data, p_Size);
+}
+
+void* VulkanUploadBatcher::reserve(const ResourceID p_Buffer, const VkDeviceSize p_DstOffset, const VkDeviceSize p_Size)
+{
+    if (m_Head + p_Size > m_Capacity)
+    {
+        grow(m_Head + p_Size);
+    }
+
+    const VkDeviceSize l_SrcOffset = m_Head;
+    m_Head += p_Size;
+    insertRegion(p_Buffer, p_DstOffset, p_Size, l_SrcOffset);
+    m_PendingWrites++;
+    return m_StagingData + l_SrcOffset;
+}
+
+void VulkanUploadBatcher::flush(const VulkanCommandBuffer& p_CommandBuffer)
+{
+    m_LastFlushStats = {};
+    if (m_Pending.empty())
+    {
+        return;
+    }
+
+    VulkanDevice& l_Device = VulkanContext::getDevice(m_Device);
+    l_Device.getMemoryAllocator().flush(l_Device.getBuffer(m_StagingBuffer).getAllocation(), m_FlushedHead, m_Head - m_FlushedHead);
+
+    m_LastFlushStats.writes = m_PendingWrites;
+    for (const auto& [l_Buffer, l_Regions] : m_Pending)
+    {
+        TRANS_VECTOR(l_Copies, VkBufferCopy);
+        l_Copies.reserve(l_Regions.size());
+        for (const auto& [l_DstOffset, l_Region] : l_Regions)
+        {
+            const VkDeviceSize l_Size = l_Region.dstEnd - l_DstOffset;
+            m_LastFlushStats.bytes += l_Size;
+            if (!l_Copies.empty())
+            {
+                VkBufferCopy& l_Last = l_Copies.back();
+                if (l_Last.dstOffset + l_Last.size == l_DstOffset && l_Last.srcOffset + l_Last.size == l_Region.srcOffset)
+                {
+                    l_Last.size += l_Size;
+                    continue;
+                }
+            }
+            l_Copies.push_back({l_Region.srcOffset, l_DstOffset, l_Size});
+        }
+
+        p_CommandBuffer.cmdCopyBuffer(m_StagingBuffer, l_Buffer, l_Copies);
+        m_LastFlushStats.regions += static_cast<uint32_t>(l_Copies.size());
+        m_LastFlushStats.copyCommands++;
+    }
+
+    LOG_DEBUG("Upload batcher flushed ", m_LastFlushStats.writes, " write(s) as ", m_LastFlushStats.regions, " region(s) in ", m_LastFlushStats.copyCommands, " copy command(s)");
+
+    m_Pending.clear();
+    m_PendingWrites = 0;
+    m_FlushedHead = m_Head;
+}
+
+void VulkanUploadBatcher::reset()
+{
+    m_Pending.clear();
+    m_PendingWrites = 0;
+    m_Head = 0;
+    m_FlushedHead = 0;
+}
+
+void VulkanUploadBatcher::createStagingBuffer(const VkDeviceSize p_Capacity)
+{
+    VulkanDevice& l_Device = VulkanContext::getDevice(m_Device);
+
+    constexpr VulkanMemoryAllocator::MemoryPreferences PREFS{
+        .usage = VMA_MEMORY_USAGE_AUTO,
+        .vmaFlags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT,
+        .preferredProperties = VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+    };
+
+    m_StagingBuffer = l_Device.createAndAllocateBuffer(PREFS, {p_Capacity, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, m_Queue.familyIndex});
+    m_StagingData = static_cast<uint8_t*>(l_Device.getBuffer(m_StagingBuffer).map(p_Capacity, 0));
+    m_Capacity = p_Capacity;
+
+    LOG_DEBUG("Created upload batcher staging buffer (ID:", m_StagingBuffer, ") of ", VulkanMemoryAllocator::compactBytes(p_Capacity));
+}
+
+void VulkanUploadBatcher::grow(const VkDeviceSize p_MinCapacity)
+{
+    if (m_FlushedHead != 0)
+    {
+        throw std::runtime_error("Upload batcher staging buffer (ID:" + std::to_string(m_StagingBuffer) + ") is full and cannot grow while flushed copies are pending, call reset() once they complete");
+    }
+
+    VulkanDevice& l_Device = VulkanContext::getDevice(m_Device);
+    const ResourceID l_OldBuffer = m_StagingBuffer;
+    const uint8_t* l_OldData = m_StagingData;
+
+    createStagingBuffer(std::max(m_Capacity * 2, p_MinCapacity));
+    memcpy(m_StagingData, l_OldData, m_Head);
+
+    l_Device.getBuffer(l_OldBuffer).unmap();
+    l_Device.freeBuffer(l_OldBuffer);
+}
+
+void VulkanUploadBatcher::insertRegion(const ResourceID p_Buffer, const VkDeviceSize p_DstOffset, const VkDeviceSize p_Size, const VkDeviceSize p_SrcOffset)
+{
+    std::map<VkDeviceSize, Region>& l_Regions = m_Pending[p_Buffer];
+    const VkDeviceSize l_End = p_DstOffset + p_Size;
+
+    // Regions in one copy command must not overlap, so later writes trim or replace earlier ones
+    auto l_It = l_Regions.lower_bound(p_DstOffset);
+    if (l_It != l_Regions.begin())
+    {
+        auto l_Prev = std::prev(l_It);
+        if (l_Prev->second.dstEnd > p_DstOffset)
+        {
+            const Region l_Old = l_Prev->second;
+            l_Prev->second.dstEnd = p_DstOffset;
+            if (l_Old.dstEnd > l_End)
+            {
+                l_Regions[l_End] = {l_Old.dstEnd, l_Old.srcOffset + (l_End - l_Prev->first)};
+            }
+        }
+    }
+
+    while (l_It != l_Regions.end() && l_It->first < l_End)
+    {
+        const Region l_Old = l_It->second;
+        const VkDeviceSize l_OldStart = l_It->first;
+        l_It = l_Regions.erase(l_It);
+        if (l_Old.dstEnd > l_End)
+        {
+            l_Regions[l_End] = {l_Old.dstEnd, l_Old.srcOffset + (l_End - l_OldStart)};
+            break;
+        }
+    }
+
+    l_Regions[p_DstOffset] = {l_End, p_SrcOffset};
+}